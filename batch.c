@@ -0,0 +1,941 @@
+/***************************************************************************
+*                             Batch File Trimmer
+*
+*   File    : batch.c
+*   Purpose : Trim many files, and optionally the files in directory trees,
+*             in one process using a work stealing pool of threads
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include "batch.h"
+#include "pool.h"
+#include "walk.h"
+#include "uring.h"
+#include "cache.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define FILES_PER_THREAD    64      /* files in flight per pool thread */
+#define LIST_READ_SIZE      (64 * 1024)     /* file list read size */
+#define CURSOR_DEPTH        16      /* initial depth of a cursor's stack */
+#define LOAD_SLOTS          256     /* most files loaded by io_uring at once */
+#define LOAD_SLOT_SIZE      (32 * 1024)     /* largest file loaded + 1 */
+
+/* results of advancing a cursor */
+#define CURSOR_FOUND    0           /* the next node was found */
+#define CURSOR_BLOCKED  1           /* the next node isn't listed yet */
+#define CURSOR_END      2           /* every node has been visited */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef struct batch_t batch_t;
+
+/* a file to be trimmed, or a directory to be walked */
+typedef struct batch_node_t
+{
+    batch_t *batch;             /* batch this node belongs to */
+    char *path;                 /* name of the file or directory */
+    int ownsPath;               /* non-zero if path was malloc'd */
+    int isDir;                  /* non-zero if this is a directory */
+    struct batch_node_t *children;  /* directory entries once listed */
+    size_t childCount;          /* number of entries in children */
+    char *buf;                  /* trimmed file, or report of changes */
+    size_t len;                 /* length of buf */
+    int loaded;                 /* non-zero if opened by the batch's ring */
+    uring_file_t load;          /* what the ring opened or read */
+    int changed;                /* non-zero if a checked file would change */
+    trim_stats_t stats;         /* what trimming the file did */
+    int err;                    /* errno value if trimming/listing failed */
+    int queued;                 /* non-zero once submitted to be trimmed */
+    int done;                   /* non-zero once trimmed or listed */
+} batch_node_t;
+
+/* position in a depth first walk of the node tree */
+typedef struct cursor_t
+{
+    batch_node_t **dirs;        /* directories being walked */
+    size_t *next;               /* index of the next child of each */
+    size_t depth;               /* number of directories on the stack */
+    size_t size;                /* capacity of the stack */
+} cursor_t;
+
+struct batch_t
+{
+    trim_opts_t opts;           /* options used for every file */
+    int inPlace;                /* rewrite files instead of trimming to buf */
+    int sync;                   /* fsync files rewritten in place */
+    int check;                  /* check files instead of trimming them */
+    int list;                   /* with check, report where files change */
+    int stop;                   /* set to skip the remaining work */
+    walk_filter_t filter;       /* globs applied to directory entries */
+    pool_t *pool;               /* pool that trims and walks */
+    uring_t *ring;              /* loads small files, or NULL */
+    cache_t *cache;             /* files known to be clean, or NULL */
+    stats_report_t *stats;      /* reports each file trimmed, or NULL */
+    pthread_mutex_t lock;       /* protects done flags and children */
+    pthread_cond_t cond;        /* signaled when a node is done */
+};
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static void TrimBatchFile(void *arg);
+static void ListBatchDir(void *arg);
+static void Submit(batch_t *batch, batch_node_t *node);
+static void SubmitFiles(batch_t *batch, batch_node_t **files, size_t count);
+static void FreeNodes(batch_node_t *nodes, size_t count);
+
+static int CursorInit(cursor_t *cursor, batch_node_t *root);
+static int CursorNext(cursor_t *cursor, batch_node_t **node, int advance);
+static void CursorFree(cursor_t *cursor);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : TrimBatch
+*   Description: This function trims a list of files on a work stealing
+*                pool of threads.  With the recursive option, directories
+*                in the list are walked on the same pool, so file discovery
+*                overlaps trimming.  Each file is trimmed into memory, and
+*                the calling thread writes the results in depth first
+*                order with directory entries sorted by name, so the output
+*                doesn't depend on the number of threads.  Only a limited
+*                number of files are in flight at once.  A file that can't
+*                be trimmed is reported on stderr and the rest of the
+*                batch continues.  In place batches rewrite each file that
+*                needs trimming instead of writing anything to fdOut.
+*                Check batches only look for files that would change,
+*                writing a report of the changes to fdOut if a list is
+*                wanted.  Otherwise the batch stops at the first file that
+*                would change.  With a cache, check and in place batches
+*                skip files already known to be clean.
+*   Parameters : paths - names of the files to trim
+*                count - number of names in paths
+*                fdOut - descriptor the trimmed files are written to
+*                opts - trimming options
+*                batchOpts - thread count, recursion, glob, in place, and
+*                            cache options
+*   Effects    : Trimmed copies of the files are written to fdOut, or the
+*                files are trimmed in place.
+*   Returned   : 0 if every file was trimmed or checked, 1 if a checked
+*                file would change, otherwise -1.
+****************************************************************************/
+int TrimBatch(char *const *paths, size_t count, int fdOut,
+    const trim_opts_t *opts, const batch_opts_t *batchOpts)
+{
+    batch_t batch;
+    batch_node_t root, *node, *pending[URING_BATCH];
+    cursor_t ahead, behind;
+    struct stat sb;
+    size_t i, inFlight, window, pendingCount;
+    uint64_t start;
+    int status, wrote, result, changed;
+
+    if (0 == count)
+    {
+        return 0;
+    }
+
+    memset(&root, 0, sizeof(root));
+    root.isDir = 1;
+    root.done = 1;
+    root.childCount = count;
+    root.children = (batch_node_t *)calloc(count, sizeof(batch_node_t));
+
+    if (NULL == root.children)
+    {
+        perror("Memory allocation");
+        return -1;
+    }
+
+    if (0 != WalkFilterInit(&batch.filter, batchOpts->include,
+        batchOpts->exclude))
+    {
+        perror("Memory allocation");
+        free(root.children);
+        return -1;
+    }
+
+    if ((0 != CursorInit(&ahead, &root)) || (0 != CursorInit(&behind, &root)))
+    {
+        perror("Memory allocation");
+        CursorFree(&ahead);
+        WalkFilterFree(&batch.filter);
+        free(root.children);
+        return -1;
+    }
+
+    batch.pool = PoolCreate(batchOpts->threads);
+
+    if (NULL == batch.pool)
+    {
+        perror("Creating threads");
+        CursorFree(&ahead);
+        CursorFree(&behind);
+        WalkFilterFree(&batch.filter);
+        free(root.children);
+        return -1;
+    }
+
+    /* each file is trimmed by a single pool thread */
+    batch.opts = *opts;
+    batch.opts.jobs = 1;
+    batch.opts.stats = NULL;
+    batch.stats = batchOpts->stats;
+    batch.inPlace = batchOpts->inPlace;
+    batch.sync = batchOpts->sync;
+    batch.check = batchOpts->check;
+    batch.list = batchOpts->list;
+    batch.stop = 0;
+    batch.ring = NULL;
+    batch.cache = NULL;
+
+    if ((NULL != batchOpts->cache) && (batch.inPlace || batch.check))
+    {
+        /* only checks can skip clean files; it's just slower without */
+        batch.cache = CacheOpen(batchOpts->cache, &batch.opts);
+
+        if (NULL == batch.cache)
+        {
+            perror(batchOpts->cache);
+        }
+    }
+
+    if (batchOpts->uring && !batchOpts->inPlace && (NULL == batch.cache))
+    {
+        /* without io_uring each file is opened and read by its task */
+        batch.ring = UringCreate(LOAD_SLOTS, LOAD_SLOT_SIZE);
+    }
+
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.cond, NULL);
+
+    for (i = 0; i < count; i++)
+    {
+        node = &root.children[i];
+        node->batch = &batch;
+        node->path = paths[i];
+        node->isDir = batchOpts->recursive && (0 == stat(paths[i], &sb)) &&
+            S_ISDIR(sb.st_mode);
+
+        if (node->isDir)
+        {
+            /* start walking every named directory now */
+            Submit(&batch, node);
+        }
+    }
+
+    window = (size_t)batchOpts->threads * FILES_PER_THREAD;
+    inFlight = 0;
+    status = 0;
+    wrote = 1;
+    changed = 0;
+
+    pthread_mutex_lock(&batch.lock);
+
+    for (;;)
+    {
+        if (__atomic_load_n(&batch.stop, __ATOMIC_RELAXED))
+        {
+            /* a file would change; the answer is known */
+            changed = 1;
+            break;
+        }
+
+        /* keep the window of files in flight full */
+        pendingCount = 0;
+
+        while ((inFlight < window) &&
+            (CURSOR_FOUND == CursorNext(&ahead, &node, 1)))
+        {
+            if (!node->isDir)
+            {
+                node->queued = 1;
+                inFlight++;
+                pending[pendingCount++] = node;
+
+                if (URING_BATCH == pendingCount)
+                {
+                    pthread_mutex_unlock(&batch.lock);
+                    SubmitFiles(&batch, pending, pendingCount);
+                    pthread_mutex_lock(&batch.lock);
+                    pendingCount = 0;
+                }
+            }
+        }
+
+        if (0 != pendingCount)
+        {
+            pthread_mutex_unlock(&batch.lock);
+            SubmitFiles(&batch, pending, pendingCount);
+            pthread_mutex_lock(&batch.lock);
+        }
+
+        /* wait for the next node in output order */
+        result = CursorNext(&behind, &node, 0);
+
+        if (CURSOR_END == result)
+        {
+            break;
+        }
+
+        if ((CURSOR_FOUND == result) && !node->isDir && !node->queued)
+        {
+            /* the cursors disagree (out of memory); trim it anyway */
+            node->queued = 1;
+            inFlight++;
+            pthread_mutex_unlock(&batch.lock);
+            Submit(&batch, node);
+            pthread_mutex_lock(&batch.lock);
+            continue;
+        }
+
+        if ((CURSOR_BLOCKED == result) || !node->done)
+        {
+            pthread_cond_wait(&batch.cond, &batch.lock);
+            continue;
+        }
+
+        (void)CursorNext(&behind, &node, 1);
+        pthread_mutex_unlock(&batch.lock);
+
+        if (0 != node->err)
+        {
+            fprintf(stderr, "%s: %s\n", node->path, strerror(node->err));
+            status = -1;
+        }
+        else if (node->changed)
+        {
+            changed = 1;
+        }
+
+        if (wrote && (0 == node->err) && !node->isDir && (0 != node->len))
+        {
+            start = TrimClock();
+
+            if (0 != WriteAll(fdOut, node->buf, node->len))
+            {
+                /* there's no point in writing anything else */
+                perror("Writing output");
+                wrote = 0;
+                status = -1;
+            }
+
+            node->stats.writeNs += TrimClock() - start;
+        }
+
+        if ((NULL != batch.stats) && wrote && (0 == node->err) &&
+            !node->isDir)
+        {
+            /* reported in the order the files are written */
+            StatsFile(batch.stats, node->path, &node->stats);
+        }
+
+        free(node->buf);
+        node->buf = NULL;
+        pthread_mutex_lock(&batch.lock);
+
+        if (!node->isDir)
+        {
+            inFlight--;
+        }
+    }
+
+    pthread_mutex_unlock(&batch.lock);
+
+    PoolDestroy(batch.pool);
+    UringDestroy(batch.ring);
+
+    if ((NULL != batch.cache) && (0 != CacheClose(batch.cache)))
+    {
+        /* the files are fine; the next run will just be slower */
+        perror(batchOpts->cache);
+    }
+
+    pthread_cond_destroy(&batch.cond);
+    pthread_mutex_destroy(&batch.lock);
+    CursorFree(&ahead);
+    CursorFree(&behind);
+    WalkFilterFree(&batch.filter);
+    FreeNodes(root.children, root.childCount);
+
+    if ((0 == status) && changed)
+    {
+        status = 1;
+    }
+
+    return status;
+}
+
+/****************************************************************************
+*   Function   : Submit
+*   Description: This function queues a node on the batch's pool; files
+*                are trimmed and directories are listed.  If the task
+*                can't be queued it's run on the calling thread.
+*   Parameters : batch - batch the node belongs to
+*                node - file or directory to be processed
+*   Effects    : The node will be trimmed or listed.
+*   Returned   : None
+****************************************************************************/
+static void Submit(batch_t *batch, batch_node_t *node)
+{
+    pool_fn_t fn;
+
+    fn = node->isDir ? ListBatchDir : TrimBatchFile;
+
+    if (0 != PoolSubmit(batch->pool, fn, node))
+    {
+        fn(node);
+    }
+}
+
+/****************************************************************************
+*   Function   : SubmitFiles
+*   Description: This function queues files on the batch's pool.  If the
+*                batch has an io_uring, the files are first opened and read
+*                together in as few system calls as possible, so their
+*                tasks only have to trim them.  Files the ring has no
+*                buffers for are opened by their tasks.
+*   Parameters : batch - batch the files belong to
+*                files - files to be trimmed
+*                count - number of files, no more than URING_BATCH
+*   Effects    : The files will be trimmed.
+*   Returned   : None
+****************************************************************************/
+static void SubmitFiles(batch_t *batch, batch_node_t **files, size_t count)
+{
+    uring_file_t *loads[URING_BATCH];
+    size_t i, loaded;
+
+    loaded = 0;
+
+    if (NULL != batch->ring)
+    {
+        for (i = 0; i < count; i++)
+        {
+            files[i]->load.path = files[i]->path;
+            loads[i] = &files[i]->load;
+        }
+
+        loaded = UringLoad(batch->ring, loads, count);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        files[i]->loaded = (i < loaded);
+        Submit(batch, files[i]);
+    }
+}
+
+/****************************************************************************
+*   Function   : TrimBatchFile
+*   Description: This function is the pool task that trims one file of a
+*                batch into memory, or in place for in place batches.  For
+*                check batches it only finds out whether the file would
+*                change, and stops the batch if it would and no report is
+*                wanted.  A file the batch's ring has already read is
+*                trimmed straight from the ring's buffer.  With a cache,
+*                files known to be clean are skipped without being read.
+*   Parameters : arg - pointer to the batch_node_t to trim
+*   Effects    : The file's buf and len or err are set, and it's marked
+*                done.
+*   Returned   : None
+****************************************************************************/
+static void TrimBatchFile(void *arg)
+{
+    batch_node_t *file;
+    batch_t *batch;
+    trim_opts_t opts;
+    int fd, err, changed;
+
+    file = (batch_node_t *)arg;
+    batch = file->batch;
+    opts = batch->opts;
+
+    if (NULL != batch->stats)
+    {
+        /* counted by this task alone, so without locking */
+        opts.stats = &file->stats;
+    }
+
+    fd = -1;
+    err = 0;
+    changed = 0;
+
+    if (file->loaded)
+    {
+        /* the batch's ring already opened it, and read it if it's small */
+        fd = file->load.fd;
+        err = file->load.err;
+    }
+    else if (!batch->inPlace && (NULL == batch->cache) &&
+        !__atomic_load_n(&batch->stop, __ATOMIC_RELAXED) &&
+        ((fd = open(file->path, O_RDONLY)) < 0))
+    {
+        err = errno;
+    }
+
+    if (__atomic_load_n(&batch->stop, __ATOMIC_RELAXED))
+    {
+        err = 0;        /* the batch is over */
+    }
+    else if (0 != err)
+    {
+        /* it couldn't be opened */
+    }
+    else if (NULL != batch->cache)
+    {
+        /* files known to be clean aren't even read */
+        if (0 != CacheCheckFile(batch->cache, file->path,
+            batch->check && batch->list, &file->buf, &file->len, &changed))
+        {
+            err = errno;
+        }
+        else if (batch->inPlace && changed &&
+            (0 != TrimFileInPlace(file->path, &batch->opts, batch->sync,
+            &changed)))
+        {
+            err = errno;
+        }
+    }
+    else if (batch->inPlace)
+    {
+        if (0 != TrimFileInPlace(file->path, &batch->opts, batch->sync,
+            &changed))
+        {
+            err = errno;
+        }
+    }
+    else if (file->loaded && (file->load.slot >= 0))
+    {
+        if (batch->check)
+        {
+            if (0 != CheckMemory(file->load.data, file->load.len,
+                &batch->opts, file->path, batch->list, &file->buf,
+                &file->len, &changed))
+            {
+                err = errno;
+            }
+        }
+        else if (0 != TrimMemory(file->load.data, file->load.len, &opts,
+            &file->buf, &file->len))
+        {
+            err = errno;
+        }
+    }
+    else if (batch->check)
+    {
+        if (0 != CheckFd(fd, &batch->opts, file->path, batch->list,
+            &file->buf, &file->len, &changed))
+        {
+            err = errno;
+        }
+    }
+    else
+    {
+        if (0 != TrimFdToMemory(fd, &opts, &file->buf, &file->len))
+        {
+            err = errno;
+        }
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    if (file->loaded && (file->load.slot >= 0))
+    {
+        UringRelease(batch->ring, file->load.slot);
+    }
+
+    pthread_mutex_lock(&batch->lock);
+    file->err = err;
+    file->changed = (0 == err) && batch->check && changed;
+
+    if (file->changed && !batch->list)
+    {
+        __atomic_store_n(&batch->stop, 1, __ATOMIC_RELAXED);
+    }
+
+    file->done = 1;
+    pthread_cond_broadcast(&batch->cond);
+    pthread_mutex_unlock(&batch->lock);
+}
+
+/****************************************************************************
+*   Function   : ListBatchDir
+*   Description: This function is the pool task that lists one directory
+*                of a recursive batch.  Subdirectories are queued to be
+*                listed right away; files are left for the writer to queue
+*                as its window allows.
+*   Parameters : arg - pointer to the batch_node_t of the directory
+*   Effects    : The directory's children or err are set, and it's marked
+*                done.
+*   Returned   : None
+****************************************************************************/
+static void ListBatchDir(void *arg)
+{
+    batch_node_t *dir, *children;
+    walk_entry_t *entries;
+    size_t count, i;
+    int err;
+
+    dir = (batch_node_t *)arg;
+    children = NULL;
+    count = 0;
+    err = 0;
+
+    if (__atomic_load_n(&dir->batch->stop, __ATOMIC_RELAXED))
+    {
+        entries = NULL;         /* the batch is over */
+    }
+    else if (0 != WalkReadDir(dir->path, &dir->batch->filter, &entries, &count))
+    {
+        err = errno;
+        count = 0;
+    }
+    else if (0 != count)
+    {
+        children = (batch_node_t *)calloc(count, sizeof(batch_node_t));
+
+        if (NULL == children)
+        {
+            WalkFreeEntries(entries, count);
+            err = ENOMEM;
+            count = 0;
+        }
+        else
+        {
+            for (i = 0; i < count; i++)
+            {
+                children[i].batch = dir->batch;
+                children[i].path = entries[i].path;
+                children[i].ownsPath = 1;
+                children[i].isDir = entries[i].isDir;
+
+                if (children[i].isDir)
+                {
+                    Submit(dir->batch, &children[i]);
+                }
+            }
+
+            /* the paths now belong to the children */
+            free(entries);
+        }
+    }
+    else
+    {
+        free(entries);
+    }
+
+    pthread_mutex_lock(&dir->batch->lock);
+    dir->children = children;
+    dir->childCount = count;
+    dir->err = err;
+    dir->done = 1;
+    pthread_cond_broadcast(&dir->batch->cond);
+    pthread_mutex_unlock(&dir->batch->lock);
+}
+
+/****************************************************************************
+*   Function   : FreeNodes
+*   Description: This function frees an array of nodes along with all of
+*                the nodes below them.
+*   Parameters : nodes - array of nodes
+*                count - number of nodes in the array
+*   Effects    : The nodes and their paths and buffers are freed.
+*   Returned   : None
+****************************************************************************/
+static void FreeNodes(batch_node_t *nodes, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        FreeNodes(nodes[i].children, nodes[i].childCount);
+        free(nodes[i].buf);
+
+        if (nodes[i].ownsPath)
+        {
+            free(nodes[i].path);
+        }
+    }
+
+    free(nodes);
+}
+
+/****************************************************************************
+*   Function   : CursorInit
+*   Description: This function starts a depth first walk of a node tree.
+*   Parameters : cursor - cursor to initialize
+*                root - listed directory at the top of the tree; it is not
+*                       itself visited
+*   Effects    : Memory is allocated for the cursor's stack.
+*   Returned   : 0 for success, otherwise -1.
+****************************************************************************/
+static int CursorInit(cursor_t *cursor, batch_node_t *root)
+{
+    cursor->dirs = (batch_node_t **)malloc(CURSOR_DEPTH *
+        sizeof(batch_node_t *));
+    cursor->next = (size_t *)malloc(CURSOR_DEPTH * sizeof(size_t));
+    cursor->size = CURSOR_DEPTH;
+    cursor->depth = 0;
+
+    if ((NULL == cursor->dirs) || (NULL == cursor->next))
+    {
+        return -1;
+    }
+
+    cursor->dirs[0] = root;
+    cursor->next[0] = 0;
+    cursor->depth = 1;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : CursorNext
+*   Description: This function finds the next node of a depth first walk.
+*                Directories are visited before their contents, and the
+*                walk can't enter a directory until it has been listed.
+*                The batch lock must be held.
+*   Parameters : cursor - position in the walk
+*                node - set to the next node when it is found
+*                advance - non-zero to move past the node that is found,
+*                          0 to just look at it
+*   Effects    : cursor is moved if advance is non-zero.
+*   Returned   : CURSOR_FOUND, CURSOR_BLOCKED if the next node is a
+*                directory that hasn't been listed, or CURSOR_END.
+****************************************************************************/
+static int CursorNext(cursor_t *cursor, batch_node_t **node, int advance)
+{
+    batch_node_t *dir, *child;
+    batch_node_t **dirs;
+    size_t *next;
+
+    while (0 != cursor->depth)
+    {
+        dir = cursor->dirs[cursor->depth - 1];
+
+        if (cursor->next[cursor->depth - 1] >= dir->childCount)
+        {
+            /* done with this directory */
+            cursor->depth--;
+            continue;
+        }
+
+        child = &dir->children[cursor->next[cursor->depth - 1]];
+
+        if (child->isDir && !child->done)
+        {
+            return CURSOR_BLOCKED;
+        }
+
+        *node = child;
+
+        if (!advance)
+        {
+            return CURSOR_FOUND;
+        }
+
+        cursor->next[cursor->depth - 1]++;
+
+        if (child->isDir && (0 != child->childCount))
+        {
+            if (cursor->depth == cursor->size)
+            {
+                dirs = (batch_node_t **)realloc(cursor->dirs,
+                    2 * cursor->size * sizeof(batch_node_t *));
+
+                if (NULL != dirs)
+                {
+                    cursor->dirs = dirs;
+                }
+
+                next = (size_t *)realloc(cursor->next,
+                    2 * cursor->size * sizeof(size_t));
+
+                if (NULL != next)
+                {
+                    cursor->next = next;
+                }
+
+                if ((NULL == dirs) || (NULL == next))
+                {
+                    /* skip the directory rather than lose our place */
+                    return CURSOR_FOUND;
+                }
+
+                cursor->size *= 2;
+            }
+
+            cursor->dirs[cursor->depth] = child;
+            cursor->next[cursor->depth] = 0;
+            cursor->depth++;
+        }
+
+        return CURSOR_FOUND;
+    }
+
+    return CURSOR_END;
+}
+
+/****************************************************************************
+*   Function   : CursorFree
+*   Description: This function frees a cursor's stack.
+*   Parameters : cursor - cursor to free
+*   Effects    : The cursor's memory is freed.
+*   Returned   : None
+****************************************************************************/
+static void CursorFree(cursor_t *cursor)
+{
+    free(cursor->dirs);
+    free(cursor->next);
+    cursor->dirs = NULL;
+    cursor->next = NULL;
+    cursor->depth = 0;
+}
+
+/****************************************************************************
+*   Function   : ReadFileList
+*   Description: This function reads a list of file names separated by NUL
+*                characters, such as the output of find -print0.  A final
+*                name without a trailing NUL is also accepted, and empty
+*                names are skipped.
+*   Parameters : fd - descriptor the list is read from
+*                buf - set to a malloc'd buffer holding the names
+*                paths - set to a malloc'd array of pointers into buf
+*                count - set to the number of entries in paths
+*   Effects    : Reads fd to the end of file.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+*
+*   NOTE: The caller is responsible for freeing *buf and *paths.
+****************************************************************************/
+int ReadFileList(int fd, char **buf, char ***paths, size_t *count)
+{
+    char *list, *tmp, **names;
+    size_t used, size, n, i;
+    ssize_t got;
+
+    list = NULL;
+    used = 0;
+    size = 0;
+
+    for (;;)
+    {
+        /* always leave room for a terminating NUL */
+        if (size - used < LIST_READ_SIZE + 1)
+        {
+            size += LIST_READ_SIZE + 1;
+            tmp = (char *)realloc(list, size);
+
+            if (NULL == tmp)
+            {
+                free(list);
+                errno = ENOMEM;
+                return -1;
+            }
+
+            list = tmp;
+        }
+
+        got = read(fd, list + used, LIST_READ_SIZE);
+
+        if (got < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            free(list);
+            return -1;
+        }
+
+        if (0 == got)
+        {
+            break;
+        }
+
+        used += (size_t)got;
+    }
+
+    list[used] = '\0';
+
+    /* count the names */
+    n = 0;
+
+    for (i = 0; i < used; i++)
+    {
+        if (('\0' != list[i]) && ((0 == i) || ('\0' == list[i - 1])))
+        {
+            n++;
+        }
+    }
+
+    names = (char **)malloc((n + 1) * sizeof(char *));
+
+    if (NULL == names)
+    {
+        free(list);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    n = 0;
+
+    for (i = 0; i < used; i++)
+    {
+        if (('\0' != list[i]) && ((0 == i) || ('\0' == list[i - 1])))
+        {
+            names[n] = list + i;
+            n++;
+        }
+    }
+
+    *buf = list;
+    *paths = names;
+    *count = n;
+    return 0;
+}
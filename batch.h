@@ -0,0 +1,72 @@
+/***************************************************************************
+*                             Batch File Trimmer
+*
+*   File    : batch.h
+*   Purpose : Header for functions that trim many files in one process
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef BATCH_H
+#define BATCH_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stddef.h>
+#include "trimfile.h"
+#include "stats.h"
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef struct batch_opts_t
+{
+    unsigned int threads;       /* number of threads in the pool */
+    int recursive;              /* walk directories named in the batch */
+    const char *include;        /* comma separated globs of files to trim */
+    const char *exclude;        /* comma separated globs of names to skip */
+    int inPlace;                /* rewrite files instead of writing fdOut */
+    int sync;                   /* fsync files rewritten in place */
+    int check;                  /* only report files that would change */
+    int list;                   /* with check, list where files change */
+    int uring;                  /* load small files in batches with io_uring */
+    const char *cache;          /* file of files known to be clean, or NULL */
+    stats_report_t *stats;      /* reports each file trimmed, or NULL */
+} batch_opts_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* trims each file in paths on a pool of threads, writing the results to
+ * fdOut in the order the files are listed; in check mode returns 1 if any
+ * file would change */
+int TrimBatch(char *const *paths, size_t count, int fdOut,
+    const trim_opts_t *opts, const batch_opts_t *batchOpts);
+
+/* reads a NUL separated list of file names (find -print0 style) */
+int ReadFileList(int fd, char **buf, char ***paths, size_t *count);
+
+#endif  /* ndef BATCH_H */
@@ -0,0 +1,962 @@
+/***************************************************************************
+*                   Tab Remover and Trailing Space Trimmer
+*
+*   File    : bench.c
+*   Purpose : Generate synthetic corpora and measure the throughput of
+*             the trimming engine on each I/O path and scanner
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "optlist/optlist.h"
+#include "trimmer.h"
+#include "trimfile.h"
+#include "scan.h"
+#include "codec.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define DEFAULT_MB      16          /* size of each corpus in MB */
+#define DEFAULT_RUNS    5           /* timed runs of each case */
+#define DEFAULT_JSON    "bench.json"
+#define DEFAULT_TAB     4
+#define MAX_RUNS        101
+#define MAX_RESULTS     64
+#define SEED            20061126UL  /* every run generates the same data */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+
+/* a corpus being generated */
+typedef struct gen_t
+{
+    char *buf;                  /* corpus */
+    size_t used;                /* bytes generated so far */
+    size_t len;                 /* size of the corpus */
+    unsigned long seed;         /* state of the random number generator */
+} gen_t;
+
+typedef void (*gen_fn_t)(gen_t *gen);
+
+typedef struct corpus_t
+{
+    const char *name;
+    gen_fn_t generate;
+} corpus_t;
+
+/* a corpus ready to be trimmed */
+typedef struct input_t
+{
+    const char *path;           /* the corpus as a regular file */
+    const char *data;           /* the corpus in memory */
+    size_t len;                 /* size of the corpus */
+    int devNull;                /* descriptor output is thrown away on */
+} input_t;
+
+/* the write end of the pipe RunPipe trims from */
+typedef struct pipe_job_t
+{
+    const input_t *input;       /* corpus written to the pipe */
+    int fd;                     /* write end of the pipe */
+} pipe_job_t;
+
+typedef int (*path_fn_t)(const input_t *input, const trim_opts_t *opts);
+
+/* a way of getting a corpus into the trimmer */
+typedef struct path_t
+{
+    const char *name;
+    path_fn_t run;
+} path_t;
+
+typedef struct result_t
+{
+    const char *corpus;
+    const char *path;
+    const char *scanner;
+    size_t bytes;               /* size of the corpus */
+    double best;                /* fastest run in ns */
+    double median;              /* median run in ns */
+} result_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static void GenSource(gen_t *gen);
+static void GenLogs(gen_t *gen);
+static void GenCRLF(gen_t *gen);
+static void GenMinified(gen_t *gen);
+static void GenRuns(gen_t *gen);
+
+static unsigned long Rand(gen_t *gen, unsigned long n);
+static void PutChars(gen_t *gen, char c, size_t count);
+static void PutString(gen_t *gen, const char *str);
+static void PutWord(gen_t *gen);
+static void PutBlanks(gen_t *gen, size_t count);
+
+static int RunMapped(const input_t *input, const trim_opts_t *opts);
+static int RunPipe(const input_t *input, const trim_opts_t *opts);
+static int RunPipeline(const input_t *input, const trim_opts_t *opts);
+static int RunFeed(const input_t *input, const trim_opts_t *opts);
+static void *PipeWriter(void *arg);
+static int CountSink(void *context, const char *data, size_t len);
+
+static int TimeCase(const input_t *input, const path_t *path,
+    const trim_opts_t *opts, unsigned int runs, result_t *result);
+static int CompareTimes(const void *a, const void *b);
+static double Now(void);
+static int WriteJson(const char *fileName, const result_t *results,
+    size_t count, const trim_opts_t *opts, unsigned int runs);
+
+/***************************************************************************
+*                            GLOBAL VARIABLES
+***************************************************************************/
+static const corpus_t corpora[] =
+{
+    {"source", GenSource},
+    {"logs", GenLogs},
+    {"crlf", GenCRLF},
+    {"minified", GenMinified},
+    {"runs", GenRuns},
+    {NULL, NULL}
+};
+
+static const path_t paths[] =
+{
+    {"mmap", RunMapped},        /* TrimFd on a regular file */
+    {"read", RunPipe},          /* TrimFd on a pipe, like stdin */
+    {"pipeline", RunPipeline},  /* the same with -p threads */
+    {"feed", RunFeed},          /* TrimmerFeed on memory, no I/O */
+    {NULL, NULL}
+};
+
+static const char *const scanners[] = {"scalar", "sse2", "avx2", NULL};
+
+static const char *const words[] =
+{
+    "int", "return", "if", "else", "for", "while", "static", "const",
+    "char", "size_t", "buf", "len", "status", "count", "next", "p", "i",
+    "NULL", "0", "1", "=", "==", "+=", "(", ")", "{", "}", ";", "->",
+    "error", "warning", "request", "worker", "connection", "timeout"
+};
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : main
+*   Description: This is the main function for the benchmark.  It
+*                generates each corpus, times trimming it on every I/O
+*                path with every scanner the CPU supports, prints a table
+*                of the results, and writes them to a JSON file.  The
+*                corpora are generated from a fixed seed, so runs are
+*                repeatable, and the fastest and median of several timed
+*                runs are kept.
+*   Parameters : argc - number of parameters
+*                argv - parameter list
+*   Effects    : Temporary corpus files are written and removed, and the
+*                JSON summary is written.
+*   Returned   : EXIT_SUCCESS for success, otherwise EXIT_FAILURE.
+****************************************************************************/
+int main(int argc, char *argv[])
+{
+    option_t *optList, *thisOpt;
+    trim_opts_t opts;
+    const char *jsonFile, *tmpDir;
+    const char *defaultScanner;
+    unsigned int runs, s, p;
+    size_t size, count, c;
+    char *dir, *file;
+    gen_t gen;
+    input_t input;
+    result_t results[MAX_RESULTS];
+    int fd, status;
+
+    opts.tabSize = DEFAULT_TAB;
+    opts.tabStops = NULL;
+    opts.keepTabs = 0;
+    opts.retab = RETAB_NONE;
+    opts.eol = EOL_KEEP;
+    opts.utf8 = 0;
+    opts.jobs = 1;
+    opts.pipeline = 0;
+    opts.codec = CODEC_NONE;
+    opts.stats = NULL;
+    size = (size_t)DEFAULT_MB * 1024 * 1024;
+    runs = DEFAULT_RUNS;
+    jsonFile = DEFAULT_JSON;
+
+    if (0 != GetOptArena(argc, argv, "m:n:o:t:kh?", &optList))
+    {
+        perror("Memory allocation");
+        return EXIT_FAILURE;
+    }
+
+    thisOpt = optList;
+
+    while (thisOpt != NULL)
+    {
+        switch(thisOpt->option)
+        {
+            case 'm':       /* corpus size in MB */
+                size = (size_t)atoi(thisOpt->argument) * 1024 * 1024;
+
+                if (0 == size)
+                {
+                    size = 1024 * 1024;
+                }
+
+                break;
+
+            case 'n':       /* timed runs */
+                runs = atoi(thisOpt->argument);
+
+                if (runs < 1)
+                {
+                    runs = 1;
+                }
+                else if (runs > MAX_RUNS)
+                {
+                    runs = MAX_RUNS;
+                }
+
+                break;
+
+            case 'o':       /* JSON summary */
+                jsonFile = thisOpt->argument;
+                break;
+
+            case 't':       /* tab size */
+                opts.tabSize = atoi(thisOpt->argument);
+                break;
+
+            case 'k':       /* keep tabs */
+                opts.keepTabs = 1;
+                break;
+
+            case 'h':
+            case '?':
+                printf("Usage: %s <options>\n\n", argv[0]);
+                printf("Options:\n");
+                printf("  -m <n> : Size of each corpus in MB (default %d).\n",
+                    DEFAULT_MB);
+                printf("  -n <n> : Timed runs of each case (default %d).\n",
+                    DEFAULT_RUNS);
+                printf("  -o <filename> : JSON summary (default %s).\n",
+                    DEFAULT_JSON);
+                printf("  -t : Tab size.\n");
+                printf("  -k : Keep tabs.\n");
+                printf("  -h | ?  : Print out command line options.\n");
+                FreeOptArena(optList);
+                return EXIT_SUCCESS;
+        }
+
+        thisOpt = thisOpt->next;
+    }
+
+    FreeOptArena(optList);
+
+    tmpDir = getenv("TMPDIR");
+
+    if ((NULL == tmpDir) || ('\0' == tmpDir[0]))
+    {
+        tmpDir = "/tmp";
+    }
+
+    dir = (char *)malloc(strlen(tmpDir) + sizeof("/trimbench.XXXXXX"));
+    file = (char *)malloc(strlen(tmpDir) + sizeof("/trimbench.XXXXXX") +
+        sizeof("/corpus"));
+    gen.buf = (char *)malloc(size);
+
+    if ((NULL == dir) || (NULL == file) || (NULL == gen.buf))
+    {
+        perror("Memory allocation");
+        free(dir);
+        free(file);
+        free(gen.buf);
+        return EXIT_FAILURE;
+    }
+
+    sprintf(dir, "%s/trimbench.XXXXXX", tmpDir);
+
+    if (NULL == mkdtemp(dir))
+    {
+        perror(dir);
+        free(dir);
+        free(file);
+        free(gen.buf);
+        return EXIT_FAILURE;
+    }
+
+    sprintf(file, "%s/corpus", dir);
+
+    input.path = file;
+    input.data = gen.buf;
+    input.len = size;
+    input.devNull = open("/dev/null", O_WRONLY);
+    defaultScanner = ScanImplName();
+    count = 0;
+    status = 0;
+
+    printf("%-10s %-8s %-8s %10s %10s %10s\n", "corpus", "path", "scanner",
+        "MB/s", "ns/byte", "median");
+
+    for (c = 0; (0 == status) && (NULL != corpora[c].name); c++)
+    {
+        gen.used = 0;
+        gen.len = size;
+        gen.seed = SEED;
+        corpora[c].generate(&gen);
+
+        fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+
+        if ((fd < 0) || (0 != WriteAll(fd, gen.buf, size)) ||
+            (0 != close(fd)))
+        {
+            perror(file);
+            status = -1;
+            break;
+        }
+
+        for (s = 0; (0 == status) && (NULL != scanners[s]); s++)
+        {
+            if (0 != ScanSelect(scanners[s]))
+            {
+                continue;       /* not supported by this CPU */
+            }
+
+            for (p = 0; NULL != paths[p].name; p++)
+            {
+                results[count].corpus = corpora[c].name;
+                results[count].scanner = scanners[s];
+
+                if (0 != TimeCase(&input, &paths[p], &opts, runs,
+                    &results[count]))
+                {
+                    perror(paths[p].name);
+                    status = -1;
+                    break;
+                }
+
+                printf("%-10s %-8s %-8s %10.1f %10.3f %10.3f\n",
+                    results[count].corpus, results[count].path,
+                    results[count].scanner,
+                    (double)size * 1e3 / results[count].best,
+                    results[count].best / (double)size,
+                    results[count].median / (double)size);
+                fflush(stdout);
+                count++;
+            }
+        }
+
+        unlink(file);
+    }
+
+    (void)ScanSelect(defaultScanner);
+    rmdir(dir);
+    close(input.devNull);
+    free(dir);
+    free(file);
+    free(gen.buf);
+
+    if (0 == status)
+    {
+        status = WriteJson(jsonFile, results, count, &opts, runs);
+    }
+
+    return (0 == status) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/****************************************************************************
+*   Function   : TimeCase
+*   Description: This function times trimming a corpus on one path with
+*                the current scanner.  An untimed run warms the page cache
+*                and the scanner before the timed runs.
+*   Parameters : input - corpus to trim
+*                path - how the corpus gets to the trimmer
+*                opts - trimming options
+*                runs - number of timed runs
+*                result - set to the fastest and median times
+*   Effects    : The corpus is trimmed runs + 1 times.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int TimeCase(const input_t *input, const path_t *path,
+    const trim_opts_t *opts, unsigned int runs, result_t *result)
+{
+    double times[MAX_RUNS];
+    double start;
+    unsigned int i;
+
+    if (0 != path->run(input, opts))
+    {
+        return -1;
+    }
+
+    for (i = 0; i < runs; i++)
+    {
+        start = Now();
+
+        if (0 != path->run(input, opts))
+        {
+            return -1;
+        }
+
+        times[i] = Now() - start;
+    }
+
+    qsort(times, runs, sizeof(double), CompareTimes);
+    result->path = path->name;
+    result->bytes = input->len;
+    result->best = times[0];
+    result->median = times[runs / 2];
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : RunMapped
+*   Description: This function trims the corpus file with TrimFd, which
+*                maps regular files.
+*   Parameters : input - corpus to trim
+*                opts - trimming options
+*   Effects    : The trimmed corpus is written to /dev/null.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int RunMapped(const input_t *input, const trim_opts_t *opts)
+{
+    int fd, status;
+
+    fd = open(input->path, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    status = TrimFd(fd, input->devNull, opts);
+    close(fd);
+    return status;
+}
+
+/****************************************************************************
+*   Function   : RunPipe
+*   Description: This function trims the corpus with TrimFd reading from a
+*                pipe, which takes the same read(2) path as stdin.  A
+*                second thread writes the corpus into the pipe.
+*   Parameters : input - corpus to trim
+*                opts - trimming options
+*   Effects    : The trimmed corpus is written to /dev/null.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int RunPipe(const input_t *input, const trim_opts_t *opts)
+{
+    pthread_t writer;
+    pipe_job_t job;
+    int fds[2];
+    int status;
+
+    if (0 != pipe(fds))
+    {
+        return -1;
+    }
+
+    /* the writer owns and closes fds[1] */
+    job.input = input;
+    job.fd = fds[1];
+
+    if (0 != pthread_create(&writer, NULL, PipeWriter, (void *)&job))
+    {
+        close(fds[0]);
+        close(fds[1]);
+        errno = EAGAIN;
+        return -1;
+    }
+
+    status = TrimFd(fds[0], input->devNull, opts);
+    close(fds[0]);
+    pthread_join(writer, NULL);
+    return status;
+}
+
+/****************************************************************************
+*   Function   : RunPipeline
+*   Description: This function trims the corpus from a pipe like RunPipe,
+*                but with reading, trimming, and writing on separate
+*                threads.
+*   Parameters : input - corpus to trim
+*                opts - trimming options
+*   Effects    : The trimmed corpus is written to /dev/null.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int RunPipeline(const input_t *input, const trim_opts_t *opts)
+{
+    trim_opts_t pipeOpts;
+
+    pipeOpts = *opts;
+    pipeOpts.pipeline = 1;
+    return RunPipe(input, &pipeOpts);
+}
+
+/****************************************************************************
+*   Function   : PipeWriter
+*   Description: This function is the thread that feeds the corpus into
+*                the pipe for RunPipe.
+*   Parameters : arg - pointer to the pipe_job_t
+*   Effects    : The corpus is written to the pipe, and its write end is
+*                closed.
+*   Returned   : NULL
+****************************************************************************/
+static void *PipeWriter(void *arg)
+{
+    pipe_job_t *job;
+
+    job = (pipe_job_t *)arg;
+    (void)WriteAll(job->fd, job->input->data, job->input->len);
+    close(job->fd);
+    return NULL;
+}
+
+/****************************************************************************
+*   Function   : RunFeed
+*   Description: This function pushes the corpus through a trimmer straight
+*                from memory, which measures the engine without any I/O.
+*   Parameters : input - corpus to trim
+*                opts - trimming options
+*   Effects    : None
+*   Returned   : 0 for success, otherwise -1.
+****************************************************************************/
+static int RunFeed(const input_t *input, const trim_opts_t *opts)
+{
+    trimmer_t trimmer;
+    size_t count;
+
+    count = 0;
+    TrimmerInit(&trimmer, opts);
+
+    if (0 != TrimmerFeed(&trimmer, input->data, input->len, CountSink,
+        &count))
+    {
+        TrimmerFree(&trimmer);
+        return -1;
+    }
+
+    if (0 != TrimmerFinish(&trimmer, CountSink, &count))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : CountSink
+*   Description: This function is the trim_sink_t for RunFeed.  It only
+*                counts the output, so no copying is timed.
+*   Parameters : context - pointer to the size_t count
+*                data - trimmed output
+*                len - number of bytes in data
+*   Effects    : len is added to the count.
+*   Returned   : 0
+****************************************************************************/
+static int CountSink(void *context, const char *data, size_t len)
+{
+    (void)data;
+    *(size_t *)context += len;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : Now
+*   Description: This function reads the monotonic clock.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Current time in ns.
+****************************************************************************/
+static double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/****************************************************************************
+*   Function   : CompareTimes
+*   Description: This function is the qsort comparison for run times.
+*   Parameters : a - pointer to a double
+*                b - pointer to a double
+*   Effects    : None
+*   Returned   : < 0, 0, or > 0 as a is less than, equal to, or greater
+*                than b.
+****************************************************************************/
+static int CompareTimes(const void *a, const void *b)
+{
+    double x, y;
+
+    x = *(const double *)a;
+    y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/****************************************************************************
+*   Function   : WriteJson
+*   Description: This function writes the results as a JSON summary so
+*                runs can be compared by scripts.
+*   Parameters : fileName - name of the JSON file
+*                results - timed cases
+*                count - number of results
+*                opts - trimming options used
+*                runs - number of timed runs per case
+*   Effects    : fileName is written.
+*   Returned   : 0 for success, otherwise -1.
+****************************************************************************/
+static int WriteJson(const char *fileName, const result_t *results,
+    size_t count, const trim_opts_t *opts, unsigned int runs)
+{
+    FILE *fp;
+    size_t i;
+
+    fp = fopen(fileName, "w");
+
+    if (NULL == fp)
+    {
+        perror(fileName);
+        return -1;
+    }
+
+    fprintf(fp, "{\n  \"tab_size\": %u,\n  \"keep_tabs\": %u,\n",
+        opts->tabSize, opts->keepTabs);
+    fprintf(fp, "  \"runs\": %u,\n  \"default_scanner\": \"%s\",\n", runs,
+        ScanImplName());
+    fprintf(fp, "  \"results\": [\n");
+
+    for (i = 0; i < count; i++)
+    {
+        fprintf(fp, "    {\"corpus\": \"%s\", \"path\": \"%s\", "
+            "\"scanner\": \"%s\", \"bytes\": %lu, ",
+            results[i].corpus, results[i].path, results[i].scanner,
+            (unsigned long)results[i].bytes);
+        fprintf(fp, "\"best_ns\": %.0f, \"median_ns\": %.0f, "
+            "\"mb_per_s\": %.1f, \"ns_per_byte\": %.4f}%s\n",
+            results[i].best, results[i].median,
+            (double)results[i].bytes * 1e3 / results[i].best,
+            results[i].best / (double)results[i].bytes,
+            (i + 1 < count) ? "," : "");
+    }
+
+    fprintf(fp, "  ]\n}\n");
+
+    if (0 != fclose(fp))
+    {
+        perror(fileName);
+        return -1;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : GenSource
+*   Description: This function generates C like source code indented with
+*                tabs, with tab aligned comments and some trailing
+*                whitespace.
+*   Parameters : gen - corpus being generated
+*   Effects    : gen's buffer is filled.
+*   Returned   : None
+****************************************************************************/
+static void GenSource(gen_t *gen)
+{
+    unsigned long i, tokens;
+
+    while (gen->used < gen->len)
+    {
+        if (0 == Rand(gen, 10))
+        {
+            PutChars(gen, '\n', 1);     /* blank line */
+            continue;
+        }
+
+        PutChars(gen, '\t', Rand(gen, 5));
+        tokens = 2 + Rand(gen, 8);
+
+        for (i = 0; i < tokens; i++)
+        {
+            if (0 != i)
+            {
+                PutChars(gen, ' ', 1);
+            }
+
+            PutWord(gen);
+        }
+
+        if (0 == Rand(gen, 4))
+        {
+            PutChars(gen, '\t', 1 + Rand(gen, 3));
+            PutString(gen, "/* ");
+            PutWord(gen);
+            PutChars(gen, ' ', 1);
+            PutWord(gen);
+            PutString(gen, " */");
+        }
+
+        if (0 == Rand(gen, 8))
+        {
+            PutBlanks(gen, 1 + Rand(gen, 4));
+        }
+
+        PutChars(gen, '\n', 1);
+    }
+}
+
+/****************************************************************************
+*   Function   : GenLogs
+*   Description: This function generates log lines padded with long runs
+*                of trailing spaces, like fixed width log records.
+*   Parameters : gen - corpus being generated
+*   Effects    : gen's buffer is filled.
+*   Returned   : None
+****************************************************************************/
+static void GenLogs(gen_t *gen)
+{
+    char stamp[64];
+    unsigned long i, tokens, n;
+
+    n = 0;
+
+    while (gen->used < gen->len)
+    {
+        sprintf(stamp,
+            "2026-10-18 %02lu:%02lu:%02lu.%03lu INFO  worker[%lu]: ",
+            (n / 3600000) % 24, (n / 60000) % 60, (n / 1000) % 60, n % 1000,
+            Rand(gen, 16));
+        PutString(gen, stamp);
+        tokens = 3 + Rand(gen, 10);
+
+        for (i = 0; i < tokens; i++)
+        {
+            PutWord(gen);
+            PutChars(gen, ' ', 1);
+        }
+
+        PutChars(gen, ' ', Rand(gen, 200));
+        PutChars(gen, '\n', 1);
+        n += 1 + Rand(gen, 50);
+    }
+}
+
+/****************************************************************************
+*   Function   : GenCRLF
+*   Description: This function generates text with CRLF line endings and
+*                whitespace before some of the CRs.
+*   Parameters : gen - corpus being generated
+*   Effects    : gen's buffer is filled.
+*   Returned   : None
+****************************************************************************/
+static void GenCRLF(gen_t *gen)
+{
+    unsigned long i, tokens;
+
+    while (gen->used < gen->len)
+    {
+        tokens = Rand(gen, 12);
+
+        for (i = 0; i < tokens; i++)
+        {
+            if (0 != i)
+            {
+                PutChars(gen, ' ', 1);
+            }
+
+            PutWord(gen);
+        }
+
+        if (0 == Rand(gen, 3))
+        {
+            PutBlanks(gen, 1 + Rand(gen, 8));
+        }
+
+        PutString(gen, "\r\n");
+    }
+}
+
+/****************************************************************************
+*   Function   : GenMinified
+*   Description: This function generates minified code: one very long line
+*                of tokens separated by single spaces or nothing at all.
+*   Parameters : gen - corpus being generated
+*   Effects    : gen's buffer is filled.
+*   Returned   : None
+****************************************************************************/
+static void GenMinified(gen_t *gen)
+{
+    while (gen->used < gen->len - 1)
+    {
+        PutWord(gen);
+
+        if (0 == Rand(gen, 3))
+        {
+            PutChars(gen, ' ', 1);
+        }
+    }
+
+    gen->used = gen->len - 1;
+    PutChars(gen, '\n', 1);
+}
+
+/****************************************************************************
+*   Function   : GenRuns
+*   Description: This function generates lines with very long runs of
+*                spaces and tabs between words and at the ends of lines.
+*   Parameters : gen - corpus being generated
+*   Effects    : gen's buffer is filled.
+*   Returned   : None
+****************************************************************************/
+static void GenRuns(gen_t *gen)
+{
+    unsigned long i, tokens;
+
+    while (gen->used < gen->len)
+    {
+        tokens = 1 + Rand(gen, 4);
+
+        for (i = 0; i < tokens; i++)
+        {
+            PutWord(gen);
+            PutBlanks(gen, 1000 + Rand(gen, 9000));
+        }
+
+        PutChars(gen, '\n', 1);
+    }
+}
+
+/****************************************************************************
+*   Function   : Rand
+*   Description: This function is a small linear congruential generator.
+*                It's used instead of rand() so the corpora are the same
+*                on every system.
+*   Parameters : gen - corpus being generated; holds the seed
+*                n - number of possible results
+*   Effects    : gen's seed is advanced.
+*   Returned   : Pseudo random number in [0, n).
+****************************************************************************/
+static unsigned long Rand(gen_t *gen, unsigned long n)
+{
+    gen->seed = (gen->seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    return (gen->seed >> 8) % n;
+}
+
+/****************************************************************************
+*   Function   : PutChars
+*   Description: This function appends copies of a character to a corpus,
+*                stopping when the corpus is full.
+*   Parameters : gen - corpus being generated
+*                c - character to append
+*                count - number of copies
+*   Effects    : gen's buffer is extended.
+*   Returned   : None
+****************************************************************************/
+static void PutChars(gen_t *gen, char c, size_t count)
+{
+    if (count > gen->len - gen->used)
+    {
+        count = gen->len - gen->used;
+    }
+
+    memset(gen->buf + gen->used, c, count);
+    gen->used += count;
+}
+
+/****************************************************************************
+*   Function   : PutString
+*   Description: This function appends a string to a corpus, stopping when
+*                the corpus is full.
+*   Parameters : gen - corpus being generated
+*                str - string to append
+*   Effects    : gen's buffer is extended.
+*   Returned   : None
+****************************************************************************/
+static void PutString(gen_t *gen, const char *str)
+{
+    size_t count;
+
+    count = strlen(str);
+
+    if (count > gen->len - gen->used)
+    {
+        count = gen->len - gen->used;
+    }
+
+    memcpy(gen->buf + gen->used, str, count);
+    gen->used += count;
+}
+
+/****************************************************************************
+*   Function   : PutWord
+*   Description: This function appends a randomly chosen word to a corpus.
+*   Parameters : gen - corpus being generated
+*   Effects    : gen's buffer is extended.
+*   Returned   : None
+****************************************************************************/
+static void PutWord(gen_t *gen)
+{
+    PutString(gen, words[Rand(gen, sizeof(words) / sizeof(words[0]))]);
+}
+
+/****************************************************************************
+*   Function   : PutBlanks
+*   Description: This function appends a random mix of spaces and tabs to
+*                a corpus.
+*   Parameters : gen - corpus being generated
+*                count - number of spaces and tabs
+*   Effects    : gen's buffer is extended.
+*   Returned   : None
+****************************************************************************/
+static void PutBlanks(gen_t *gen, size_t count)
+{
+    size_t i;
+
+    for (i = 0; (i < count) && (gen->used < gen->len); i++)
+    {
+        gen->buf[gen->used] = (0 == Rand(gen, 4)) ? '\t' : ' ';
+        gen->used++;
+    }
+}
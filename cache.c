@@ -0,0 +1,1000 @@
+/***************************************************************************
+*                              Clean File Cache
+*
+*   File    : cache.c
+*   Purpose : Remember which files are already trimmed, so repeated runs
+*             over the same tree can skip them without reading them
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include "cache.h"
+#include "trimfile.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define CACHE_MAGIC     "trim cache 2\n"    /* start of a cache file; the
+                                               version changes when files
+                                               clean before may not be */
+#define MAGIC_LEN       (sizeof(CACHE_MAGIC) - 1)
+#define RECORD_FIELDS   8                   /* 64 bit fields in a record */
+#define RECORD_SIZE     (RECORD_FIELDS * 8 + 4)     /* fields + path length */
+#define MAX_CACHED      (256 * 1024 * 1024) /* largest file read to cache */
+#define BUCKETS_START   1024                /* power of 2 */
+#define NO_ENTRY        ((size_t)-1)
+#define HASH_MULT       ((((uint64_t)0x9E3779B9) << 32) | 0x7F4A7C15)
+
+/* results of looking a file up */
+#define LOOKUP_NONE     0           /* nothing is known about the file */
+#define LOOKUP_CLEAN    1           /* its status shows it's unchanged */
+#define LOOKUP_HASH     2           /* its contents must be compared */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+/* a file known to be clean under a set of options.  The fields from opts
+ * through hash are stored in this order in each record of a cache file,
+ * followed by the 32 bit length of the path and the path. */
+typedef struct cache_entry_t
+{
+    uint64_t opts;              /* key of the options it's clean under */
+    uint64_t dev;               /* device holding the file */
+    uint64_t ino;               /* the file's inode */
+    uint64_t size;              /* length of the file */
+    int64_t mtimeSec;           /* last modification time */
+    int64_t mtimeNsec;
+    int64_t recorded;           /* time before the file was read */
+    uint64_t hash;              /* hash of the file's contents */
+    char *path;                 /* name of the file */
+    size_t pathLen;             /* length of path */
+    size_t next;                /* next entry in the same bucket */
+    int dirty;                  /* added or updated by this process */
+} cache_entry_t;
+
+struct cache_t
+{
+    char *fileName;             /* name of the cache file */
+    const trim_opts_t *opts;    /* options files are checked with */
+    uint64_t key;               /* key of opts */
+    cache_entry_t *entries;     /* every entry, whatever its options */
+    size_t count;               /* number of entries */
+    size_t size;                /* capacity of entries */
+    size_t *buckets;            /* first entry of each hash chain */
+    size_t bucketCount;         /* number of buckets, a power of 2 */
+    int dirty;                  /* non-zero if there's anything to save */
+    pthread_mutex_t lock;       /* protects everything above */
+};
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static int TableInit(cache_t *cache);
+static void TableFree(cache_t *cache);
+static size_t Find(const cache_t *cache, const char *path, size_t pathLen,
+    uint64_t key);
+static int Put(cache_t *cache, const cache_entry_t *entry);
+static int Rehash(cache_t *cache, size_t bucketCount);
+static int Lookup(cache_t *cache, const char *path, const struct stat *sb,
+    uint64_t *hash);
+static void Record(cache_t *cache, const char *path, const struct stat *sb,
+    int64_t recorded, uint64_t hash);
+
+static int Load(cache_t *cache);
+static int Save(cache_t *cache);
+static int WriteEntries(const cache_t *cache, FILE *fp);
+
+static uint64_t OptsKey(const trim_opts_t *opts);
+static uint64_t Hash(const char *data, size_t len, uint64_t seed);
+static int ReadFully(int fd, char *buf, size_t len, size_t *got);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : CacheOpen
+*   Description: This function loads a cache of files known to be clean.
+*                Each entry holds a file's name, device, inode, size,
+*                modification time, a hash of its contents, and a key made
+*                from the trimming options it was checked with, so entries
+*                for other options are kept but never matched.  A missing
+*                or unrecognized cache file is treated as empty.
+*   Parameters : fileName - name of the cache file
+*                opts - options files will be checked with.  They must
+*                       outlive the cache.
+*   Effects    : Reads the cache file.
+*   Returned   : Pointer to the cache, or NULL with errno set.
+****************************************************************************/
+cache_t *CacheOpen(const char *fileName, const trim_opts_t *opts)
+{
+    cache_t *cache;
+    int err;
+
+    cache = (cache_t *)calloc(1, sizeof(cache_t));
+
+    if (NULL == cache)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    cache->fileName = (char *)malloc(strlen(fileName) + 1);
+
+    if ((NULL == cache->fileName) || (0 != TableInit(cache)))
+    {
+        free(cache->fileName);
+        free(cache);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    strcpy(cache->fileName, fileName);
+    cache->opts = opts;
+    cache->key = OptsKey(opts);
+
+    if (0 != Load(cache))
+    {
+        err = errno;
+        TableFree(cache);
+        free(cache->fileName);
+        free(cache);
+        errno = err;
+        return NULL;
+    }
+
+    pthread_mutex_init(&cache->lock, NULL);
+    return cache;
+}
+
+/****************************************************************************
+*   Function   : CacheCheckFile
+*   Description: This function does what CheckFd does for a named file,
+*                but a file whose status matches its entry is known to be
+*                clean without reading it.  If the status doesn't match
+*                (the file was touched or checked out again) but the size
+*                does, or if the file may have changed within the same
+*                tick of the clock as it was recorded, its contents are
+*                hashed and compared instead of checked.  Any other file
+*                is read into memory, hashed, and checked, so the entry
+*                made for a clean file always describes the bytes that
+*                were checked.
+*   Parameters : cache - cache opened by CacheOpen
+*                path - name of the file to check
+*                list - non-zero to build a report of every change
+*                report - set to a malloc'd report, or NULL if there is
+*                         nothing to report
+*                reportLen - set to the length of the report
+*                changed - set to 1 if trimming would change the file,
+*                          otherwise 0
+*   Effects    : May read the file, and may add an entry to the cache.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+*
+*   NOTE: The caller is responsible for freeing *report.
+****************************************************************************/
+int CacheCheckFile(cache_t *cache, const char *path, int list,
+    char **report, size_t *reportLen, int *changed)
+{
+    struct stat sb;
+    uint64_t hash, known;
+    int64_t start;
+    char *data;
+    size_t len;
+    int fd, err, found, status;
+
+    *report = NULL;
+    *reportLen = 0;
+    *changed = 0;
+    found = LOOKUP_NONE;
+    known = 0;
+
+    if ((0 == stat(path, &sb)) && S_ISREG(sb.st_mode))
+    {
+        found = Lookup(cache, path, &sb, &known);
+
+        if (LOOKUP_CLEAN == found)
+        {
+            return 0;
+        }
+    }
+
+    /* a change after this time gives the file a later time stamp */
+    start = (int64_t)time(NULL);
+    fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (0 != fstat(fd, &sb))
+    {
+        err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    if (!S_ISREG(sb.st_mode) || (sb.st_size > MAX_CACHED))
+    {
+        /* not worth caching */
+        status = CheckFd(fd, cache->opts, path, list, report, reportLen,
+            changed);
+        err = errno;
+        close(fd);
+        errno = err;
+        return status;
+    }
+
+    data = (char *)malloc((0 == sb.st_size) ? 1 : (size_t)sb.st_size);
+
+    if (NULL == data)
+    {
+        close(fd);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    status = ReadFully(fd, data, (size_t)sb.st_size, &len);
+    err = errno;
+    close(fd);
+
+    if (0 != status)
+    {
+        free(data);
+        errno = err;
+        return -1;
+    }
+
+    hash = Hash(data, len, 0);
+
+    if ((LOOKUP_HASH == found) && (hash == known) &&
+        (len == (size_t)sb.st_size))
+    {
+        /* the same contents; only the status needs updating */
+        Record(cache, path, &sb, start, hash);
+        free(data);
+        return 0;
+    }
+
+    status = CheckMemory(data, len, cache->opts, path, list, report,
+        reportLen, changed);
+    err = errno;
+
+    if ((0 == status) && !*changed && (len == (size_t)sb.st_size))
+    {
+        Record(cache, path, &sb, start, hash);
+    }
+
+    free(data);
+    errno = err;
+    return status;
+}
+
+/****************************************************************************
+*   Function   : CacheClose
+*   Description: This function saves any files found clean and frees the
+*                cache.  Several processes may save the same cache, so
+*                the file is locked, read again, and merged with this
+*                process's entries, and the result is written to a
+*                temporary file that's renamed over the cache.  Readers
+*                never lock; they always see a whole cache file.
+*   Parameters : cache - cache opened by CacheOpen
+*   Effects    : The cache file may be replaced, and the cache is freed.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+int CacheClose(cache_t *cache)
+{
+    int status, err;
+
+    status = cache->dirty ? Save(cache) : 0;
+    err = errno;
+
+    pthread_mutex_destroy(&cache->lock);
+    TableFree(cache);
+    free(cache->fileName);
+    free(cache);
+    errno = err;
+    return status;
+}
+
+/****************************************************************************
+*   Function   : TableInit
+*   Description: This function makes an empty table of entries.
+*   Parameters : cache - cache holding the table
+*   Effects    : Allocates the table's buckets.
+*   Returned   : 0 for success, otherwise -1.
+****************************************************************************/
+static int TableInit(cache_t *cache)
+{
+    cache->entries = NULL;
+    cache->count = 0;
+    cache->size = 0;
+    cache->bucketCount = 0;
+    cache->buckets = NULL;
+    cache->dirty = 0;
+    return Rehash(cache, BUCKETS_START);
+}
+
+/****************************************************************************
+*   Function   : TableFree
+*   Description: This function frees a table of entries.
+*   Parameters : cache - cache holding the table
+*   Effects    : Frees the entries, their paths, and the buckets.
+*   Returned   : None
+****************************************************************************/
+static void TableFree(cache_t *cache)
+{
+    size_t i;
+
+    for (i = 0; i < cache->count; i++)
+    {
+        free(cache->entries[i].path);
+    }
+
+    free(cache->entries);
+    free(cache->buckets);
+}
+
+/****************************************************************************
+*   Function   : Find
+*   Description: This function finds the entry for a file and set of
+*                options.
+*   Parameters : cache - cache to search
+*                path - name of the file
+*                pathLen - length of path
+*                key - key of the options
+*   Effects    : None
+*   Returned   : Index of the entry, or NO_ENTRY.
+****************************************************************************/
+static size_t Find(const cache_t *cache, const char *path, size_t pathLen,
+    uint64_t key)
+{
+    size_t i;
+    cache_entry_t *entry;
+
+    i = cache->buckets[Hash(path, pathLen, key) & (cache->bucketCount - 1)];
+
+    while (NO_ENTRY != i)
+    {
+        entry = &cache->entries[i];
+
+        if ((entry->opts == key) && (entry->pathLen == pathLen) &&
+            (0 == memcmp(entry->path, path, pathLen)))
+        {
+            break;
+        }
+
+        i = entry->next;
+    }
+
+    return i;
+}
+
+/****************************************************************************
+*   Function   : Put
+*   Description: This function adds an entry, or replaces the entry for
+*                the same file and options.
+*   Parameters : cache - cache to add to
+*                entry - entry to add.  Its path is copied.
+*   Effects    : The table may grow.
+*   Returned   : 0 for success, otherwise -1.
+****************************************************************************/
+static int Put(cache_t *cache, const cache_entry_t *entry)
+{
+    cache_entry_t *newEntries, *dest;
+    size_t i, bucket;
+    char *path;
+
+    i = Find(cache, entry->path, entry->pathLen, entry->opts);
+
+    if (NO_ENTRY != i)
+    {
+        dest = &cache->entries[i];
+        path = dest->path;
+        bucket = dest->next;
+        *dest = *entry;
+        dest->path = path;
+        dest->next = bucket;
+        return 0;
+    }
+
+    if (cache->count == cache->size)
+    {
+        newEntries = (cache_entry_t *)realloc(cache->entries,
+            (cache->size + BUCKETS_START) * 2 * sizeof(cache_entry_t));
+
+        if (NULL == newEntries)
+        {
+            return -1;
+        }
+
+        cache->entries = newEntries;
+        cache->size = (cache->size + BUCKETS_START) * 2;
+    }
+
+    if ((cache->count >= cache->bucketCount) &&
+        (0 != Rehash(cache, cache->bucketCount * 2)))
+    {
+        return -1;
+    }
+
+    path = (char *)malloc(entry->pathLen + 1);
+
+    if (NULL == path)
+    {
+        return -1;
+    }
+
+    memcpy(path, entry->path, entry->pathLen);
+    path[entry->pathLen] = '\0';
+
+    dest = &cache->entries[cache->count];
+    *dest = *entry;
+    dest->path = path;
+    bucket = Hash(path, entry->pathLen, entry->opts) &
+        (cache->bucketCount - 1);
+    dest->next = cache->buckets[bucket];
+    cache->buckets[bucket] = cache->count;
+    cache->count++;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : Rehash
+*   Description: This function changes the number of hash buckets and
+*                relinks every entry.
+*   Parameters : cache - cache holding the table
+*                bucketCount - new number of buckets, a power of 2
+*   Effects    : Replaces the buckets.
+*   Returned   : 0 for success, otherwise -1.
+****************************************************************************/
+static int Rehash(cache_t *cache, size_t bucketCount)
+{
+    size_t *buckets;
+    size_t i, bucket;
+    cache_entry_t *entry;
+
+    buckets = (size_t *)malloc(bucketCount * sizeof(size_t));
+
+    if (NULL == buckets)
+    {
+        return -1;
+    }
+
+    for (i = 0; i < bucketCount; i++)
+    {
+        buckets[i] = NO_ENTRY;
+    }
+
+    for (i = 0; i < cache->count; i++)
+    {
+        entry = &cache->entries[i];
+        bucket = Hash(entry->path, entry->pathLen, entry->opts) &
+            (bucketCount - 1);
+        entry->next = buckets[bucket];
+        buckets[bucket] = i;
+    }
+
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucketCount = bucketCount;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : Lookup
+*   Description: This function compares a file's status with its entry.
+*                An entry recorded in the same second the file was last
+*                modified can't be trusted by status alone (the file may
+*                have been changed again within the same tick), so its
+*                contents must be compared.
+*   Parameters : cache - cache to search
+*                path - name of the file
+*                sb - status of the file
+*                hash - set to the hash of the recorded contents if they
+*                       must be compared
+*   Effects    : None
+*   Returned   : LOOKUP_CLEAN if the status matches, LOOKUP_HASH if the
+*                contents must be compared, otherwise LOOKUP_NONE.
+****************************************************************************/
+static int Lookup(cache_t *cache, const char *path, const struct stat *sb,
+    uint64_t *hash)
+{
+    cache_entry_t *entry;
+    size_t i;
+    int found;
+
+    found = LOOKUP_NONE;
+    pthread_mutex_lock(&cache->lock);
+    i = Find(cache, path, strlen(path), cache->key);
+
+    if (NO_ENTRY != i)
+    {
+        entry = &cache->entries[i];
+
+        if (entry->size == (uint64_t)sb->st_size)
+        {
+            found = LOOKUP_HASH;
+            *hash = entry->hash;
+
+            if ((entry->dev == (uint64_t)sb->st_dev) &&
+                (entry->ino == (uint64_t)sb->st_ino) &&
+                (entry->mtimeSec == (int64_t)sb->st_mtim.tv_sec) &&
+                (entry->mtimeNsec == (int64_t)sb->st_mtim.tv_nsec) &&
+                (entry->mtimeSec < entry->recorded))
+            {
+                found = LOOKUP_CLEAN;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+    return found;
+}
+
+/****************************************************************************
+*   Function   : Record
+*   Description: This function records a file as clean under the cache's
+*                options.  Running out of memory only loses the entry.
+*   Parameters : cache - cache to add to
+*                path - name of the file
+*                sb - status of the file before it was read
+*                recorded - time before the status was taken
+*                hash - hash of the contents that were checked
+*   Effects    : Adds or updates the file's entry.
+*   Returned   : None
+****************************************************************************/
+static void Record(cache_t *cache, const char *path, const struct stat *sb,
+    int64_t recorded, uint64_t hash)
+{
+    cache_entry_t entry;
+
+    entry.opts = cache->key;
+    entry.dev = (uint64_t)sb->st_dev;
+    entry.ino = (uint64_t)sb->st_ino;
+    entry.size = (uint64_t)sb->st_size;
+    entry.mtimeSec = (int64_t)sb->st_mtim.tv_sec;
+    entry.mtimeNsec = (int64_t)sb->st_mtim.tv_nsec;
+    entry.recorded = recorded;
+    entry.hash = hash;
+    entry.path = (char *)path;
+    entry.pathLen = strlen(path);
+    entry.dirty = 1;
+
+    pthread_mutex_lock(&cache->lock);
+
+    if (0 == Put(cache, &entry))
+    {
+        cache->dirty = 1;
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/****************************************************************************
+*   Function   : Load
+*   Description: This function reads every entry of a cache file into a
+*                table.  Reading stops at anything that isn't a whole
+*                record, so a damaged file loses at most its tail.
+*   Parameters : cache - cache with the file name and an empty table
+*   Effects    : Fills the table.
+*   Returned   : 0 for success (including a missing file), otherwise -1
+*                with errno set.
+****************************************************************************/
+static int Load(cache_t *cache)
+{
+    struct stat sb;
+    cache_entry_t entry;
+    uint64_t fields[RECORD_FIELDS];
+    uint32_t pathLen;
+    char *data;
+    size_t len, pos;
+    int fd, status, err;
+
+    fd = open(cache->fileName, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return (ENOENT == errno) ? 0 : -1;
+    }
+
+    if (0 != fstat(fd, &sb))
+    {
+        err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    if (!S_ISREG(sb.st_mode) || ((off_t)(size_t)sb.st_size != sb.st_size))
+    {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+
+    data = (char *)malloc((0 == sb.st_size) ? 1 : (size_t)sb.st_size);
+
+    if (NULL == data)
+    {
+        close(fd);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    status = ReadFully(fd, data, (size_t)sb.st_size, &len);
+    err = errno;
+    close(fd);
+
+    if ((0 == status) &&
+        ((len < MAGIC_LEN) || (0 != memcmp(data, CACHE_MAGIC, MAGIC_LEN))))
+    {
+        /* not a cache file this version can read; it'll be replaced */
+        len = 0;
+    }
+
+    for (pos = MAGIC_LEN; (0 == status) && (pos + RECORD_SIZE <= len);
+        pos += RECORD_SIZE + pathLen)
+    {
+        memcpy(fields, data + pos, sizeof(fields));
+        memcpy(&pathLen, data + pos + sizeof(fields), sizeof(pathLen));
+
+        if ((0 == pathLen) || (pathLen > len - pos - RECORD_SIZE))
+        {
+            break;
+        }
+
+        entry.opts = fields[0];
+        entry.dev = fields[1];
+        entry.ino = fields[2];
+        entry.size = fields[3];
+        entry.mtimeSec = (int64_t)fields[4];
+        entry.mtimeNsec = (int64_t)fields[5];
+        entry.recorded = (int64_t)fields[6];
+        entry.hash = fields[7];
+        entry.path = data + pos + RECORD_SIZE;
+        entry.pathLen = pathLen;
+        entry.dirty = 0;
+
+        if (0 != Put(cache, &entry))
+        {
+            err = ENOMEM;
+            status = -1;
+        }
+    }
+
+    free(data);
+    errno = err;
+    return status;
+}
+
+/****************************************************************************
+*   Function   : Save
+*   Description: This function merges a cache's new entries into its file.
+*                The cache file is read again under an exclusive lock on
+*                "<cache>.lock", so entries saved by other processes since
+*                it was loaded are kept, and the merged entries are written
+*                to a temporary file that's renamed over the cache.
+*   Parameters : cache - cache with new entries
+*   Effects    : The cache file is replaced.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int Save(cache_t *cache)
+{
+    cache_t merged;
+    struct flock lock;
+    char *lockName, *tmpName;
+    size_t nameLen, i;
+    mode_t mask;
+    FILE *fp;
+    int lockFd, fd, status, err;
+
+    nameLen = strlen(cache->fileName);
+    lockName = (char *)malloc(nameLen + sizeof(".lock"));
+    tmpName = (char *)malloc(nameLen + sizeof(".XXXXXX"));
+
+    if ((NULL == lockName) || (NULL == tmpName))
+    {
+        free(lockName);
+        free(tmpName);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    sprintf(lockName, "%s.lock", cache->fileName);
+    sprintf(tmpName, "%s.XXXXXX", cache->fileName);
+    lockFd = open(lockName, O_RDWR | O_CREAT, 0666);
+    free(lockName);
+
+    if (lockFd < 0)
+    {
+        free(tmpName);
+        return -1;
+    }
+
+    /* released when lockFd is closed */
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+
+    while (0 != (status = fcntl(lockFd, F_SETLKW, &lock)))
+    {
+        if (EINTR != errno)
+        {
+            break;
+        }
+    }
+
+    merged.fileName = cache->fileName;
+    merged.key = cache->key;
+
+    if ((0 == status) && (0 != TableInit(&merged)))
+    {
+        errno = ENOMEM;
+        status = -1;
+    }
+    else if (0 == status)
+    {
+        status = Load(&merged);
+
+        for (i = 0; (0 == status) && (i < cache->count); i++)
+        {
+            if (cache->entries[i].dirty &&
+                (0 != Put(&merged, &cache->entries[i])))
+            {
+                errno = ENOMEM;
+                status = -1;
+            }
+        }
+
+        fd = -1;
+
+        if ((0 == status) && ((fd = mkstemp(tmpName)) < 0))
+        {
+            status = -1;
+        }
+
+        if (0 == status)
+        {
+            /* mkstemp makes it private; make it like any other file */
+            mask = umask(0);
+            umask(mask);
+            (void)fchmod(fd, 0666 & ~mask);
+
+            fp = fdopen(fd, "wb");
+
+            if (NULL == fp)
+            {
+                close(fd);
+                status = -1;
+            }
+            else
+            {
+                status = WriteEntries(&merged, fp);
+                err = errno;
+
+                if ((0 != fclose(fp)) && (0 == status))
+                {
+                    err = errno;
+                    status = -1;
+                }
+
+                errno = err;
+            }
+
+            if ((0 == status) && (0 != rename(tmpName, cache->fileName)))
+            {
+                status = -1;
+            }
+
+            if (0 != status)
+            {
+                err = errno;
+                unlink(tmpName);
+                errno = err;
+            }
+        }
+
+        TableFree(&merged);
+    }
+
+    err = errno;
+    close(lockFd);
+    free(tmpName);
+    errno = err;
+    return status;
+}
+
+/****************************************************************************
+*   Function   : WriteEntries
+*   Description: This function writes a cache file's magic string and a
+*                record for every entry.
+*   Parameters : cache - cache to write
+*                fp - file to write to
+*   Effects    : Writes the cache to fp.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int WriteEntries(const cache_t *cache, FILE *fp)
+{
+    unsigned char record[RECORD_SIZE];
+    uint64_t fields[RECORD_FIELDS];
+    uint32_t pathLen;
+    const cache_entry_t *entry;
+    size_t i;
+
+    if (1 != fwrite(CACHE_MAGIC, MAGIC_LEN, 1, fp))
+    {
+        return -1;
+    }
+
+    for (i = 0; i < cache->count; i++)
+    {
+        entry = &cache->entries[i];
+        fields[0] = entry->opts;
+        fields[1] = entry->dev;
+        fields[2] = entry->ino;
+        fields[3] = entry->size;
+        fields[4] = (uint64_t)entry->mtimeSec;
+        fields[5] = (uint64_t)entry->mtimeNsec;
+        fields[6] = (uint64_t)entry->recorded;
+        fields[7] = entry->hash;
+        pathLen = (uint32_t)entry->pathLen;
+        memcpy(record, fields, sizeof(fields));
+        memcpy(record + sizeof(fields), &pathLen, sizeof(pathLen));
+
+        if ((1 != fwrite(record, RECORD_SIZE, 1, fp)) ||
+            (1 != fwrite(entry->path, entry->pathLen, 1, fp)))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : OptsKey
+*   Description: This function makes a key from every option that changes
+*                what trimming does to a file.  A file clean under one set
+*                of options may not be under another.
+*   Parameters : opts - trimming options
+*   Effects    : None
+*   Returned   : The key.
+****************************************************************************/
+static uint64_t OptsKey(const trim_opts_t *opts)
+{
+    unsigned int values[7];
+    uint64_t key;
+
+    values[0] = opts->tabSize;
+    values[1] = opts->keepTabs;
+    values[2] = opts->retab;
+    values[3] = (NULL == opts->tabStops) ? 0 : opts->tabStops->last;
+    values[4] = (NULL == opts->tabStops) ? 0 : opts->tabStops->interval;
+    values[5] = opts->eol;
+    values[6] = opts->utf8;
+    key = Hash((const char *)values, sizeof(values), 0);
+
+    if (NULL != opts->tabStops)
+    {
+        key = Hash((const char *)opts->tabStops->widths,
+            opts->tabStops->last * sizeof(unsigned int), key);
+    }
+
+    return key;
+}
+
+/****************************************************************************
+*   Function   : Hash
+*   Description: This function is a fast 64 bit hash that mixes in a word
+*                at a time.  It's meant to notice changed files, not to
+*                resist deliberate collisions.
+*   Parameters : data - bytes to hash
+*                len - number of bytes in data
+*                seed - starting value, to hash more data after a prior
+*                       result
+*   Effects    : None
+*   Returned   : The hash.
+****************************************************************************/
+static uint64_t Hash(const char *data, size_t len, uint64_t seed)
+{
+    uint64_t h, word;
+
+    h = (seed ^ (uint64_t)len) * HASH_MULT;
+
+    while (len >= sizeof(word))
+    {
+        memcpy(&word, data, sizeof(word));
+        h = (h ^ word) * HASH_MULT;
+        h ^= h >> 29;
+        data += sizeof(word);
+        len -= sizeof(word);
+    }
+
+    word = 0;
+    memcpy(&word, data, len);
+    h = (h ^ word) * HASH_MULT;
+    h ^= h >> 32;
+    return h;
+}
+
+/****************************************************************************
+*   Function   : ReadFully
+*   Description: This function reads up to len bytes, stopping early only
+*                at end of file.
+*   Parameters : fd - descriptor to read
+*                buf - buffer to read into
+*                len - number of bytes wanted
+*                got - set to the number of bytes read
+*   Effects    : Reads fd.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int ReadFully(int fd, char *buf, size_t len, size_t *got)
+{
+    ssize_t result;
+
+    *got = 0;
+
+    while (*got < len)
+    {
+        result = read(fd, buf + *got, len - *got);
+
+        if (result < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            return -1;
+        }
+
+        if (0 == result)
+        {
+            break;
+        }
+
+        *got += (size_t)result;
+    }
+
+    return 0;
+}
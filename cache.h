@@ -0,0 +1,60 @@
+/***************************************************************************
+*                              Clean File Cache
+*
+*   File    : cache.h
+*   Purpose : Header for the on-disk cache of files known to be clean
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef CACHE_H
+#define CACHE_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stddef.h>
+#include "trimmer.h"
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef struct cache_t cache_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* loads the cache for files trimmed with opts; a missing file is empty */
+cache_t *CacheOpen(const char *fileName, const trim_opts_t *opts);
+
+/* CheckFd on a named file, skipping files known to be clean and
+ * remembering the ones found clean.  May be called from any thread. */
+int CacheCheckFile(cache_t *cache, const char *path, int list,
+    char **report, size_t *reportLen, int *changed);
+
+/* merges the files found clean into the cache file and frees the cache */
+int CacheClose(cache_t *cache);
+
+#endif  /* ndef CACHE_H */
@@ -0,0 +1,488 @@
+/***************************************************************************
+*                            Compressed Streams
+*
+*   File    : codec.c
+*   Purpose : Compress and decompress gzip and zstd streams a buffer at a
+*             time, so compressed logs can be trimmed without separate
+*             processes
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include "codec.h"
+
+#ifndef NO_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define GZIP_WBITS      (MAX_WBITS + 16)    /* zlib window with gzip wrapper */
+#define GZIP_MEM_LEVEL  8                   /* zlib's default */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+struct codec_t
+{
+    int format;                 /* CODEC_GZIP or CODEC_ZSTD */
+    int compress;               /* non-zero for a compressor */
+    int done;                   /* a decompressor reached the end of a
+                                 * gzip member or zstd frame */
+#ifndef NO_ZLIB
+    z_stream z;                 /* gzip state */
+#endif
+#ifdef WITH_ZSTD
+    ZSTD_CCtx *cctx;            /* zstd compressor */
+    ZSTD_DCtx *dctx;            /* zstd decompressor */
+#endif
+};
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+#ifndef NO_ZLIB
+static int RunGzip(codec_t *codec, const char **in, size_t *inLen,
+    char *out, size_t outSize, size_t *outLen, int finish);
+#endif
+
+#ifdef WITH_ZSTD
+static int RunZstd(codec_t *codec, const char **in, size_t *inLen,
+    char *out, size_t outSize, size_t *outLen, int finish);
+#endif
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : CodecFromMagic
+*   Description: This function recognizes a compressed stream by the magic
+*                bytes it starts with: 1f 8b for gzip and 28 b5 2f fd for
+*                a zstd frame.  Text never starts with either.
+*   Parameters : buf - start of the stream
+*                len - number of bytes in buf
+*   Effects    : None
+*   Returned   : CODEC_GZIP, CODEC_ZSTD, or CODEC_NONE.
+****************************************************************************/
+int CodecFromMagic(const char *buf, size_t len)
+{
+    const unsigned char *b;
+
+    b = (const unsigned char *)buf;
+
+    if ((len >= 2) && (0x1F == b[0]) && (0x8B == b[1]))
+    {
+        return CODEC_GZIP;
+    }
+
+    if ((len >= 4) && (0x28 == b[0]) && (0xB5 == b[1]) && (0x2F == b[2]) &&
+        (0xFD == b[3]))
+    {
+        return CODEC_ZSTD;
+    }
+
+    return CODEC_NONE;
+}
+
+/****************************************************************************
+*   Function   : CodecFromName
+*   Description: This function picks the format to write a file in from
+*                its extension.
+*   Parameters : name - name of the file
+*   Effects    : None
+*   Returned   : CODEC_GZIP for ".gz", CODEC_ZSTD for ".zst", otherwise
+*                CODEC_NONE.
+****************************************************************************/
+int CodecFromName(const char *name)
+{
+    size_t len;
+
+    len = strlen(name);
+
+    if ((len > 3) && (0 == strcmp(name + len - 3, ".gz")))
+    {
+        return CODEC_GZIP;
+    }
+
+    if ((len > 4) && (0 == strcmp(name + len - 4, ".zst")))
+    {
+        return CODEC_ZSTD;
+    }
+
+    return CODEC_NONE;
+}
+
+/****************************************************************************
+*   Function   : CodecSupported
+*   Description: This function reports whether a format was built in.
+*                gzip needs zlib and is left out with -DNO_ZLIB; zstd needs
+*                libzstd and is added with -DWITH_ZSTD.
+*   Parameters : format - CODEC_GZIP or CODEC_ZSTD
+*   Effects    : None
+*   Returned   : Non-zero if format can be compressed and decompressed.
+****************************************************************************/
+int CodecSupported(int format)
+{
+#ifndef NO_ZLIB
+    if (CODEC_GZIP == format)
+    {
+        return 1;
+    }
+#endif
+
+#ifdef WITH_ZSTD
+    if (CODEC_ZSTD == format)
+    {
+        return 1;
+    }
+#endif
+
+    (void)format;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : CodecNew
+*   Description: This function makes a compressor or decompressor.  gzip
+*                output uses zlib's default level, and zstd output uses
+*                zstd's.
+*   Parameters : format - CODEC_GZIP or CODEC_ZSTD
+*                compress - non-zero for a compressor, 0 for a
+*                           decompressor
+*   Effects    : Memory is allocated for the codec.
+*   Returned   : Pointer to the codec, or NULL with errno set to ENOTSUP
+*                if the format wasn't built in, or ENOMEM.
+*
+*   NOTE: CodecFree must be called to free the codec.
+****************************************************************************/
+codec_t *CodecNew(int format, int compress)
+{
+    codec_t *codec;
+    int ret;
+
+    if (!CodecSupported(format))
+    {
+        errno = ENOTSUP;
+        return NULL;
+    }
+
+    codec = (codec_t *)calloc(1, sizeof(codec_t));
+
+    if (NULL == codec)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    codec->format = format;
+    codec->compress = compress;
+    codec->done = 0;
+    ret = -1;
+
+#ifndef NO_ZLIB
+    if (CODEC_GZIP == format)
+    {
+        codec->z.zalloc = Z_NULL;
+        codec->z.zfree = Z_NULL;
+        codec->z.opaque = Z_NULL;
+
+        if (compress)
+        {
+            ret = deflateInit2(&codec->z, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                GZIP_WBITS, GZIP_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+        }
+        else
+        {
+            ret = inflateInit2(&codec->z, GZIP_WBITS);
+        }
+
+        ret = (Z_OK == ret) ? 0 : -1;
+    }
+#endif
+
+#ifdef WITH_ZSTD
+    if (CODEC_ZSTD == format)
+    {
+        if (compress)
+        {
+            codec->cctx = ZSTD_createCCtx();
+            ret = (NULL == codec->cctx) ? -1 : 0;
+        }
+        else
+        {
+            codec->dctx = ZSTD_createDCtx();
+            ret = (NULL == codec->dctx) ? -1 : 0;
+        }
+    }
+#endif
+
+    if (0 != ret)
+    {
+        free(codec);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    return codec;
+}
+
+/****************************************************************************
+*   Function   : CodecRun
+*   Description: This function compresses or decompresses as much as fits
+*                in an output buffer.  A decompressor treats gzip members
+*                or zstd frames that follow one another (as from cat a.gz
+*                b.gz) as one stream.  Input that ends before the last one
+*                does is reported as corrupt.
+*   Parameters : codec - codec made by CodecNew
+*                in - pointer to the input; it's advanced past what's used
+*                inLen - bytes at *in; it's reduced by what's used
+*                out - buffer output is written to
+*                outSize - size of out
+*                outLen - set to the number of bytes written to out
+*                finish - non-zero if there's no more input after *in
+*   Effects    : Output is written to out, and the codec's state advances.
+*   Returned   : 1 once the stream is complete (finish is set and all of
+*                the output has been produced), 0 if the codec should be
+*                called again, or -1 with errno set to EBADMSG for corrupt
+*                input or ENOMEM.
+****************************************************************************/
+int CodecRun(codec_t *codec, const char **in, size_t *inLen, char *out,
+    size_t outSize, size_t *outLen, int finish)
+{
+    *outLen = 0;
+
+#ifndef NO_ZLIB
+    if (CODEC_GZIP == codec->format)
+    {
+        return RunGzip(codec, in, inLen, out, outSize, outLen, finish);
+    }
+#endif
+
+#ifdef WITH_ZSTD
+    if (CODEC_ZSTD == codec->format)
+    {
+        return RunZstd(codec, in, inLen, out, outSize, outLen, finish);
+    }
+#endif
+
+    (void)codec;
+    (void)in;
+    (void)inLen;
+    (void)out;
+    (void)outSize;
+    (void)finish;
+    errno = ENOTSUP;
+    return -1;
+}
+
+/****************************************************************************
+*   Function   : CodecFree
+*   Description: This function frees a codec made by CodecNew.
+*   Parameters : codec - codec to free, may be NULL
+*   Effects    : The codec and its library state are freed.
+*   Returned   : None
+****************************************************************************/
+void CodecFree(codec_t *codec)
+{
+    if (NULL == codec)
+    {
+        return;
+    }
+
+#ifndef NO_ZLIB
+    if (CODEC_GZIP == codec->format)
+    {
+        if (codec->compress)
+        {
+            (void)deflateEnd(&codec->z);
+        }
+        else
+        {
+            (void)inflateEnd(&codec->z);
+        }
+    }
+#endif
+
+#ifdef WITH_ZSTD
+    ZSTD_freeCCtx(codec->cctx);
+    ZSTD_freeDCtx(codec->dctx);
+#endif
+
+    free(codec);
+}
+
+#ifndef NO_ZLIB
+/****************************************************************************
+*   Function   : RunGzip
+*   Description: This function is CodecRun for gzip.  zlib's counts are
+*                unsigned ints, so at most UINT_MAX bytes are used a call.
+*   Parameters : See CodecRun.
+*   Effects    : See CodecRun.
+*   Returned   : See CodecRun.
+****************************************************************************/
+static int RunGzip(codec_t *codec, const char **in, size_t *inLen,
+    char *out, size_t outSize, size_t *outLen, int finish)
+{
+    uInt avail;
+    int ret;
+
+    if (!codec->compress && codec->done && (0 != *inLen))
+    {
+        /* another member follows */
+        (void)inflateReset(&codec->z);
+        codec->done = 0;
+    }
+
+    avail = (*inLen > UINT_MAX) ? UINT_MAX : (uInt)*inLen;
+    codec->z.next_in = (Bytef *)*in;
+    codec->z.avail_in = avail;
+    codec->z.next_out = (Bytef *)out;
+    codec->z.avail_out = (outSize > UINT_MAX) ? UINT_MAX : (uInt)outSize;
+
+    if (codec->compress)
+    {
+        ret = deflate(&codec->z, finish ? Z_FINISH : Z_NO_FLUSH);
+    }
+    else if (!codec->done)
+    {
+        ret = inflate(&codec->z, Z_NO_FLUSH);
+    }
+    else
+    {
+        ret = Z_OK;
+    }
+
+    *in += avail - codec->z.avail_in;
+    *inLen -= avail - codec->z.avail_in;
+    *outLen = (size_t)((char *)codec->z.next_out - out);
+
+    if (Z_STREAM_END == ret)
+    {
+        if (codec->compress)
+        {
+            return 1;
+        }
+
+        codec->done = 1;
+    }
+    else if ((Z_OK != ret) && (Z_BUF_ERROR != ret))
+    {
+        errno = (Z_MEM_ERROR == ret) ? ENOMEM : EBADMSG;
+        return -1;
+    }
+
+    if (!codec->compress && finish && (0 == *inLen) && (0 == *outLen))
+    {
+        if (codec->done)
+        {
+            return 1;
+        }
+
+        errno = EBADMSG;        /* cut off */
+        return -1;
+    }
+
+    return 0;
+}
+#endif  /* ndef NO_ZLIB */
+
+#ifdef WITH_ZSTD
+/****************************************************************************
+*   Function   : RunZstd
+*   Description: This function is CodecRun for zstd.
+*   Parameters : See CodecRun.
+*   Effects    : See CodecRun.
+*   Returned   : See CodecRun.
+****************************************************************************/
+static int RunZstd(codec_t *codec, const char **in, size_t *inLen,
+    char *out, size_t outSize, size_t *outLen, int finish)
+{
+    ZSTD_inBuffer inBuf;
+    ZSTD_outBuffer outBuf;
+    size_t ret;
+
+    inBuf.src = *in;
+    inBuf.size = *inLen;
+    inBuf.pos = 0;
+    outBuf.dst = out;
+    outBuf.size = outSize;
+    outBuf.pos = 0;
+
+    if (codec->compress)
+    {
+        ret = ZSTD_compressStream2(codec->cctx, &outBuf, &inBuf,
+            finish ? ZSTD_e_end : ZSTD_e_continue);
+    }
+    else
+    {
+        ret = ZSTD_decompressStream(codec->dctx, &outBuf, &inBuf);
+    }
+
+    *in += inBuf.pos;
+    *inLen -= inBuf.pos;
+    *outLen = outBuf.pos;
+
+    if (ZSTD_isError(ret))
+    {
+        errno = EBADMSG;
+        return -1;
+    }
+
+    if (codec->compress)
+    {
+        /* ZSTD_e_end returns the bytes left to flush */
+        return (finish && (0 == ret)) ? 1 : 0;
+    }
+
+    /* 0 means a frame was finished and flushed */
+    codec->done = (0 == ret);
+
+    if (finish && (0 == *inLen) && (0 == *outLen))
+    {
+        if (codec->done)
+        {
+            return 1;
+        }
+
+        errno = EBADMSG;        /* cut off */
+        return -1;
+    }
+
+    return 0;
+}
+#endif  /* def WITH_ZSTD */
@@ -0,0 +1,84 @@
+/***************************************************************************
+*                            Compressed Streams
+*
+*   File    : codec.h
+*   Purpose : Header for the gzip and zstd stream codecs used to trim
+*             compressed input and write compressed output
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef CODEC_H
+#define CODEC_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stddef.h>
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+/* stream formats (trim_opts_t codec) */
+#define CODEC_NONE      0       /* not compressed */
+#define CODEC_GZIP      1       /* gzip (zlib) */
+#define CODEC_ZSTD      2       /* Zstandard */
+
+/* magic bytes needed to recognize every format */
+#define CODEC_MAGIC     4
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+/* a compressor or decompressor; the fields are private */
+typedef struct codec_t codec_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* returns the format starting with the magic bytes in buf, or CODEC_NONE */
+int CodecFromMagic(const char *buf, size_t len);
+
+/* returns the format named by a file name's extension (.gz or .zst), or
+ * CODEC_NONE */
+int CodecFromName(const char *name);
+
+/* returns non-zero if support for format was built in */
+int CodecSupported(int format);
+
+/* returns a new compressor (compress != 0) or decompressor for format, or
+ * NULL with errno set */
+codec_t *CodecNew(int format, int compress);
+
+/* compresses or decompresses from *in into out, advancing *in and *inLen
+ * past what was used.  finish marks the end of the input.  Returns 1 once
+ * the stream is complete, 0 if there's more to do, or -1 with errno set. */
+int CodecRun(codec_t *codec, const char **in, size_t *inLen, char *out,
+    size_t outSize, size_t *outLen, int finish);
+
+/* frees a codec made by CodecNew */
+void CodecFree(codec_t *codec);
+
+#endif  /* ndef CODEC_H */
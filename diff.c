@@ -0,0 +1,595 @@
+/***************************************************************************
+*                                 Diff Mode
+*
+*   File    : diff.c
+*   Purpose : Read a unified diff and check or trim only the lines it adds,
+*             so untouched lines of legacy files are never reformatted
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "diff.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define DIFF_READ_SIZE      (64 * 1024)     /* diff read size */
+#define RANGES_START        8               /* initial ranges per file */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+/* list of files being built from a diff */
+typedef struct diff_list_t
+{
+    diff_file_t *files;         /* files found so far */
+    size_t count;               /* number of files */
+    size_t size;                /* capacity of files */
+} diff_list_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static int ParseDiff(char *diff, size_t len, diff_list_t *list);
+static int AddFile(diff_list_t *list, const char *name, size_t len,
+    int git);
+static int AddLine(diff_file_t *file, uint64_t line);
+static int ParseHunk(const char *line, uint64_t *oldLeft, uint64_t *newLine,
+    uint64_t *newLeft);
+static size_t Unquote(char *name, size_t len);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : DiffRead
+*   Description: This function reads a unified diff, such as the output of
+*                git diff or diff -u, and lists each file it changes along
+*                with the line numbers, after the change, of the lines it
+*                adds.  A modified line is a removed line followed by an
+*                added one, so it's listed too.  The counts in each hunk
+*                header decide where the hunk ends, so removed lines that
+*                look like headers aren't mistaken for them.  Files that
+*                are deleted are left out.
+*   Parameters : fd - descriptor the diff is read from
+*                files - set to a malloc'd list of changed files
+*                count - set to the number of files in the list
+*   Effects    : Reads fd to end of file.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+*
+*   NOTE: The caller is responsible for freeing the list with DiffFree.
+****************************************************************************/
+int DiffRead(int fd, diff_file_t **files, size_t *count)
+{
+    diff_list_t list;
+    char *diff, *tmp;
+    size_t used, size;
+    ssize_t got;
+    int status;
+
+    diff = NULL;
+    used = 0;
+    size = 0;
+
+    for (;;)
+    {
+        /* always leave room for a terminating NUL */
+        if (size - used < DIFF_READ_SIZE + 1)
+        {
+            size += DIFF_READ_SIZE + 1;
+            tmp = (char *)realloc(diff, size);
+
+            if (NULL == tmp)
+            {
+                free(diff);
+                errno = ENOMEM;
+                return -1;
+            }
+
+            diff = tmp;
+        }
+
+        got = read(fd, diff + used, DIFF_READ_SIZE);
+
+        if (got < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            free(diff);
+            return -1;
+        }
+
+        if (0 == got)
+        {
+            break;
+        }
+
+        used += (size_t)got;
+    }
+
+    diff[used] = '\0';
+    list.files = NULL;
+    list.count = 0;
+    list.size = 0;
+    status = ParseDiff(diff, used, &list);
+    free(diff);
+
+    if (0 != status)
+    {
+        DiffFree(list.files, list.count);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    *files = list.files;
+    *count = list.count;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : DiffFree
+*   Description: This function frees a list made by DiffRead.
+*   Parameters : files - list of files, may be NULL
+*                count - number of files in the list
+*   Effects    : Frees the list and everything in it.
+*   Returned   : None
+****************************************************************************/
+void DiffFree(diff_file_t *files, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        free(files[i].path);
+        free(files[i].ranges);
+    }
+
+    free(files);
+}
+
+/****************************************************************************
+*   Function   : TrimDiff
+*   Description: This function applies a check or in place trim to only
+*                the added lines of each file in a diff.  Files the diff
+*                adds nothing to aren't opened.  A quiet check stops at
+*                the first file that would change.  A file that can't be
+*                checked or trimmed is reported on stderr and the rest are
+*                still done.
+*   Parameters : files - list made by DiffRead
+*                count - number of files in the list
+*                fdOut - descriptor a check report is written to
+*                opts - trimming options
+*                batchOpts - check, list, in place, and sync options
+*   Effects    : Files are trimmed in place, or a report is written to
+*                fdOut.
+*   Returned   : 0 if every file was trimmed or checked, 1 if a checked
+*                file would change, otherwise -1.
+****************************************************************************/
+int TrimDiff(const diff_file_t *files, size_t count, int fdOut,
+    const trim_opts_t *opts, const batch_opts_t *batchOpts)
+{
+    char *report;
+    size_t i, reportLen;
+    int status, changed, fileChanged, result, wrote;
+
+    status = 0;
+    changed = 0;
+    wrote = 1;
+
+    for (i = 0; i < count; i++)
+    {
+        if (0 == files[i].count)
+        {
+            continue;
+        }
+
+        if (batchOpts->inPlace)
+        {
+            result = TrimFileLinesInPlace(files[i].path, files[i].ranges,
+                files[i].count, opts, batchOpts->sync, &fileChanged);
+        }
+        else
+        {
+            result = CheckFileLines(files[i].path, files[i].ranges,
+                files[i].count, opts, batchOpts->list, &report, &reportLen,
+                &fileChanged);
+
+            if ((0 == result) && wrote && (0 != reportLen) &&
+                (0 != WriteAll(fdOut, report, reportLen)))
+            {
+                /* there's no point in writing anything else */
+                perror("Writing output");
+                wrote = 0;
+                status = -1;
+            }
+
+            if (0 == result)
+            {
+                free(report);
+                changed |= fileChanged;
+            }
+        }
+
+        if (0 != result)
+        {
+            fprintf(stderr, "%s: %s\n", files[i].path, strerror(errno));
+            status = -1;
+        }
+
+        if (changed && batchOpts->check && !batchOpts->list)
+        {
+            /* the answer is known */
+            break;
+        }
+    }
+
+    if ((0 == status) && changed)
+    {
+        status = 1;
+    }
+
+    return status;
+}
+
+/****************************************************************************
+*   Function   : ParseDiff
+*   Description: This function goes through a diff a line at a time.
+*                Outside of a hunk, "diff --git" starts a new file from
+*                git (whose names start with "b/"), "+++" names the file
+*                after the change, and "@@" starts a hunk.  Inside a hunk,
+*                context and added lines advance the new line number, and
+*                added lines are recorded.
+*   Parameters : diff - the whole diff, NUL terminated.  Names are
+*                       unquoted in place.
+*                len - length of diff
+*                list - empty list of files to fill in
+*   Effects    : Adds files to list.
+*   Returned   : 0 for success, -1 if memory ran out.
+****************************************************************************/
+static int ParseDiff(char *diff, size_t len, diff_list_t *list)
+{
+    char *line, *end, *name;
+    diff_file_t *file;
+    uint64_t oldLeft, newLeft, newLine;
+    size_t lineLen, nameLen;
+    int git;
+
+    file = NULL;
+    git = 0;
+    oldLeft = 0;
+    newLeft = 0;
+    newLine = 0;
+
+    for (line = diff; line < diff + len; line = end + 1)
+    {
+        end = (char *)memchr(line, '\n', (size_t)(diff + len - line));
+
+        if (NULL == end)
+        {
+            end = diff + len;
+        }
+
+        lineLen = (size_t)(end - line);
+
+        if ((0 != oldLeft) || (0 != newLeft))
+        {
+            /* some tools drop the space that starts an empty context line */
+            switch ((0 == lineLen) ? ' ' : line[0])
+            {
+                case ' ':
+                    oldLeft -= (0 != oldLeft);
+                    newLeft -= (0 != newLeft);
+                    newLine++;
+                    continue;
+
+                case '+':
+                    if ((NULL != file) && (0 != AddLine(file, newLine)))
+                    {
+                        return -1;
+                    }
+
+                    newLeft -= (0 != newLeft);
+                    newLine++;
+                    continue;
+
+                case '-':
+                    oldLeft -= (0 != oldLeft);
+                    continue;
+
+                case '\\':
+                    /* "\ No newline at end of file" */
+                    continue;
+
+                default:
+                    /* the hunk was shorter than its header said */
+                    oldLeft = 0;
+                    newLeft = 0;
+                    break;
+            }
+        }
+
+        if ((lineLen > 0) && ('\r' == line[lineLen - 1]))
+        {
+            lineLen--;
+        }
+
+        if (0 == strncmp(line, "diff --git ", 11))
+        {
+            git = 1;
+            file = NULL;
+        }
+        else if (0 == strncmp(line, "+++ ", 4))
+        {
+            name = line + 4;
+            nameLen = lineLen - 4;
+
+            if ('"' == name[0])
+            {
+                nameLen = Unquote(name, nameLen);
+            }
+            else if (NULL != memchr(name, '\t', nameLen))
+            {
+                /* diff -u puts a time stamp after a tab */
+                nameLen = (size_t)((char *)memchr(name, '\t', nameLen) -
+                    name);
+            }
+
+            file = NULL;
+
+            if ((nameLen != 9) || (0 != strncmp(name, "/dev/null", 9)))
+            {
+                if (0 != AddFile(list, name, nameLen, git))
+                {
+                    return -1;
+                }
+
+                file = &list->files[list->count - 1];
+            }
+        }
+        else if ((0 == strncmp(line, "@@ -", 4)) && (NULL != file))
+        {
+            if (0 != ParseHunk(line + 4, &oldLeft, &newLine, &newLeft))
+            {
+                oldLeft = 0;
+                newLeft = 0;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : AddFile
+*   Description: This function adds a file to a list of files changed by
+*                a diff.
+*   Parameters : list - list to add to
+*                name - name of the file from a "+++" line
+*                len - length of name
+*                git - non-zero if the name came from git and starts with
+*                      the "b/" prefix
+*   Effects    : Adds a file with no ranges to the end of the list.
+*   Returned   : 0 for success, -1 if memory ran out.
+****************************************************************************/
+static int AddFile(diff_list_t *list, const char *name, size_t len, int git)
+{
+    diff_file_t *files, *file;
+
+    if (git && (len > 2) && (0 == strncmp(name, "b/", 2)))
+    {
+        name += 2;
+        len -= 2;
+    }
+
+    if (list->count == list->size)
+    {
+        files = (diff_file_t *)realloc(list->files,
+            (list->size * 2 + 1) * sizeof(diff_file_t));
+
+        if (NULL == files)
+        {
+            return -1;
+        }
+
+        list->files = files;
+        list->size = list->size * 2 + 1;
+    }
+
+    file = &list->files[list->count];
+    file->path = (char *)malloc(len + 1);
+
+    if (NULL == file->path)
+    {
+        return -1;
+    }
+
+    memcpy(file->path, name, len);
+    file->path[len] = '\0';
+    file->ranges = NULL;
+    file->count = 0;
+    file->size = 0;
+    list->count++;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : AddLine
+*   Description: This function records an added line, extending the last
+*                range if the line follows it.
+*   Parameters : file - file the line was added to
+*                line - number of the line after the change
+*   Effects    : Adds the line to file's ranges.
+*   Returned   : 0 for success, -1 if memory ran out.
+****************************************************************************/
+static int AddLine(diff_file_t *file, uint64_t line)
+{
+    line_range_t *ranges;
+
+    if ((0 != file->count) && (file->ranges[file->count - 1].last + 1 ==
+        line))
+    {
+        file->ranges[file->count - 1].last = line;
+        return 0;
+    }
+
+    if (file->count == file->size)
+    {
+        ranges = (line_range_t *)realloc(file->ranges,
+            (file->size * 2 + RANGES_START) * sizeof(line_range_t));
+
+        if (NULL == ranges)
+        {
+            return -1;
+        }
+
+        file->ranges = ranges;
+        file->size = file->size * 2 + RANGES_START;
+    }
+
+    file->ranges[file->count].first = line;
+    file->ranges[file->count].last = line;
+    file->count++;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : ParseHunk
+*   Description: This function parses the rest of a hunk header of the
+*                form "@@ -old[,count] +new[,count] @@".  A missing count
+*                is 1.
+*   Parameters : line - the header after "@@ -"
+*                oldLeft - set to the number of old lines in the hunk
+*                newLine - set to the number of the first new line
+*                newLeft - set to the number of new lines in the hunk
+*   Effects    : None
+*   Returned   : 0 for success, -1 if the header is malformed.
+****************************************************************************/
+static int ParseHunk(const char *line, uint64_t *oldLeft, uint64_t *newLine,
+    uint64_t *newLeft)
+{
+    char *end;
+
+    (void)strtoul(line, &end, 10);
+    *oldLeft = (',' == *end) ? strtoul(end + 1, &end, 10) : 1;
+
+    if ((' ' != end[0]) || ('+' != end[1]))
+    {
+        return -1;
+    }
+
+    *newLine = strtoul(end + 2, &end, 10);
+    *newLeft = (',' == *end) ? strtoul(end + 1, &end, 10) : 1;
+
+    if (' ' != *end)
+    {
+        return -1;
+    }
+
+    if (0 == *newLine)
+    {
+        /* an empty new side is numbered from 0 */
+        *newLine = 1;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : Unquote
+*   Description: This function removes the C style quoting git puts on
+*                names with unusual characters, such as "b/tab\there" and
+*                octal escapes for bytes that aren't ASCII.
+*   Parameters : name - quoted name starting with '"'.  It's unquoted in
+*                       place.
+*                len - length of name
+*   Effects    : Overwrites name with the unquoted name.
+*   Returned   : Length of the unquoted name.
+****************************************************************************/
+static size_t Unquote(char *name, size_t len)
+{
+    size_t in, out;
+    int digits, value;
+
+    out = 0;
+
+    for (in = 1; (in < len) && ('"' != name[in]); in++)
+    {
+        if (('\\' != name[in]) || (in + 1 >= len))
+        {
+            name[out++] = name[in];
+            continue;
+        }
+
+        in++;
+
+        switch (name[in])
+        {
+            case 'a': name[out++] = '\a'; break;
+            case 'b': name[out++] = '\b'; break;
+            case 'f': name[out++] = '\f'; break;
+            case 'n': name[out++] = '\n'; break;
+            case 'r': name[out++] = '\r'; break;
+            case 't': name[out++] = '\t'; break;
+            case 'v': name[out++] = '\v'; break;
+
+            default:
+                if ((name[in] >= '0') && (name[in] <= '7'))
+                {
+                    value = 0;
+
+                    for (digits = 0; (digits < 3) && (in < len) &&
+                        (name[in] >= '0') && (name[in] <= '7'); digits++)
+                    {
+                        value = value * 8 + (name[in++] - '0');
+                    }
+
+                    in--;
+                    name[out++] = (char)value;
+                }
+                else
+                {
+                    /* \\ and \" */
+                    name[out++] = name[in];
+                }
+                break;
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+*                                 Diff Mode
+*
+*   File    : diff.h
+*   Purpose : Header for functions that trim only the lines a unified diff
+*             adds
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef DIFF_H
+#define DIFF_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stddef.h>
+#include "batch.h"
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+/* a file changed by a diff, and the lines the diff adds to it */
+typedef struct diff_file_t
+{
+    char *path;                 /* name of the file after the change */
+    line_range_t *ranges;       /* added lines in increasing order */
+    size_t count;               /* number of ranges */
+    size_t size;                /* capacity of ranges */
+} diff_file_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* reads a unified diff from fd, listing the lines it adds to each file */
+int DiffRead(int fd, diff_file_t **files, size_t *count);
+
+/* frees the list made by DiffRead */
+void DiffFree(diff_file_t *files, size_t count);
+
+/* checks or trims in place only the added lines of each file */
+int TrimDiff(const diff_file_t *files, size_t count, int fdOut,
+    const trim_opts_t *opts, const batch_opts_t *batchOpts);
+
+#endif  /* ndef DIFF_H */
@@ -36,6 +36,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 
 /***************************************************************************
 *                            TYPE DEFINITIONS
@@ -44,6 +45,10 @@
 /***************************************************************************
 *                                CONSTANTS
 ***************************************************************************/
+/* entries of the table built from an option list */
+#define OL_NOT_OPT  0       /* character isn't an option */
+#define OL_FLAG     1       /* option without an argument */
+#define OL_ARG      2       /* option followed by an argument */
 
 /***************************************************************************
 *                            GLOBAL VARIABLES
@@ -57,6 +62,11 @@ static option_t *MakeOpt(
 
 static size_t MatchOpt(const char argument, const char *const options);
 
+static void MakeTable(unsigned char table[256], const char *const options);
+
+static int ParseArgs(const int argc, char *const argv[],
+    const unsigned char table[256], option_t *list);
+
 /***************************************************************************
 *                                FUNCTIONS
 ***************************************************************************/
@@ -253,6 +263,206 @@ static size_t MatchOpt(const char argument, const char *const options)
     return optIndex;
 }
 
+/****************************************************************************
+*   Function   : GetOptArena
+*   Description: This function finds the same options as GetOptList, but
+*                puts the whole list in one block, so it takes one
+*                allocation and is freed with one call to FreeOptArena.
+*                The option list is turned into a table indexed by
+*                character, and argv is parsed once to count the options
+*                and once to fill in the list.
+*   Parameters : argc - the number of command line arguments (including the
+*                       name of the executable)
+*                argv - command line arguments
+*                options - getopt style option list.  A NULL terminated
+*                          string of single character options.  Follow an
+*                          option with a colon to indicate that it requires
+*                          an argument.
+*                list - set to the head of the list, or NULL if no options
+*                       are found
+*   Effects    : Allocates a block for the list of options and their
+*                arguments.
+*   Returned   : 0 for success, otherwise -1 with errno set if the list
+*                can't be allocated.  *list is NULL when -1 is returned.
+*
+*   NOTE: The caller is responsible for freeing up the option list with
+*         FreeOptArena when it is no longer needed.  Its nodes can't be
+*         freed one at a time, and it mustn't be passed to FreeOptList.
+*         Arguments point into argv; they aren't copied.
+****************************************************************************/
+int GetOptArena(const int argc, char *const argv[],
+    const char *const options, option_t **list)
+{
+    unsigned char table[256];
+    int count;
+
+    *list = NULL;
+    MakeTable(table, options);
+    count = ParseArgs(argc, argv, table, NULL);
+
+    if (0 == count)
+    {
+        return 0;
+    }
+
+    *list = malloc(count * sizeof(option_t));
+
+    if (NULL == *list)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    ParseArgs(argc, argv, table, *list);
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : MakeTable
+*   Description: This function builds a table of every character's meaning
+*                in an option list, so each character of argv is matched
+*                with one lookup instead of a search of the list.
+*   Parameters : table - table to be filled in
+*                options - getopt style option list.  A NULL terminated
+*                          string of single character options.  Follow an
+*                          option with a colon to indicate that it requires
+*                          an argument.
+*   Effects    : table[c] is set to OL_FLAG or OL_ARG for each option c,
+*                and OL_NOT_OPT for every other character.  A character
+*                listed twice means what it did the first time.
+*   Returned   : None
+****************************************************************************/
+static void MakeTable(unsigned char table[256], const char *const options)
+{
+    const char *p;
+    unsigned char c;
+
+    memset(table, OL_NOT_OPT, 256);
+    p = options;
+
+    while ('\0' != *p)
+    {
+        c = (unsigned char)*p;
+        p++;
+
+        if (OL_NOT_OPT == table[c])
+        {
+            table[c] = (':' == *p) ? OL_ARG : OL_FLAG;
+        }
+
+        /* skip the colon(s) following an option */
+        while (':' == *p)
+        {
+            p++;
+        }
+    }
+
+    return;
+}
+
+/****************************************************************************
+*   Function   : ParseArgs
+*   Description: This function finds the options and arguments in argv.
+*                It is called once with no list to count the options, then
+*                again to fill in a list with room for them all.
+*   Parameters : argc - the number of command line arguments (including the
+*                       name of the executable)
+*                argv - command line arguments
+*                table - table built from the option list by MakeTable
+*                list - array with an element for each option, or NULL to
+*                       only count the options
+*   Effects    : If list isn't NULL, its elements are filled in and linked
+*                in order.
+*   Returned   : Number of options found.
+****************************************************************************/
+static int ParseArgs(const int argc, char *const argv[],
+    const unsigned char table[256], option_t *list)
+{
+    int nextArg;
+    int count;
+    const char *arg;
+    size_t argIndex;
+    unsigned char kind;
+
+    count = 0;
+
+    /* loop through all of the command line arguments */
+    for (nextArg = 1; nextArg < argc; nextArg++)
+    {
+        arg = argv[nextArg];
+
+        if ('-' != arg[0])
+        {
+            continue;
+        }
+
+        for (argIndex = 1; '\0' != arg[argIndex]; argIndex++)
+        {
+            kind = table[(unsigned char)arg[argIndex]];
+
+            if (OL_NOT_OPT == kind)
+            {
+                continue;
+            }
+
+            /* we found a matching option */
+            if (NULL != list)
+            {
+                if (0 != count)
+                {
+                    list[count - 1].next = &list[count];
+                }
+
+                list[count].option = arg[argIndex];
+                list[count].argument = NULL;
+                list[count].argIndex = OL_NOINDEX;
+                list[count].next = NULL;
+            }
+
+            count++;
+
+            if (OL_ARG == kind)
+            {
+                /* the option found should have a text arguement */
+                argIndex++;
+
+                if ('\0' == arg[argIndex])
+                {
+                    /* there must be space between the argument option */
+                    nextArg++;
+                    argIndex = 0;
+                }
+
+                if ((NULL != list) && (nextArg < argc))
+                {
+                    list[count - 1].argument = &(argv[nextArg][argIndex]);
+                    list[count - 1].argIndex = nextArg;
+                }
+
+                break;  /* done with argv[nextArg] */
+            }
+        }
+    }
+
+    return count;
+}
+
+/****************************************************************************
+*   Function   : FreeOptArena
+*   Description: This function will free an option_t type linked list
+*                made by GetOptArena.  The list is a single block, so this
+*                is one call to free.
+*   Parameters : list - head of the list to be freed, as set by
+*                       GetOptArena
+*   Effects    : All elements of the list pointed to by list will be freed.
+*   Returned   : None
+****************************************************************************/
+void FreeOptArena(option_t *list)
+{
+    free(list);
+    return;
+}
+
 /****************************************************************************
 *   Function   : FindFileName
 *   Description: This is function accepts a pointer to the name of a file
@@ -71,6 +71,14 @@ option_t *GetOptList(const int argc, char *const argv[],
 /* frees the linked list of option_t returned by GetOptList */
 void FreeOptList(option_t *list);
 
+/* makes the same list as GetOptList in one block.  returns 0, or -1 with
+ * errno set if it can't be allocated */
+int GetOptArena(const int argc, char *const argv[],
+    const char *const options, option_t **list);
+
+/* frees the list made by GetOptArena all at once */
+void FreeOptArena(option_t *list);
+
 /* return a pointer to file name in a full path.  useful for argv[0] */
 char *FindFileName(const char *const fullPath);
 
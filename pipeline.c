@@ -0,0 +1,887 @@
+/***************************************************************************
+*                   Tab Remover and Trailing Space Trimmer
+*
+*   File    : pipeline.c
+*   Purpose : Trim a stream with reading, trimming, and writing on
+*             separate threads joined by lock-free rings of buffers
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "pipeline.h"
+#include "trimfile.h"
+#include "codec.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define PIPE_BUFS       4               /* buffers in each direction */
+#define PIPE_BUF_SIZE   (256 * 1024)    /* size of each buffer */
+#define RING_SIZE       8               /* power of 2 > PIPE_BUFS */
+#define SPIN_COUNT      1024            /* polls of an empty ring */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef struct pipe_buf_t
+{
+    char *data;                 /* contents */
+    size_t len;                 /* number of bytes in data */
+    int eof;                    /* marks the end of the stream */
+} pipe_buf_t;
+
+/* lock-free single producer, single consumer ring of buffers.  Every
+ * buffer a ring can hold fits, so it is never full.  A consumer that
+ * finds it empty for long sleeps on cond until the producer wakes it. */
+typedef struct ring_t
+{
+    pipe_buf_t *slots[RING_SIZE];
+    unsigned int head;          /* next slot popped; consumer owned */
+    unsigned int tail;          /* next slot pushed; producer owned */
+    int sleeping;               /* non-zero while the consumer may wait */
+    pthread_mutex_t lock;       /* only used to sleep and wake */
+    pthread_cond_t cond;
+} ring_t;
+
+typedef struct pipeline_t
+{
+    int fdIn;                   /* descriptor being trimmed */
+    int fdOut;                  /* descriptor output is written to */
+    const char *head;           /* start of the stream read by the caller */
+    size_t headLen;             /* number of bytes at head */
+    size_t sample;              /* bytes the first input buffer holds
+                                 * before it's trimmed, unless the stream
+                                 * ends first */
+    codec_t *encoder;           /* compresses output, or NULL */
+    char *packedIn;             /* compressed input being decoded */
+    char *packedOut;            /* compressed output being written */
+    ring_t inFull;              /* reader to trimmer: input to trim */
+    ring_t inFree;              /* trimmer to reader: emptied input */
+    ring_t outFull;             /* trimmer to writer: output to write */
+    ring_t outFree;             /* writer to trimmer: emptied output */
+    pipe_buf_t bufs[2 * PIPE_BUFS];
+    pipe_buf_t *out;            /* output buffer being filled */
+    int readErr;                /* errno of a failed read, or 0 */
+    int writeErr;               /* errno of a failed write, or 0 */
+    int failed;                 /* set when any stage fails */
+    uint64_t readNs;            /* reader's time reading and decoding */
+    uint64_t writeNs;           /* writer's time encoding and writing */
+} pipeline_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static void *Reader(void *arg);
+static pipe_buf_t *ReadPlain(pipeline_t *pipeline, pipe_buf_t *buf);
+static pipe_buf_t *ReadDecoded(pipeline_t *pipeline, pipe_buf_t *buf,
+    int format);
+static ssize_t ReadRetry(pipeline_t *pipeline, char *buf, size_t len);
+static ssize_t ReadFill(pipeline_t *pipeline, char *buf, size_t have,
+    size_t want);
+static void *Writer(void *arg);
+static int WriteEncoded(pipeline_t *pipeline, const char *data, size_t len,
+    int finish);
+static int PipeSink(void *context, const char *data, size_t len);
+static void PassOutput(pipeline_t *pipeline);
+
+static void RingInit(ring_t *ring);
+static void RingDestroy(ring_t *ring);
+static void RingPush(ring_t *ring, pipe_buf_t *buf);
+static pipe_buf_t *RingPop(ring_t *ring);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : TrimPipeline
+*   Description: This function trims a stream in three stages so that a
+*                slow producer or consumer doesn't stall the trimming.  A
+*                reader thread reads into free input buffers, the calling
+*                thread trims each one into output buffers, and a writer
+*                thread writes them.  The stages pass a fixed set of
+*                buffers around lock-free rings, so nothing is allocated
+*                once the pipeline starts.  The output of each input
+*                buffer is passed on as soon as it's trimmed, so a slow
+*                stream is written as it arrives.  If a stage fails, the
+*                others drain their rings without doing any more work.
+*                Compressed input is decompressed by the reader, and the
+*                writer compresses the output if opts asks for it.
+*   Parameters : fdIn - descriptor to be trimmed (usually a pipe)
+*                fdOut - descriptor the trimmed stream is written to
+*                opts - trimming options
+*                head - bytes the caller already read from fdIn, or NULL
+*                headLen - number of bytes at head; at most 256K
+*   Effects    : Writes version of input with tabs expanded and trailing
+*                spaces removed.
+*   Returned   : 0 for success, 1 if the pipeline couldn't be started and
+*                it can be trimmed without it (nothing was read, and the
+*                output isn't compressed), otherwise -1 with errno set.
+****************************************************************************/
+int TrimPipeline(int fdIn, int fdOut, const trim_opts_t *opts,
+    const char *head, size_t headLen)
+{
+    pipeline_t pipeline;
+    pthread_t reader, writer;
+    trimmer_t trimmer;
+    pipe_buf_t *in;
+    char *data;
+    uint64_t start, trimNs;
+    int fallback, trimErr, i;
+
+    /* only a plain stream that hasn't been started can be trimmed without
+     * the pipeline */
+    fallback = (0 == headLen) && (CODEC_NONE == opts->codec) ? 1 : -1;
+    pipeline.encoder = NULL;
+
+    if (CODEC_NONE != opts->codec)
+    {
+        pipeline.encoder = CodecNew((int)opts->codec, 1);
+
+        if (NULL == pipeline.encoder)
+        {
+            return -1;
+        }
+    }
+
+    data = (char *)malloc((2 * PIPE_BUFS + 2) * PIPE_BUF_SIZE);
+
+    if (NULL == data)
+    {
+        CodecFree(pipeline.encoder);
+        errno = ENOMEM;
+        return fallback;
+    }
+
+    pipeline.fdIn = fdIn;
+    pipeline.fdOut = fdOut;
+    pipeline.head = head;
+    pipeline.headLen = headLen;
+    pipeline.sample = (EOL_AUTO == opts->eol) ? TRIMMER_EOL_SAMPLE : 0;
+    pipeline.packedIn = data + (size_t)2 * PIPE_BUFS * PIPE_BUF_SIZE;
+    pipeline.packedOut = pipeline.packedIn + PIPE_BUF_SIZE;
+    pipeline.readErr = 0;
+    pipeline.writeErr = 0;
+    pipeline.failed = 0;
+    pipeline.readNs = 0;
+    pipeline.writeNs = 0;
+    trimNs = 0;
+    RingInit(&pipeline.inFull);
+    RingInit(&pipeline.inFree);
+    RingInit(&pipeline.outFull);
+    RingInit(&pipeline.outFree);
+
+    for (i = 0; i < 2 * PIPE_BUFS; i++)
+    {
+        pipeline.bufs[i].data = data + (size_t)i * PIPE_BUF_SIZE;
+        pipeline.bufs[i].len = 0;
+        pipeline.bufs[i].eof = 0;
+        RingPush((i < PIPE_BUFS) ? &pipeline.inFree : &pipeline.outFree,
+            &pipeline.bufs[i]);
+    }
+
+    /* start the writer first so nothing has been read if either fails */
+    if (0 != pthread_create(&writer, NULL, Writer, &pipeline))
+    {
+        CodecFree(pipeline.encoder);
+        free(data);
+        errno = EAGAIN;
+        return fallback;
+    }
+
+    pipeline.out = RingPop(&pipeline.outFree);
+
+    if (0 != pthread_create(&reader, NULL, Reader, &pipeline))
+    {
+        pipeline.out->eof = 1;
+        RingPush(&pipeline.outFull, pipeline.out);
+        pthread_join(writer, NULL);
+        CodecFree(pipeline.encoder);
+        free(data);
+        errno = EAGAIN;
+        return fallback;
+    }
+
+    TrimmerInit(&trimmer, opts);
+    trimErr = 0;
+
+    for (;;)
+    {
+        in = RingPop(&pipeline.inFull);
+
+        if (in->eof)
+        {
+            break;
+        }
+
+        /* the sink never fails; write errors are the writer's to report.
+         * After a failure the input is still taken so the reader can end. */
+        if (0 == trimErr)
+        {
+            start = TrimClock();
+
+            if (0 != TrimmerFeed(&trimmer, in->data, in->len, PipeSink,
+                &pipeline))
+            {
+                trimErr = errno;
+                __atomic_store_n(&pipeline.failed, 1, __ATOMIC_SEQ_CST);
+            }
+
+            trimNs += TrimClock() - start;
+        }
+
+        RingPush(&pipeline.inFree, in);
+        PassOutput(&pipeline);
+    }
+
+    (void)TrimmerFinish(&trimmer, PipeSink, &pipeline);
+    PassOutput(&pipeline);
+    pthread_join(reader, NULL);
+
+    /* tell the writer it's done */
+    pipeline.out->eof = 1;
+    RingPush(&pipeline.outFull, pipeline.out);
+    pthread_join(writer, NULL);
+
+    if (NULL != opts->stats)
+    {
+        /* the stages overlap, so these may add up to more than the time
+         * the stream took */
+        TrimmerAddStats(&trimmer, opts->stats);
+        opts->stats->readNs += pipeline.readNs;
+        opts->stats->trimNs += trimNs;
+        opts->stats->writeNs += pipeline.writeNs;
+    }
+
+    RingDestroy(&pipeline.inFull);
+    RingDestroy(&pipeline.inFree);
+    RingDestroy(&pipeline.outFull);
+    RingDestroy(&pipeline.outFree);
+    CodecFree(pipeline.encoder);
+    free(data);
+
+    if (0 != trimErr)
+    {
+        errno = trimErr;
+        return -1;
+    }
+
+    if (0 != pipeline.readErr)
+    {
+        errno = pipeline.readErr;
+        return -1;
+    }
+
+    if (0 != pipeline.writeErr)
+    {
+        errno = pipeline.writeErr;
+        return -1;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : Reader
+*   Description: This function is the reader thread.  It fills free input
+*                buffers from the input descriptor and passes them to the
+*                trimmer until end of file, an error, or another stage
+*                fails.  If the first block starts with the magic bytes of
+*                a compressed format, the stream is decompressed into the
+*                buffers instead; the block is read until it's long enough
+*                to hold them, however the input is split.  The last
+*                buffer it passes is marked eof.
+*   Parameters : arg - pointer to the pipeline
+*   Effects    : Reads the input descriptor.
+*   Returned   : NULL
+****************************************************************************/
+static void *Reader(void *arg)
+{
+    pipeline_t *pipeline;
+    pipe_buf_t *buf;
+    ssize_t got;
+    int format;
+
+    pipeline = (pipeline_t *)arg;
+    buf = RingPop(&pipeline->inFree);
+
+    if (0 != pipeline->headLen)
+    {
+        memcpy(buf->data, pipeline->head, pipeline->headLen);
+        got = (ssize_t)pipeline->headLen;
+    }
+    else
+    {
+        /* a format is found from whole magic bytes */
+        got = ReadFill(pipeline, buf->data, 0, CODEC_MAGIC);
+    }
+
+    if (got < 0)
+    {
+        pipeline->readErr = errno;
+        __atomic_store_n(&pipeline->failed, 1, __ATOMIC_SEQ_CST);
+    }
+    else
+    {
+        buf->len = (size_t)got;
+        format = CodecFromMagic(buf->data, buf->len);
+
+        if (CODEC_NONE == format)
+        {
+            /* -e auto picks endings from a whole sample */
+            got = ReadFill(pipeline, buf->data, buf->len, pipeline->sample);
+
+            if (got < 0)
+            {
+                pipeline->readErr = errno;
+                __atomic_store_n(&pipeline->failed, 1, __ATOMIC_SEQ_CST);
+                buf->len = 0;
+            }
+            else
+            {
+                buf->len = (size_t)got;
+            }
+
+            buf = ReadPlain(pipeline, buf);
+        }
+        else
+        {
+            buf = ReadDecoded(pipeline, buf, format);
+        }
+    }
+
+    buf->len = 0;
+    buf->eof = 1;
+    RingPush(&pipeline->inFull, buf);
+    return NULL;
+}
+
+/****************************************************************************
+*   Function   : ReadPlain
+*   Description: This function passes the input to the trimmer as it's
+*                read.
+*   Parameters : pipeline - pointer to the pipeline
+*                buf - input buffer holding the first block, which is empty
+*                      at end of file
+*   Effects    : Reads the input descriptor and passes full buffers to the
+*                trimmer.
+*   Returned   : A free input buffer to mark eof.
+****************************************************************************/
+static pipe_buf_t *ReadPlain(pipeline_t *pipeline, pipe_buf_t *buf)
+{
+    ssize_t got;
+
+    while (0 != buf->len)
+    {
+        buf->eof = 0;
+        RingPush(&pipeline->inFull, buf);
+        buf = RingPop(&pipeline->inFree);
+
+        if (__atomic_load_n(&pipeline->failed, __ATOMIC_SEQ_CST))
+        {
+            break;
+        }
+
+        got = ReadRetry(pipeline, buf->data, PIPE_BUF_SIZE);
+
+        if (got < 0)
+        {
+            pipeline->readErr = errno;
+            __atomic_store_n(&pipeline->failed, 1, __ATOMIC_SEQ_CST);
+            break;
+        }
+
+        buf->len = (size_t)got;
+    }
+
+    return buf;
+}
+
+/****************************************************************************
+*   Function   : ReadDecoded
+*   Description: This function decompresses the input into input buffers.
+*                Compressed blocks are read into a buffer of their own.
+*                Whatever has been decompressed is passed on before each
+*                read, so a slow stream is trimmed as it arrives, except
+*                that the first buffer isn't passed on until it holds the
+*                pipeline's sample.
+*   Parameters : pipeline - pointer to the pipeline
+*                buf - input buffer holding the first compressed block
+*                format - format of the compressed stream
+*   Effects    : Reads the input descriptor and passes decompressed
+*                buffers to the trimmer.  Corrupt or cut off input is a
+*                read error (EBADMSG).
+*   Returned   : A free input buffer to mark eof.
+****************************************************************************/
+static pipe_buf_t *ReadDecoded(pipeline_t *pipeline, pipe_buf_t *buf,
+    int format)
+{
+    codec_t *decoder;
+    const char *next;
+    size_t left, made;
+    ssize_t got;
+    uint64_t start;
+    int eof, status;
+
+    decoder = CodecNew(format, 0);
+
+    if (NULL == decoder)
+    {
+        pipeline->readErr = errno;
+        __atomic_store_n(&pipeline->failed, 1, __ATOMIC_SEQ_CST);
+        return buf;
+    }
+
+    memcpy(pipeline->packedIn, buf->data, buf->len);
+    next = pipeline->packedIn;
+    left = buf->len;
+    buf->len = 0;
+    eof = 0;
+
+    for (;;)
+    {
+        start = TrimClock();
+        status = CodecRun(decoder, &next, &left, buf->data + buf->len,
+            PIPE_BUF_SIZE - buf->len, &made, eof);
+        pipeline->readNs += TrimClock() - start;
+        buf->len += made;
+
+        if (status < 0)
+        {
+            pipeline->readErr = errno;
+            __atomic_store_n(&pipeline->failed, 1, __ATOMIC_SEQ_CST);
+            break;
+        }
+
+        if (1 == status)
+        {
+            break;
+        }
+
+        if ((PIPE_BUF_SIZE == buf->len) || ((0 == left) && !eof))
+        {
+            if ((0 != buf->len) && (buf->len >= pipeline->sample))
+            {
+                buf->eof = 0;
+                RingPush(&pipeline->inFull, buf);
+                buf = RingPop(&pipeline->inFree);
+                buf->len = 0;
+                pipeline->sample = 0;
+
+                if (__atomic_load_n(&pipeline->failed, __ATOMIC_SEQ_CST))
+                {
+                    break;
+                }
+            }
+
+            if ((0 == left) && !eof)
+            {
+                got = ReadRetry(pipeline, pipeline->packedIn, PIPE_BUF_SIZE);
+
+                if (got < 0)
+                {
+                    pipeline->readErr = errno;
+                    __atomic_store_n(&pipeline->failed, 1, __ATOMIC_SEQ_CST);
+                    break;
+                }
+
+                next = pipeline->packedIn;
+                left = (size_t)got;
+                eof = (0 == got);
+            }
+        }
+    }
+
+    if ((0 != buf->len) &&
+        !__atomic_load_n(&pipeline->failed, __ATOMIC_SEQ_CST))
+    {
+        buf->eof = 0;
+        RingPush(&pipeline->inFull, buf);
+        buf = RingPop(&pipeline->inFree);
+    }
+
+    CodecFree(decoder);
+    return buf;
+}
+
+/****************************************************************************
+*   Function   : ReadFill
+*   Description: This function reads more of the pipeline's input into a
+*                buffer until it holds at least want bytes.
+*   Parameters : pipeline - pointer to the pipeline
+*                buf - buffer of PIPE_BUF_SIZE bytes
+*                have - bytes already in buf
+*                want - bytes wanted, no more than PIPE_BUF_SIZE
+*   Effects    : Reads the input descriptor.
+*   Returned   : Number of bytes in buf, which is less than want only at
+*                end of file, or -1 with errno set.
+****************************************************************************/
+static ssize_t ReadFill(pipeline_t *pipeline, char *buf, size_t have,
+    size_t want)
+{
+    ssize_t got;
+
+    while (have < want)
+    {
+        got = ReadRetry(pipeline, buf + have, PIPE_BUF_SIZE - have);
+
+        if (got < 0)
+        {
+            return -1;
+        }
+
+        if (0 == got)
+        {
+            break;
+        }
+
+        have += (size_t)got;
+    }
+
+    return (ssize_t)have;
+}
+
+/****************************************************************************
+*   Function   : ReadRetry
+*   Description: This function is read(2) of the pipeline's input,
+*                retried if it's interrupted and timed.
+*   Parameters : pipeline - pointer to the pipeline
+*                buf - buffer to read into
+*                len - size of buf
+*   Effects    : Reads the input descriptor.
+*   Returned   : Number of bytes read, 0 at end of file, or -1 with errno
+*                set.
+****************************************************************************/
+static ssize_t ReadRetry(pipeline_t *pipeline, char *buf, size_t len)
+{
+    ssize_t got;
+    uint64_t start;
+
+    start = TrimClock();
+
+    do
+    {
+        got = read(pipeline->fdIn, buf, len);
+    } while ((got < 0) && (EINTR == errno));
+
+    pipeline->readNs += TrimClock() - start;
+    return got;
+}
+
+/****************************************************************************
+*   Function   : Writer
+*   Description: This function is the writer thread.  It writes each
+*                output buffer it's passed and returns it to the trimmer.
+*                Output is compressed first if the pipeline has an
+*                encoder.  After a failed write it keeps returning buffers
+*                without writing them, so the other stages can drain.
+*   Parameters : arg - pointer to the pipeline
+*   Effects    : Writes the output descriptor.
+*   Returned   : NULL
+****************************************************************************/
+static void *Writer(void *arg)
+{
+    pipeline_t *pipeline;
+    pipe_buf_t *buf;
+    uint64_t start;
+    int status;
+
+    pipeline = (pipeline_t *)arg;
+
+    for (;;)
+    {
+        buf = RingPop(&pipeline->outFull);
+
+        if (buf->eof)
+        {
+            break;
+        }
+
+        if (0 == pipeline->writeErr)
+        {
+            start = TrimClock();
+
+            if (NULL != pipeline->encoder)
+            {
+                status = WriteEncoded(pipeline, buf->data, buf->len, 0);
+            }
+            else
+            {
+                status = WriteAll(pipeline->fdOut, buf->data, buf->len);
+            }
+
+            pipeline->writeNs += TrimClock() - start;
+
+            if (0 != status)
+            {
+                pipeline->writeErr = errno;
+                __atomic_store_n(&pipeline->failed, 1, __ATOMIC_SEQ_CST);
+            }
+        }
+
+        buf->len = 0;
+        RingPush(&pipeline->outFree, buf);
+    }
+
+    /* end the compressed stream, unless the trimmed one is incomplete */
+    if ((NULL != pipeline->encoder) &&
+        !__atomic_load_n(&pipeline->failed, __ATOMIC_SEQ_CST))
+    {
+        start = TrimClock();
+
+        if (0 != WriteEncoded(pipeline, NULL, 0, 1))
+        {
+            pipeline->writeErr = errno;
+            __atomic_store_n(&pipeline->failed, 1, __ATOMIC_SEQ_CST);
+        }
+
+        pipeline->writeNs += TrimClock() - start;
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+*   Function   : WriteEncoded
+*   Description: This function compresses trimmed output and writes what
+*                the encoder produces.
+*   Parameters : pipeline - pointer to the pipeline
+*                data - trimmed bytes
+*                len - number of bytes in data
+*                finish - non-zero to end the compressed stream
+*   Effects    : Writes the output descriptor.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int WriteEncoded(pipeline_t *pipeline, const char *data, size_t len,
+    int finish)
+{
+    size_t made;
+    int status;
+
+    do
+    {
+        status = CodecRun(pipeline->encoder, &data, &len,
+            pipeline->packedOut, PIPE_BUF_SIZE, &made, finish);
+
+        if (status < 0)
+        {
+            return -1;
+        }
+
+        if ((0 != made) &&
+            (0 != WriteAll(pipeline->fdOut, pipeline->packedOut, made)))
+        {
+            return -1;
+        }
+    } while ((0 != len) || (finish && (0 == status)));
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : PipeSink
+*   Description: This function is the trimmer's sink.  It copies trimmed
+*                bytes into the current output buffer, passing each one to
+*                the writer as it fills.  Once a stage has failed, output
+*                is discarded.
+*   Parameters : context - pointer to the pipeline
+*                data - bytes to output
+*                len - number of bytes in data
+*   Effects    : Fills output buffers and passes them to the writer.
+*   Returned   : 0
+****************************************************************************/
+static int PipeSink(void *context, const char *data, size_t len)
+{
+    pipeline_t *pipeline;
+    pipe_buf_t *out;
+    size_t room;
+
+    pipeline = (pipeline_t *)context;
+
+    if (__atomic_load_n(&pipeline->failed, __ATOMIC_RELAXED))
+    {
+        return 0;
+    }
+
+    out = pipeline->out;
+
+    while (len > 0)
+    {
+        room = PIPE_BUF_SIZE - out->len;
+
+        if (room > len)
+        {
+            room = len;
+        }
+
+        memcpy(out->data + out->len, data, room);
+        out->len += room;
+        data += room;
+        len -= room;
+
+        if (PIPE_BUF_SIZE == out->len)
+        {
+            RingPush(&pipeline->outFull, out);
+            out = RingPop(&pipeline->outFree);
+            pipeline->out = out;
+        }
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : PassOutput
+*   Description: This function passes a partly filled output buffer to the
+*                writer, so trimmed output isn't held back waiting for
+*                more input.
+*   Parameters : pipeline - pointer to the pipeline
+*   Effects    : May pass the current output buffer to the writer and take
+*                a free one.
+*   Returned   : None
+****************************************************************************/
+static void PassOutput(pipeline_t *pipeline)
+{
+    if (0 != pipeline->out->len)
+    {
+        RingPush(&pipeline->outFull, pipeline->out);
+        pipeline->out = RingPop(&pipeline->outFree);
+    }
+}
+
+/****************************************************************************
+*   Function   : RingInit
+*   Description: This function initializes an empty ring.
+*   Parameters : ring - pointer to the ring
+*   Effects    : Initializes the ring's indices, lock, and condition.
+*   Returned   : None
+****************************************************************************/
+static void RingInit(ring_t *ring)
+{
+    ring->head = 0;
+    ring->tail = 0;
+    ring->sleeping = 0;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->cond, NULL);
+}
+
+/****************************************************************************
+*   Function   : RingDestroy
+*   Description: This function releases a ring's lock and condition.
+*   Parameters : ring - pointer to the ring
+*   Effects    : Destroys the ring's lock and condition.
+*   Returned   : None
+****************************************************************************/
+static void RingDestroy(ring_t *ring)
+{
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->cond);
+}
+
+/****************************************************************************
+*   Function   : RingPush
+*   Description: This function adds a buffer to a ring.  Only one thread
+*                may push to a ring.  The slot is published by a release
+*                store of tail; the lock is only taken when the consumer
+*                has gone to sleep.
+*   Parameters : ring - pointer to the ring
+*                buf - buffer to add
+*   Effects    : Adds buf to the ring and wakes a sleeping consumer.
+*   Returned   : None
+****************************************************************************/
+static void RingPush(ring_t *ring, pipe_buf_t *buf)
+{
+    unsigned int tail;
+
+    tail = ring->tail;
+    ring->slots[tail & (RING_SIZE - 1)] = buf;
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+    /* pairs with the fence in RingPop so one side sees the other */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&ring->sleeping, __ATOMIC_RELAXED))
+    {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_signal(&ring->cond);
+        pthread_mutex_unlock(&ring->lock);
+    }
+}
+
+/****************************************************************************
+*   Function   : RingPop
+*   Description: This function removes the oldest buffer from a ring,
+*                waiting for one if it's empty.  Only one thread may pop
+*                from a ring.  An empty ring is polled briefly before the
+*                consumer sleeps.
+*   Parameters : ring - pointer to the ring
+*   Effects    : Removes a buffer from the ring.
+*   Returned   : The buffer removed.
+****************************************************************************/
+static pipe_buf_t *RingPop(ring_t *ring)
+{
+    unsigned int head;
+    int spin;
+    pipe_buf_t *buf;
+
+    head = ring->head;
+
+    for (spin = 0; spin < SPIN_COUNT; spin++)
+    {
+        if (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) != head)
+        {
+            break;
+        }
+    }
+
+    if (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == head)
+    {
+        pthread_mutex_lock(&ring->lock);
+        __atomic_store_n(&ring->sleeping, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        while (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == head)
+        {
+            pthread_cond_wait(&ring->cond, &ring->lock);
+        }
+
+        __atomic_store_n(&ring->sleeping, 0, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&ring->lock);
+    }
+
+    buf = ring->slots[head & (RING_SIZE - 1)];
+    ring->head = head + 1;
+    return buf;
+}
@@ -0,0 +1,50 @@
+/***************************************************************************
+*                   Tab Remover and Trailing Space Trimmer
+*
+*   File    : pipeline.h
+*   Purpose : Header for the reader/trimmer/writer pipeline
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include "trimmer.h"
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* trims fdIn to fdOut with a reader thread, the calling thread trimming,
+ * and a writer thread, decompressing and compressing as needed.  head
+ * holds bytes already read from fdIn.  Returns 1 if the threads can't be
+ * started and the stream can still be trimmed without them. */
+int TrimPipeline(int fdIn, int fdOut, const trim_opts_t *opts,
+    const char *head, size_t headLen);
+
+#endif  /* ndef PIPELINE_H */
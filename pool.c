@@ -0,0 +1,522 @@
+/***************************************************************************
+*                         Work Stealing Thread Pool
+*
+*   File    : pool.c
+*   Purpose : Run tasks on a pool of threads.  Each thread has its own
+*             queue of tasks, and threads that run out of work steal
+*             from the other queues.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "pool.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define DEQUE_START 64          /* initial capacity of a task queue */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef struct pool_task_t
+{
+    pool_fn_t fn;               /* function to run */
+    void *arg;                  /* argument passed to fn */
+} pool_task_t;
+
+/* circular queue of tasks.  The owner works from the back, thieves take
+ * from the front. */
+typedef struct pool_deque_t
+{
+    pthread_mutex_t lock;       /* protects the rest of the structure */
+    pool_task_t *tasks;         /* circular buffer of tasks */
+    size_t capacity;            /* size of tasks (a power of 2) */
+    size_t front;               /* index of the oldest task */
+    size_t count;               /* number of tasks queued */
+} pool_deque_t;
+
+typedef struct pool_worker_t
+{
+    pool_t *pool;               /* pool the worker belongs to */
+    unsigned int index;         /* index of the worker's deque */
+    pthread_t thread;           /* the worker's thread */
+} pool_worker_t;
+
+struct pool_t
+{
+    unsigned int threads;       /* number of worker threads */
+    pool_worker_t *workers;     /* the worker threads */
+    pool_deque_t *deques;       /* one task queue per worker */
+    pthread_mutex_t lock;       /* held to sleep, wake, or wait */
+    pthread_cond_t work;        /* signaled when a task is queued */
+    pthread_cond_t done;        /* signaled when unfinished reaches 0 */
+    unsigned long queued;       /* tasks in all deques (atomic) */
+    unsigned long unfinished;   /* tasks submitted but not done (atomic) */
+    unsigned int sleeping;      /* workers waiting for work (atomic) */
+    unsigned int nextDeque;     /* deque for the next outside submit */
+    int shutdown;               /* non-zero when workers should exit */
+};
+
+/***************************************************************************
+*                            GLOBAL VARIABLES
+***************************************************************************/
+static pthread_key_t workerKey;     /* pool_worker_t of calling thread */
+static pthread_once_t workerKeyOnce = PTHREAD_ONCE_INIT;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static void MakeWorkerKey(void);
+static void *PoolWorker(void *arg);
+static int PushBack(pool_deque_t *deque, const pool_task_t *task);
+static int PopBack(pool_deque_t *deque, pool_task_t *task);
+static int PopFront(pool_deque_t *deque, pool_task_t *task);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : PoolCreate
+*   Description: This function creates a pool of worker threads, each with
+*                its own task queue.
+*   Parameters : threads - number of worker threads (at least 1)
+*   Effects    : Worker threads are started.
+*   Returned   : Pointer to the new pool, or NULL with errno set if it
+*                can't be created.
+****************************************************************************/
+pool_t *PoolCreate(unsigned int threads)
+{
+    pool_t *pool;
+    unsigned int i;
+    int err;
+
+    if (0 == threads)
+    {
+        threads = 1;
+    }
+
+    pthread_once(&workerKeyOnce, MakeWorkerKey);
+    pool = (pool_t *)calloc(1, sizeof(pool_t));
+
+    if (NULL == pool)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    pool->threads = threads;
+    pool->workers = (pool_worker_t *)calloc(threads, sizeof(pool_worker_t));
+    pool->deques = (pool_deque_t *)calloc(threads, sizeof(pool_deque_t));
+
+    if ((NULL == pool->workers) || (NULL == pool->deques))
+    {
+        free(pool->workers);
+        free(pool->deques);
+        free(pool);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    for (i = 0; i < threads; i++)
+    {
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+    }
+
+    for (i = 0; i < threads; i++)
+    {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        err = pthread_create(&pool->workers[i].thread, NULL, PoolWorker,
+            &pool->workers[i]);
+
+        if (0 != err)
+        {
+            /* run with the threads that did start */
+            pool->threads = i;
+            break;
+        }
+    }
+
+    if (0 == pool->threads)
+    {
+        for (i = 0; i < threads; i++)
+        {
+            pthread_mutex_destroy(&pool->deques[i].lock);
+        }
+
+        pthread_cond_destroy(&pool->done);
+        pthread_cond_destroy(&pool->work);
+        pthread_mutex_destroy(&pool->lock);
+        free(pool->deques);
+        free(pool->workers);
+        free(pool);
+        errno = err;
+        return NULL;
+    }
+
+    return pool;
+}
+
+/****************************************************************************
+*   Function   : PoolSubmit
+*   Description: This function queues a task to be run by the pool.  Tasks
+*                submitted by one of the pool's own workers are queued on
+*                that worker's deque, where it will run them newest first
+*                unless they are stolen.  Other tasks are spread over the
+*                deques round robin.
+*   Parameters : pool - pool to run the task
+*                fn - function to run
+*                arg - argument passed to fn
+*   Effects    : The task is queued and a sleeping worker is woken.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+int PoolSubmit(pool_t *pool, pool_fn_t fn, void *arg)
+{
+    pool_worker_t *self;
+    pool_task_t task;
+    unsigned int index;
+
+    task.fn = fn;
+    task.arg = arg;
+    self = (pool_worker_t *)pthread_getspecific(workerKey);
+
+    if ((NULL != self) && (self->pool == pool))
+    {
+        index = self->index;
+    }
+    else
+    {
+        index = __atomic_fetch_add(&pool->nextDeque, 1, __ATOMIC_RELAXED) %
+            pool->threads;
+    }
+
+    __atomic_add_fetch(&pool->unfinished, 1, __ATOMIC_SEQ_CST);
+
+    if (0 != PushBack(&pool->deques[index], &task))
+    {
+        __atomic_sub_fetch(&pool->unfinished, 1, __ATOMIC_SEQ_CST);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    __atomic_add_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+
+    if (0 != __atomic_load_n(&pool->sleeping, __ATOMIC_SEQ_CST))
+    {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_signal(&pool->work);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : PoolWait
+*   Description: This function blocks until all of the tasks submitted to
+*                a pool, including tasks submitted by tasks, have finished.
+*   Parameters : pool - pool to wait on
+*   Effects    : None
+*   Returned   : None
+****************************************************************************/
+void PoolWait(pool_t *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+
+    while (0 != __atomic_load_n(&pool->unfinished, __ATOMIC_SEQ_CST))
+    {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/****************************************************************************
+*   Function   : PoolDestroy
+*   Description: This function waits for all of a pool's tasks to finish,
+*                stops its threads, and frees it.
+*   Parameters : pool - pool to destroy
+*   Effects    : The pool's threads are joined and its memory is freed.
+*   Returned   : None
+****************************************************************************/
+void PoolDestroy(pool_t *pool)
+{
+    unsigned int i;
+
+    if (NULL == pool)
+    {
+        return;
+    }
+
+    PoolWait(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->threads; i++)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    for (i = 0; i < pool->threads; i++)
+    {
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        free(pool->deques[i].tasks);
+    }
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->work);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->deques);
+    free(pool->workers);
+    free(pool);
+}
+
+/****************************************************************************
+*   Function   : PoolCpuCount
+*   Description: This function returns the number of online processors,
+*                which is a sensible default size for a pool.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of processors online, or 1 if it can't be found.
+****************************************************************************/
+unsigned int PoolCpuCount(void)
+{
+    long count;
+
+    count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count < 1) ? 1 : (unsigned int)count;
+}
+
+/****************************************************************************
+*   Function   : MakeWorkerKey
+*   Description: This function creates the thread specific data key used
+*                to find the pool_worker_t of the calling thread.
+*   Parameters : None
+*   Effects    : workerKey is created.
+*   Returned   : None
+****************************************************************************/
+static void MakeWorkerKey(void)
+{
+    pthread_key_create(&workerKey, NULL);
+}
+
+/****************************************************************************
+*   Function   : PoolWorker
+*   Description: This function is run by each of the pool's threads.  It
+*                runs tasks from the back of its own deque, and when that
+*                is empty it steals from the front of the other deques.  It
+*                sleeps when there is no queued work anywhere.
+*   Parameters : arg - pointer to the thread's pool_worker_t
+*   Effects    : Tasks are run.
+*   Returned   : NULL
+****************************************************************************/
+static void *PoolWorker(void *arg)
+{
+    pool_worker_t *self;
+    pool_t *pool;
+    pool_task_t task;
+    unsigned int i;
+    int found;
+
+    self = (pool_worker_t *)arg;
+    pool = self->pool;
+    pthread_setspecific(workerKey, self);
+
+    for (;;)
+    {
+        found = PopBack(&pool->deques[self->index], &task);
+
+        /* steal, starting with the next worker's deque */
+        for (i = 1; !found && (i < pool->threads); i++)
+        {
+            found = PopFront(&pool->deques[(self->index + i) % pool->threads],
+                &task);
+        }
+
+        if (found)
+        {
+            __atomic_sub_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+            task.fn(task.arg);
+
+            if (0 == __atomic_sub_fetch(&pool->unfinished, 1,
+                __ATOMIC_SEQ_CST))
+            {
+                pthread_mutex_lock(&pool->lock);
+                pthread_cond_broadcast(&pool->done);
+                pthread_mutex_unlock(&pool->lock);
+            }
+
+            continue;
+        }
+
+        /* nothing to run; sleep until something is queued */
+        pthread_mutex_lock(&pool->lock);
+        __atomic_add_fetch(&pool->sleeping, 1, __ATOMIC_SEQ_CST);
+
+        while (!pool->shutdown &&
+            (0 == __atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST)))
+        {
+            pthread_cond_wait(&pool->work, &pool->lock);
+        }
+
+        __atomic_sub_fetch(&pool->sleeping, 1, __ATOMIC_SEQ_CST);
+
+        if (pool->shutdown &&
+            (0 == __atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST)))
+        {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+*   Function   : PushBack
+*   Description: This function adds a task to the back of a deque, growing
+*                the deque if it is full.
+*   Parameters : deque - deque to add the task to
+*                task - task to add
+*   Effects    : task is copied into the deque.
+*   Returned   : 0 for success, -1 if the deque can't be grown.
+****************************************************************************/
+static int PushBack(pool_deque_t *deque, const pool_task_t *task)
+{
+    pool_task_t *tasks;
+    size_t capacity, i;
+
+    pthread_mutex_lock(&deque->lock);
+
+    if (deque->count == deque->capacity)
+    {
+        capacity = (0 == deque->capacity) ? DEQUE_START : 2 * deque->capacity;
+        tasks = (pool_task_t *)malloc(capacity * sizeof(pool_task_t));
+
+        if (NULL == tasks)
+        {
+            pthread_mutex_unlock(&deque->lock);
+            return -1;
+        }
+
+        /* unwrap the old circular buffer into the new one */
+        for (i = 0; i < deque->count; i++)
+        {
+            tasks[i] = deque->tasks[(deque->front + i) & (deque->capacity - 1)];
+        }
+
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->capacity = capacity;
+        deque->front = 0;
+    }
+
+    deque->tasks[(deque->front + deque->count) & (deque->capacity - 1)] =
+        *task;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : PopBack
+*   Description: This function removes the newest task from a deque.  It is
+*                used by the deque's owner.
+*   Parameters : deque - deque to take a task from
+*                task - set to the task removed
+*   Effects    : The newest task is removed from the deque.
+*   Returned   : 1 if a task was removed, 0 if the deque was empty.
+****************************************************************************/
+static int PopBack(pool_deque_t *deque, pool_task_t *task)
+{
+    int found;
+
+    found = 0;
+    pthread_mutex_lock(&deque->lock);
+
+    if (0 != deque->count)
+    {
+        deque->count--;
+        *task = deque->tasks[(deque->front + deque->count) &
+            (deque->capacity - 1)];
+        found = 1;
+    }
+
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+/****************************************************************************
+*   Function   : PopFront
+*   Description: This function removes the oldest task from a deque.  It is
+*                used by workers stealing from other workers.
+*   Parameters : deque - deque to take a task from
+*                task - set to the task removed
+*   Effects    : The oldest task is removed from the deque.
+*   Returned   : 1 if a task was removed, 0 if the deque was empty.
+****************************************************************************/
+static int PopFront(pool_deque_t *deque, pool_task_t *task)
+{
+    int found;
+
+    found = 0;
+
+    /* don't wait on a deque that another thread is using */
+    if (0 != pthread_mutex_trylock(&deque->lock))
+    {
+        return 0;
+    }
+
+    if (0 != deque->count)
+    {
+        *task = deque->tasks[deque->front];
+        deque->front = (deque->front + 1) & (deque->capacity - 1);
+        deque->count--;
+        found = 1;
+    }
+
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
@@ -0,0 +1,62 @@
+/***************************************************************************
+*                         Work Stealing Thread Pool
+*
+*   File    : pool.h
+*   Purpose : Header for a pool of threads that run tasks, with idle
+*             threads stealing tasks queued by busy ones
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef POOL_H
+#define POOL_H
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef void (*pool_fn_t)(void *arg);
+
+typedef struct pool_t pool_t;       /* opaque; see pool.c */
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* creates a pool with the specified number of worker threads */
+pool_t *PoolCreate(unsigned int threads);
+
+/* queues fn(arg) to be run by one of the pool's threads.  Tasks queued by
+ * a task go to the front of that worker's own queue. */
+int PoolSubmit(pool_t *pool, pool_fn_t fn, void *arg);
+
+/* waits until every task submitted to the pool has finished */
+void PoolWait(pool_t *pool);
+
+/* waits for the pool's tasks to finish, then frees the pool */
+void PoolDestroy(pool_t *pool);
+
+/* returns the number of processors online (at least 1) */
+unsigned int PoolCpuCount(void);
+
+#endif  /* ndef POOL_H */
@@ -0,0 +1,456 @@
+/***************************************************************************
+*                      Whitespace and Line End Scanner
+*
+*   File    : scan.c
+*   Purpose : Locate the next tab, space, or line ending in a block of
+*             text so that runs of ordinary characters can be copied in
+*             bulk
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <pthread.h>
+#include "scan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCAN_X86
+#include <immintrin.h>
+#endif
+
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+#define IS_SPECIAL(c) \
+    (('\t' == (c)) || (' ' == (c)) || ('\n' == (c)) || ('\r' == (c)))
+
+/* word-at-a-time test for a zero byte */
+#define ONES        (~0UL / 255)
+#define HIGHS       (ONES * 0x80)
+#define HAS_ZERO(w) (((w) - ONES) & ~(w) & HIGHS)
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static void Resolve(void);
+static const char *ScanResolve(const char *p, const char *end);
+static const char *AsciiResolve(const char *p, const char *end);
+static const char *ScanScalar(const char *p, const char *end);
+static const char *AsciiScalar(const char *p, const char *end);
+
+#ifdef SCAN_X86
+static const char *ScanSSE2(const char *p, const char *end);
+static const char *ScanAVX2(const char *p, const char *end);
+static const char *AsciiSSE2(const char *p, const char *end);
+static const char *AsciiAVX2(const char *p, const char *end);
+#endif
+
+/***************************************************************************
+*                            GLOBAL VARIABLES
+***************************************************************************/
+scan_fn_t FindSpecial = ScanResolve;
+scan_fn_t FindNonAscii = AsciiResolve;
+
+static const char *implName = "unresolved";
+
+/* the scanners are only ever resolved once, by whichever thread gets here
+ * first; pthread_once orders that before every other caller's scans */
+static pthread_once_t resolveOnce = PTHREAD_ONCE_INIT;
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : Resolve
+*   Description: This function selects the fastest scanners supported by
+*                the CPU and stores them in FindSpecial and FindNonAscii
+*                so later calls go straight to them.  It is only run
+*                through ScanInit.
+*   Parameters : None
+*   Effects    : FindSpecial and FindNonAscii are set.
+*   Returned   : None
+****************************************************************************/
+static void Resolve(void)
+{
+    scan_fn_t fn, ascii;
+
+    fn = ScanScalar;
+    ascii = AsciiScalar;
+    implName = "scalar";
+
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        fn = ScanAVX2;
+        ascii = AsciiAVX2;
+        implName = "avx2";
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        fn = ScanSSE2;
+        ascii = AsciiSSE2;
+        implName = "sse2";
+    }
+#endif
+
+    FindNonAscii = ascii;
+    FindSpecial = fn;
+}
+
+/****************************************************************************
+*   Function   : ScanInit
+*   Description: This function resolves FindSpecial and FindNonAscii the
+*                first time it's called from any thread.  A thread that
+*                calls it before scanning is guaranteed to see the
+*                resolved scanners, so it's called by TrimmerInit and
+*                whatever else scans.
+*   Parameters : None
+*   Effects    : FindSpecial and FindNonAscii are set the first time.
+*   Returned   : None
+****************************************************************************/
+void ScanInit(void)
+{
+    (void)pthread_once(&resolveOnce, Resolve);
+}
+
+/****************************************************************************
+*   Function   : ScanResolve
+*   Description: This function is the initial value of FindSpecial.  It
+*                selects the scanners and then performs the requested
+*                scan.
+*   Parameters : p - start of the text to scan
+*                end - one past the last character to scan
+*   Effects    : FindSpecial and FindNonAscii are set.
+*   Returned   : Pointer to the first tab, space, or line ending in
+*                [p, end), or end if there are none.
+****************************************************************************/
+static const char *ScanResolve(const char *p, const char *end)
+{
+    ScanInit();
+    return FindSpecial(p, end);
+}
+
+/****************************************************************************
+*   Function   : AsciiResolve
+*   Description: This function is the initial value of FindNonAscii.  It
+*                selects the scanners and then performs the requested
+*                scan.
+*   Parameters : p - start of the text to scan
+*                end - one past the last character to scan
+*   Effects    : FindSpecial and FindNonAscii are set.
+*   Returned   : Pointer to the first byte that isn't ASCII in [p, end),
+*                or end if there are none.
+****************************************************************************/
+static const char *AsciiResolve(const char *p, const char *end)
+{
+    ScanInit();
+    return FindNonAscii(p, end);
+}
+
+/****************************************************************************
+*   Function   : ScanImplName
+*   Description: This function reports which scanner FindSpecial uses,
+*                resolving it first if that hasn't happened yet.
+*   Parameters : None
+*   Effects    : FindSpecial may be resolved.
+*   Returned   : "scalar", "sse2", or "avx2"
+****************************************************************************/
+const char *ScanImplName(void)
+{
+    ScanInit();
+    return implName;
+}
+
+/****************************************************************************
+*   Function   : ScanSelect
+*   Description: This function makes FindSpecial and FindNonAscii use a
+*                particular scanner instead of the fastest one, so that the
+*                scanners can be compared.
+*   Parameters : name - "scalar", "sse2", or "avx2"
+*   Effects    : FindSpecial and FindNonAscii are set to the named scanner
+*                if the CPU supports it.  It must be called before other
+*                threads scan.
+*   Returned   : 0 for success, -1 if the scanner isn't supported.
+****************************************************************************/
+int ScanSelect(const char *name)
+{
+    /* so a later ScanInit can't undo the choice */
+    ScanInit();
+
+    if (0 == strcmp(name, "scalar"))
+    {
+        FindSpecial = ScanScalar;
+        FindNonAscii = AsciiScalar;
+        implName = "scalar";
+        return 0;
+    }
+
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+
+    if ((0 == strcmp(name, "sse2")) && __builtin_cpu_supports("sse2"))
+    {
+        FindSpecial = ScanSSE2;
+        FindNonAscii = AsciiSSE2;
+        implName = "sse2";
+        return 0;
+    }
+
+    if ((0 == strcmp(name, "avx2")) && __builtin_cpu_supports("avx2"))
+    {
+        FindSpecial = ScanAVX2;
+        FindNonAscii = AsciiAVX2;
+        implName = "avx2";
+        return 0;
+    }
+#endif
+
+    return -1;
+}
+
+/****************************************************************************
+*   Function   : ScanScalar
+*   Description: This function is the portable scanner.  It tests a word
+*                at a time for any of the four special characters and only
+*                looks at individual bytes in a word that contains one.
+*   Parameters : p - start of the text to scan
+*                end - one past the last character to scan
+*   Effects    : None
+*   Returned   : Pointer to the first tab, space, or line ending in
+*                [p, end), or end if there are none.
+****************************************************************************/
+static const char *ScanScalar(const char *p, const char *end)
+{
+    unsigned long w;
+
+    while ((size_t)(end - p) >= sizeof(w))
+    {
+        memcpy(&w, p, sizeof(w));
+
+        if (HAS_ZERO(w ^ (ONES * '\t')) | HAS_ZERO(w ^ (ONES * ' ')) |
+            HAS_ZERO(w ^ (ONES * '\n')) | HAS_ZERO(w ^ (ONES * '\r')))
+        {
+            break;
+        }
+
+        p += sizeof(w);
+    }
+
+    while ((p < end) && !IS_SPECIAL(*p))
+    {
+        p++;
+    }
+
+    return p;
+}
+
+/****************************************************************************
+*   Function   : AsciiScalar
+*   Description: This function is the portable search for a byte that
+*                isn't ASCII.  It tests the high bits of a word at a time.
+*   Parameters : p - start of the text to scan
+*                end - one past the last character to scan
+*   Effects    : None
+*   Returned   : Pointer to the first byte that isn't ASCII in [p, end),
+*                or end if there are none.
+****************************************************************************/
+static const char *AsciiScalar(const char *p, const char *end)
+{
+    unsigned long w;
+
+    while ((size_t)(end - p) >= sizeof(w))
+    {
+        memcpy(&w, p, sizeof(w));
+
+        if (0 != (w & HIGHS))
+        {
+            break;
+        }
+
+        p += sizeof(w);
+    }
+
+    while ((p < end) && (0 == (*p & 0x80)))
+    {
+        p++;
+    }
+
+    return p;
+}
+
+#ifdef SCAN_X86
+/****************************************************************************
+*   Function   : ScanSSE2
+*   Description: This function scans 16 bytes at a time using SSE2
+*                compares, falling back to the scalar scanner for the tail
+*                of the text.
+*   Parameters : p - start of the text to scan
+*                end - one past the last character to scan
+*   Effects    : None
+*   Returned   : Pointer to the first tab, space, or line ending in
+*                [p, end), or end if there are none.
+****************************************************************************/
+__attribute__((target("sse2")))
+static const char *ScanSSE2(const char *p, const char *end)
+{
+    __m128i tab, space, lf, cr, v, hit;
+    int mask;
+
+    tab = _mm_set1_epi8('\t');
+    space = _mm_set1_epi8(' ');
+    lf = _mm_set1_epi8('\n');
+    cr = _mm_set1_epi8('\r');
+
+    while (end - p >= 16)
+    {
+        v = _mm_loadu_si128((const __m128i *)p);
+        hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, space)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+        mask = _mm_movemask_epi8(hit);
+
+        if (0 != mask)
+        {
+            return p + __builtin_ctz((unsigned int)mask);
+        }
+
+        p += 16;
+    }
+
+    return ScanScalar(p, end);
+}
+
+/****************************************************************************
+*   Function   : ScanAVX2
+*   Description: This function scans 32 bytes at a time using AVX2
+*                compares, falling back to the SSE2 scanner for the tail
+*                of the text.
+*   Parameters : p - start of the text to scan
+*                end - one past the last character to scan
+*   Effects    : None
+*   Returned   : Pointer to the first tab, space, or line ending in
+*                [p, end), or end if there are none.
+****************************************************************************/
+__attribute__((target("avx2")))
+static const char *ScanAVX2(const char *p, const char *end)
+{
+    __m256i tab, space, lf, cr, v, hit;
+    unsigned int mask;
+
+    tab = _mm256_set1_epi8('\t');
+    space = _mm256_set1_epi8(' ');
+    lf = _mm256_set1_epi8('\n');
+    cr = _mm256_set1_epi8('\r');
+
+    while (end - p >= 32)
+    {
+        v = _mm256_loadu_si256((const __m256i *)p);
+        hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, tab),
+                _mm256_cmpeq_epi8(v, space)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, lf),
+                _mm256_cmpeq_epi8(v, cr)));
+        mask = (unsigned int)_mm256_movemask_epi8(hit);
+
+        if (0 != mask)
+        {
+            return p + __builtin_ctz(mask);
+        }
+
+        p += 32;
+    }
+
+    return ScanSSE2(p, end);
+}
+
+/****************************************************************************
+*   Function   : AsciiSSE2
+*   Description: This function looks for a byte that isn't ASCII 16 bytes
+*                at a time; the byte's high bit is all movemask needs.
+*   Parameters : p - start of the text to scan
+*                end - one past the last character to scan
+*   Effects    : None
+*   Returned   : Pointer to the first byte that isn't ASCII in [p, end),
+*                or end if there are none.
+****************************************************************************/
+__attribute__((target("sse2")))
+static const char *AsciiSSE2(const char *p, const char *end)
+{
+    int mask;
+
+    while (end - p >= 16)
+    {
+        mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)p));
+
+        if (0 != mask)
+        {
+            return p + __builtin_ctz((unsigned int)mask);
+        }
+
+        p += 16;
+    }
+
+    return AsciiScalar(p, end);
+}
+
+/****************************************************************************
+*   Function   : AsciiAVX2
+*   Description: This function looks for a byte that isn't ASCII 32 bytes
+*                at a time, falling back to the SSE2 version for the tail.
+*   Parameters : p - start of the text to scan
+*                end - one past the last character to scan
+*   Effects    : None
+*   Returned   : Pointer to the first byte that isn't ASCII in [p, end),
+*                or end if there are none.
+****************************************************************************/
+__attribute__((target("avx2")))
+static const char *AsciiAVX2(const char *p, const char *end)
+{
+    unsigned int mask;
+
+    while (end - p >= 32)
+    {
+        mask = (unsigned int)_mm256_movemask_epi8(
+            _mm256_loadu_si256((const __m256i *)p));
+
+        if (0 != mask)
+        {
+            return p + __builtin_ctz(mask);
+        }
+
+        p += 32;
+    }
+
+    return AsciiSSE2(p, end);
+}
+#endif  /* def SCAN_X86 */
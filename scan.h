@@ -0,0 +1,64 @@
+/***************************************************************************
+*                      Whitespace and Line End Scanner
+*
+*   File    : scan.h
+*   Purpose : Header for functions that locate the next tab, space, or
+*             line ending in a block of text
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef SCAN_H
+#define SCAN_H
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef const char *(*scan_fn_t)(const char *p, const char *end);
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* returns a pointer to the first '\t', ' ', '\n', or '\r' in [p, end) or
+ * end if there are none.  The fastest implementation for the CPU is
+ * selected by ScanInit. */
+extern scan_fn_t FindSpecial;
+
+/* returns a pointer to the first byte of [p, end) that isn't ASCII (the
+ * high bit is set), or end if there are none.  It's selected along with
+ * FindSpecial. */
+extern scan_fn_t FindNonAscii;
+
+/* resolves FindSpecial and FindNonAscii once; every thread calls it (or
+ * TrimmerInit) before its first scan, so no thread sees them change */
+void ScanInit(void);
+
+/* returns the name of the implementation FindSpecial uses */
+const char *ScanImplName(void);
+
+/* makes FindSpecial use the named scanner; returns -1 if unsupported */
+int ScanSelect(const char *name);
+
+#endif  /* ndef SCAN_H */
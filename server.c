@@ -0,0 +1,1040 @@
+/***************************************************************************
+*                                Trim Server
+*
+*   File    : server.c
+*   Purpose : Serve trimming requests framed with a length prefix on a Unix
+*             domain socket, using a pool of persistent worker threads
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <pthread.h>
+#include "server.h"
+#include "trimfile.h"
+#include "pool.h"
+#include "codec.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define MAX_REQUEST     (64 * 1024 * 1024)  /* largest buffer or file */
+#define MAX_REPLY       0x7FFFFFFFul        /* largest trimmed reply */
+#define IO_SIZE         (64 * 1024)         /* first size of each buffer */
+#define KEEP_SIZE       (1024 * 1024)       /* largest buffer kept idle */
+#define LISTEN_BACKLOG  128
+#define IO_TIMEOUT      10                  /* seconds a read or write
+                                               may wait */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef struct server_t server_t;
+
+/* a buffer that grows to fit and is kept from request to request */
+typedef struct conn_buf_t
+{
+    char *data;
+    size_t size;                /* capacity of data */
+    size_t used;                /* number of bytes in data */
+} conn_buf_t;
+
+/* a client connection and the buffers it's served with.  The buffers go
+ * back to the server when the connection closes, so the next connection
+ * starts with them already allocated. */
+typedef struct conn_t
+{
+    server_t *server;           /* server the connection belongs to */
+    int fd;                     /* the connected socket */
+    conn_buf_t in;              /* requests received */
+    size_t inStart;             /* start of the request being served */
+    conn_buf_t out;             /* reply being made, after its header */
+    conn_buf_t file;            /* contents of a named file, or its name */
+    struct conn_t *next;        /* next on the idle or active list */
+} conn_t;
+
+struct server_t
+{
+    const trim_opts_t *opts;    /* defaults for every request */
+    pthread_mutex_t lock;       /* protects the lists */
+    conn_t *idle;               /* buffers of closed connections */
+    conn_t *active;             /* connections being served */
+};
+
+/***************************************************************************
+*                            GLOBAL VARIABLES
+***************************************************************************/
+static volatile sig_atomic_t stopServer = 0;    /* set by SIGINT/SIGTERM */
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static void OnStop(int sig);
+static int Listen(const char *path);
+static conn_t *ConnOpen(server_t *server, int fd);
+static void ConnClose(conn_t *conn);
+static void Serve(void *arg);
+static int Fill(conn_t *conn, size_t need);
+static int Handle(conn_t *conn, const unsigned char *fields,
+    const char *data, size_t len);
+static int RequestOpts(const trim_opts_t *defaults,
+    const unsigned char *fields, trim_opts_t *opts);
+static int TrimBuffer(conn_t *conn, const trim_opts_t *opts,
+    const char *data, size_t len);
+static int ReadFile(conn_t *conn, int fd);
+static int AppendSink(void *context, const char *data, size_t len);
+static int Reply(conn_t *conn, int status);
+static int ReplyError(conn_t *conn, int err);
+static int Reserve(conn_buf_t *buf, size_t len);
+static uint32_t Get32(const unsigned char *p);
+static void Put32(unsigned char *p, uint32_t value);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : TrimServe
+*   Description: This function listens on a Unix domain socket and serves
+*                trimming requests until SIGINT or SIGTERM.  Each accepted
+*                connection is served by one of a pool of threads that
+*                last for the life of the server, one request after
+*                another until the client closes it, so a client that
+*                keeps its connection pays for neither a process nor a
+*                thread per request.  A stale socket left by an earlier
+*                server is replaced, but not one a server still answers
+*                on.  A connection that sends or takes nothing for
+*                IO_TIMEOUT seconds is closed.
+*   Parameters : path - name of the socket
+*                opts - trimming options used where a request doesn't
+*                       give its own
+*                threads - number of connections served at once; more
+*                          wait for a thread
+*   Effects    : Creates the socket, serves clients, and removes the
+*                socket when it stops.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+int TrimServe(const char *path, const trim_opts_t *opts,
+    unsigned int threads)
+{
+    server_t server;
+    trim_opts_t defaults;
+    struct sigaction action;
+    struct timeval timeout;
+    sigset_t stopSigs, oldSigs;
+    pool_t *pool;
+    conn_t *conn;
+    int listenFd, fd, err;
+
+    listenFd = Listen(path);
+
+    if (listenFd < 0)
+    {
+        return -1;
+    }
+
+    /* each request is trimmed by the thread serving it */
+    defaults = *opts;
+    defaults.jobs = 1;
+    server.opts = &defaults;
+    server.idle = NULL;
+    server.active = NULL;
+    pthread_mutex_init(&server.lock, NULL);
+
+    /* the workers leave SIGINT and SIGTERM to this thread's accept */
+    sigemptyset(&stopSigs);
+    sigaddset(&stopSigs, SIGINT);
+    sigaddset(&stopSigs, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSigs, &oldSigs);
+    pool = PoolCreate(threads);
+    pthread_sigmask(SIG_SETMASK, &oldSigs, NULL);
+
+    if (NULL == pool)
+    {
+        err = errno;
+        close(listenFd);
+        unlink(path);
+        pthread_mutex_destroy(&server.lock);
+        errno = err;
+        return -1;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = OnStop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    action.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &action, NULL);
+    err = 0;
+
+    while (!stopServer)
+    {
+        fd = accept(listenFd, NULL, NULL);
+
+        if (fd < 0)
+        {
+            if ((EINTR == errno) || (ECONNABORTED == errno))
+            {
+                continue;
+            }
+
+            err = errno;
+            break;
+        }
+
+        /* a client that stalls is dropped rather than holding a thread */
+        timeout.tv_sec = IO_TIMEOUT;
+        timeout.tv_usec = 0;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        conn = ConnOpen(&server, fd);
+
+        if (NULL == conn)
+        {
+            /* there's no memory to serve it with */
+            close(fd);
+            continue;
+        }
+
+        if (0 != PoolSubmit(pool, Serve, conn))
+        {
+            ConnClose(conn);
+        }
+    }
+
+    /* end every connection; their threads see the end of the stream */
+    pthread_mutex_lock(&server.lock);
+
+    for (conn = server.active; NULL != conn; conn = conn->next)
+    {
+        shutdown(conn->fd, SHUT_RDWR);
+    }
+
+    pthread_mutex_unlock(&server.lock);
+    PoolDestroy(pool);
+    close(listenFd);
+    unlink(path);
+
+    while (NULL != server.idle)
+    {
+        conn = server.idle;
+        server.idle = conn->next;
+        free(conn->in.data);
+        free(conn->out.data);
+        free(conn->file.data);
+        free(conn);
+    }
+
+    pthread_mutex_destroy(&server.lock);
+    errno = err;
+    return (0 == err) ? 0 : -1;
+}
+
+/****************************************************************************
+*   Function   : OnStop
+*   Description: This function is the handler for SIGINT and SIGTERM.  It
+*                only sets a flag; the accept it interrupts sees it.
+*   Parameters : sig - signal received
+*   Effects    : stopServer is set.
+*   Returned   : None
+****************************************************************************/
+static void OnStop(int sig)
+{
+    (void)sig;
+    stopServer = 1;
+}
+
+/****************************************************************************
+*   Function   : Listen
+*   Description: This function creates a Unix domain socket and listens on
+*                it.  If the name is already taken by a socket, it's
+*                connected to first: a server that answers keeps it, and
+*                one nothing answers is left from a server that has
+*                stopped, and is replaced.  Anything else with the name is
+*                left alone.  Only the owner may connect to the socket.
+*   Parameters : path - name of the socket
+*   Effects    : Creates the socket.
+*   Returned   : The listening descriptor, otherwise -1 with errno set
+*                (EADDRINUSE if a server is listening on path).
+****************************************************************************/
+static int Listen(const char *path)
+{
+    struct sockaddr_un addr;
+    struct stat sb;
+    mode_t oldMask;
+    int fd, err;
+
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (0 == lstat(path, &sb))
+    {
+        if (!S_ISSOCK(sb.st_mode))
+        {
+            close(fd);
+            errno = EADDRINUSE;
+            return -1;
+        }
+
+        if (0 == connect(fd, (struct sockaddr *)&addr, sizeof(addr)))
+        {
+            /* a server is listening on it */
+            close(fd);
+            errno = EADDRINUSE;
+            return -1;
+        }
+
+        err = errno;
+        close(fd);
+
+        if ((ECONNREFUSED != err) && (ENOENT != err))
+        {
+            /* it can't be told from a live server, so it's kept */
+            errno = (EACCES == err) ? EACCES : EADDRINUSE;
+            return -1;
+        }
+
+        /* the probe leaves the socket unusable; bind a fresh one */
+        if ((ECONNREFUSED == err) && (0 != unlink(path)) &&
+            (ENOENT != errno))
+        {
+            return -1;
+        }
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (fd < 0)
+        {
+            return -1;
+        }
+    }
+
+    /* the socket is created with no access, and opened to the owner */
+    oldMask = umask(0777);
+    err = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(oldMask);
+
+    if (0 != err)
+    {
+        err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    if ((0 != chmod(path, S_IRUSR | S_IWUSR)) ||
+        (0 != listen(fd, LISTEN_BACKLOG)))
+    {
+        err = errno;
+        close(fd);
+        unlink(path);
+        errno = err;
+        return -1;
+    }
+
+    return fd;
+}
+
+/****************************************************************************
+*   Function   : ConnOpen
+*   Description: This function makes a connection for an accepted socket,
+*                reusing the buffers of one that has closed if there are
+*                any, and adds it to the server's active connections.
+*   Parameters : server - server that accepted the socket
+*                fd - the connected socket
+*   Effects    : Memory may be allocated for the connection.
+*   Returned   : The connection, or NULL if there's no memory for it.
+****************************************************************************/
+static conn_t *ConnOpen(server_t *server, int fd)
+{
+    conn_t *conn;
+
+    pthread_mutex_lock(&server->lock);
+    conn = server->idle;
+
+    if (NULL != conn)
+    {
+        server->idle = conn->next;
+    }
+
+    pthread_mutex_unlock(&server->lock);
+
+    if (NULL == conn)
+    {
+        conn = (conn_t *)calloc(1, sizeof(conn_t));
+
+        if (NULL == conn)
+        {
+            return NULL;
+        }
+
+        conn->server = server;
+    }
+
+    conn->fd = fd;
+    conn->in.used = 0;
+    conn->inStart = 0;
+    pthread_mutex_lock(&server->lock);
+    conn->next = server->active;
+    server->active = conn;
+    pthread_mutex_unlock(&server->lock);
+    return conn;
+}
+
+/****************************************************************************
+*   Function   : ConnClose
+*   Description: This function closes a connection's socket and keeps its
+*                buffers for the next connection.  A buffer that has grown
+*                past KEEP_SIZE for a large request is freed instead, so
+*                one large request doesn't hold memory for the life of the
+*                server.
+*   Parameters : conn - connection to close
+*   Effects    : The socket is closed, and the connection is moved to the
+*                server's idle list.
+*   Returned   : None
+****************************************************************************/
+static void ConnClose(conn_t *conn)
+{
+    server_t *server;
+    conn_t **link;
+    conn_buf_t *bufs[3];
+    int i;
+
+    server = conn->server;
+    bufs[0] = &conn->in;
+    bufs[1] = &conn->out;
+    bufs[2] = &conn->file;
+
+    for (i = 0; i < 3; i++)
+    {
+        if (bufs[i]->size > KEEP_SIZE)
+        {
+            free(bufs[i]->data);
+            bufs[i]->data = NULL;
+            bufs[i]->size = 0;
+        }
+    }
+
+    pthread_mutex_lock(&server->lock);
+
+    for (link = &server->active; *link != conn; link = &(*link)->next)
+    {
+    }
+
+    *link = conn->next;
+    close(conn->fd);
+    conn->fd = -1;
+    conn->next = server->idle;
+    server->idle = conn;
+    pthread_mutex_unlock(&server->lock);
+}
+
+/****************************************************************************
+*   Function   : Serve
+*   Description: This function is the pool task that serves one
+*                connection.  Requests are answered in the order they
+*                arrive until the client closes the connection, sends a
+*                request that can't be framed, or can't be written to.
+*                As many bytes as the socket has are read at a time, so a
+*                small request usually takes one read and its reply one
+*                write.
+*   Parameters : arg - pointer to the conn_t to serve
+*   Effects    : Requests are read from the connection and answered, and
+*                the connection is closed.
+*   Returned   : None
+****************************************************************************/
+static void Serve(void *arg)
+{
+    conn_t *conn;
+    const unsigned char *header;
+    uint32_t len;
+
+    conn = (conn_t *)arg;
+
+    for (;;)
+    {
+        if (0 != Fill(conn, SERVER_REQUEST_HEADER))
+        {
+            break;
+        }
+
+        header = (const unsigned char *)conn->in.data + conn->inStart;
+        len = Get32(header);
+
+        if ((len < SERVER_REQUEST_HEADER - 4) ||
+            (len - (SERVER_REQUEST_HEADER - 4) > MAX_REQUEST))
+        {
+            /* the rest of the stream can't be framed */
+            (void)ReplyError(conn, EMSGSIZE);
+            break;
+        }
+
+        if (0 != Fill(conn, 4 + (size_t)len))
+        {
+            break;
+        }
+
+        header = (const unsigned char *)conn->in.data + conn->inStart;
+
+        if (0 != Handle(conn, header,
+            (const char *)header + SERVER_REQUEST_HEADER,
+            len - (SERVER_REQUEST_HEADER - 4)))
+        {
+            break;
+        }
+
+        conn->inStart += 4 + (size_t)len;
+    }
+
+    ConnClose(conn);
+}
+
+/****************************************************************************
+*   Function   : Fill
+*   Description: This function makes sure the next need bytes of a
+*                connection's stream are in its input buffer, starting at
+*                inStart.  Requests already served are dropped from the
+*                buffer first, and it grows for a large request.
+*   Parameters : conn - connection being served
+*                need - number of bytes needed from inStart
+*   Effects    : The connection's socket is read.
+*   Returned   : 0 when the bytes are there, otherwise -1 at the end of
+*                the stream, an error, or when the client sends nothing
+*                for IO_TIMEOUT seconds.
+****************************************************************************/
+static int Fill(conn_t *conn, size_t need)
+{
+    conn_buf_t *in;
+    ssize_t got;
+
+    in = &conn->in;
+
+    if (in->used - conn->inStart >= need)
+    {
+        return 0;
+    }
+
+    if (0 != conn->inStart)
+    {
+        /* keep only the part of the stream not yet served */
+        memmove(in->data, in->data + conn->inStart, in->used - conn->inStart);
+        in->used -= conn->inStart;
+        conn->inStart = 0;
+    }
+
+    if ((need > in->size) && (0 != Reserve(in, need - in->used)))
+    {
+        return -1;
+    }
+
+    while (in->used < need)
+    {
+        got = read(conn->fd, in->data + in->used, in->size - in->used);
+
+        if (got > 0)
+        {
+            in->used += (size_t)got;
+        }
+        else if ((0 == got) || (EINTR != errno))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : Handle
+*   Description: This function carries out one request and replies to it.
+*                A request that fails gets an error reply, and the next
+*                request is still served.
+*   Parameters : conn - connection the request came on
+*                fields - the request's header
+*                data - the buffer or file name that follows the header
+*                len - number of bytes in data
+*   Effects    : The request is carried out and a reply is written.
+*   Returned   : 0 if the reply was written, otherwise -1.
+****************************************************************************/
+static int Handle(conn_t *conn, const unsigned char *fields,
+    const char *data, size_t len)
+{
+    trim_opts_t opts;
+    char *report;
+    size_t reportLen;
+    int op, fd, changed, status;
+
+    op = fields[SERVER_FIELD_OP];
+
+    if ((0 != RequestOpts(conn->server->opts, fields, &opts)) ||
+        ((SERVER_OP_TRIM != op) && (SERVER_OP_CHECK != op) &&
+        (SERVER_OP_IN_PLACE != op)))
+    {
+        return ReplyError(conn, EINVAL);
+    }
+
+    if (SERVER_SOURCE_BUFFER == fields[SERVER_FIELD_SOURCE])
+    {
+        if (SERVER_OP_TRIM == op)
+        {
+            return TrimBuffer(conn, &opts, data, len);
+        }
+
+        if (SERVER_OP_IN_PLACE == op)
+        {
+            return ReplyError(conn, EINVAL);
+        }
+
+        if (0 != CheckMemory(data, len, &opts, "", 0, &report, &reportLen,
+            &changed))
+        {
+            return ReplyError(conn, errno);
+        }
+
+        free(report);
+        conn->out.used = 0;
+        return Reply(conn, changed ? SERVER_CHANGED : SERVER_UNCHANGED);
+    }
+
+    if ((SERVER_SOURCE_PATH != fields[SERVER_FIELD_SOURCE]) ||
+        (0 == len) || (NULL != memchr(data, '\0', len)))
+    {
+        return ReplyError(conn, EINVAL);
+    }
+
+    /* the name needs a NUL; the file buffer holds it until it's open */
+    conn->file.used = 0;
+
+    if (0 != Reserve(&conn->file, len + 1))
+    {
+        return ReplyError(conn, ENOMEM);
+    }
+
+    memcpy(conn->file.data, data, len);
+    conn->file.data[len] = '\0';
+
+    if (SERVER_OP_IN_PLACE == op)
+    {
+        if (0 != TrimFileInPlace(conn->file.data, &opts, 0, &changed))
+        {
+            return ReplyError(conn, errno);
+        }
+
+        conn->out.used = 0;
+        return Reply(conn, changed ? SERVER_CHANGED : SERVER_UNCHANGED);
+    }
+
+    fd = open(conn->file.data, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return ReplyError(conn, errno);
+    }
+
+    if (SERVER_OP_CHECK == op)
+    {
+        /* stops at the first byte that would change */
+        status = CheckFd(fd, &opts, conn->file.data, 0, &report, &reportLen,
+            &changed);
+        close(fd);
+
+        if (0 != status)
+        {
+            return ReplyError(conn, errno);
+        }
+
+        free(report);
+        conn->out.used = 0;
+        return Reply(conn, changed ? SERVER_CHANGED : SERVER_UNCHANGED);
+    }
+
+    status = ReadFile(conn, fd);
+    close(fd);
+
+    if (0 != status)
+    {
+        return ReplyError(conn, errno);
+    }
+
+    return TrimBuffer(conn, &opts, conn->file.data, conn->file.used);
+}
+
+/****************************************************************************
+*   Function   : RequestOpts
+*   Description: This function makes the trimming options of a request
+*                from the server's options and the fields of the request
+*                that override them.  A request that sets the tab size
+*                doesn't use the server's tab stops.
+*   Parameters : defaults - the server's options
+*                fields - the request's header
+*                opts - set to the request's options
+*   Effects    : None
+*   Returned   : 0 for success, -1 if a field isn't valid.
+****************************************************************************/
+static int RequestOpts(const trim_opts_t *defaults,
+    const unsigned char *fields, trim_opts_t *opts)
+{
+    *opts = *defaults;
+
+    if ((fields[SERVER_FIELD_KEEP] > 2) ||
+        (fields[SERVER_FIELD_RETAB] > RETAB_ALL + 1) ||
+        (fields[SERVER_FIELD_EOL] > EOL_AUTO + 1) ||
+        (fields[SERVER_FIELD_UTF8] > 2) ||
+        (0 != fields[SERVER_REQUEST_HEADER - 1]))
+    {
+        return -1;
+    }
+
+    if (0 != fields[SERVER_FIELD_TAB])
+    {
+        opts->tabSize = fields[SERVER_FIELD_TAB];
+        opts->tabStops = NULL;
+    }
+
+    if (0 != fields[SERVER_FIELD_KEEP])
+    {
+        opts->keepTabs = fields[SERVER_FIELD_KEEP] - 1;
+    }
+
+    if (0 != fields[SERVER_FIELD_RETAB])
+    {
+        opts->retab = fields[SERVER_FIELD_RETAB] - 1;
+    }
+
+    if (0 != fields[SERVER_FIELD_EOL])
+    {
+        opts->eol = fields[SERVER_FIELD_EOL] - 1;
+    }
+
+    if (0 != fields[SERVER_FIELD_UTF8])
+    {
+        opts->utf8 = fields[SERVER_FIELD_UTF8] - 1;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : TrimBuffer
+*   Description: This function trims a buffer into the connection's output
+*                buffer and replies with the result, which is marked
+*                changed if it differs from the buffer.  Compressed bytes
+*                are refused with ENOTSUP rather than trimmed as text.
+*   Parameters : conn - connection the request came on
+*                opts - trimming options of the request
+*                data - bytes to trim
+*                len - number of bytes in data
+*   Effects    : The trimmed bytes are written to the connection.
+*   Returned   : 0 if the reply was written, otherwise -1.
+****************************************************************************/
+static int TrimBuffer(conn_t *conn, const trim_opts_t *opts,
+    const char *data, size_t len)
+{
+    trimmer_t trimmer;
+    int changed, err;
+
+    conn->out.used = 0;
+
+    if (CODEC_NONE != CodecFromMagic(data, len))
+    {
+        return ReplyError(conn, ENOTSUP);
+    }
+
+    TrimmerInit(&trimmer, opts);
+
+    if (0 != TrimmerFeed(&trimmer, data, len, AppendSink, conn))
+    {
+        err = errno;
+        TrimmerFree(&trimmer);
+        return ReplyError(conn, err);
+    }
+
+    if (0 != TrimmerFinish(&trimmer, AppendSink, conn))
+    {
+        return ReplyError(conn, errno);
+    }
+
+    changed = (conn->out.used != len) ||
+        ((0 != len) &&
+        (0 != memcmp(conn->out.data + SERVER_REPLY_HEADER, data, len)));
+    return Reply(conn, changed ? SERVER_CHANGED : SERVER_UNCHANGED);
+}
+
+/****************************************************************************
+*   Function   : ReadFile
+*   Description: This function reads a whole regular file into the
+*                connection's file buffer.
+*   Parameters : conn - connection the request came on
+*                fd - descriptor of the file
+*   Effects    : The file is read into conn->file.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int ReadFile(conn_t *conn, int fd)
+{
+    struct stat sb;
+    ssize_t got;
+
+    if (0 != fstat(fd, &sb))
+    {
+        return -1;
+    }
+
+    if (!S_ISREG(sb.st_mode))
+    {
+        errno = S_ISDIR(sb.st_mode) ? EISDIR : EINVAL;
+        return -1;
+    }
+
+    if (sb.st_size > MAX_REQUEST)
+    {
+        errno = EFBIG;
+        return -1;
+    }
+
+    conn->file.used = 0;
+
+    if (0 != Reserve(&conn->file, (size_t)sb.st_size + 1))
+    {
+        return -1;
+    }
+
+    /* read until the end, in case the file has grown */
+    for (;;)
+    {
+        got = read(fd, conn->file.data + conn->file.used,
+            conn->file.size - conn->file.used);
+
+        if (0 == got)
+        {
+            return 0;
+        }
+
+        if (got < 0)
+        {
+            if (EINTR != errno)
+            {
+                return -1;
+            }
+
+            continue;
+        }
+
+        conn->file.used += (size_t)got;
+
+        if (conn->file.used > MAX_REQUEST)
+        {
+            errno = EFBIG;
+            return -1;
+        }
+
+        if ((conn->file.used == conn->file.size) &&
+            (0 != Reserve(&conn->file, conn->file.size)))
+        {
+            return -1;
+        }
+    }
+}
+
+/****************************************************************************
+*   Function   : AppendSink
+*   Description: This function is the trim_sink_t that appends trimmed
+*                output to a connection's output buffer, after room for
+*                the reply header.
+*   Parameters : context - the connection
+*                data - trimmed output
+*                len - number of bytes in data
+*   Effects    : data is copied into the output buffer, which may grow.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int AppendSink(void *context, const char *data, size_t len)
+{
+    conn_buf_t *out;
+
+    out = &((conn_t *)context)->out;
+
+    if (out->used + len > MAX_REPLY - SERVER_REPLY_HEADER)
+    {
+        errno = EFBIG;
+        return -1;
+    }
+
+    if (0 != Reserve(out, SERVER_REPLY_HEADER + len))
+    {
+        return -1;
+    }
+
+    memcpy(out->data + SERVER_REPLY_HEADER + out->used, data, len);
+    out->used += len;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : Reply
+*   Description: This function writes a reply with the bytes in the
+*                connection's output buffer.  The header goes in the room
+*                left at the front of the buffer, so the whole reply is
+*                one write.
+*   Parameters : conn - connection to reply on
+*                status - SERVER_UNCHANGED, SERVER_CHANGED or SERVER_ERROR
+*   Effects    : The reply is written to the connection.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int Reply(conn_t *conn, int status)
+{
+    unsigned char *header;
+
+    if (0 != Reserve(&conn->out, SERVER_REPLY_HEADER))
+    {
+        return -1;
+    }
+
+    header = (unsigned char *)conn->out.data;
+    Put32(header, (uint32_t)(SERVER_REPLY_HEADER - 4 + conn->out.used));
+    header[4] = (unsigned char)status;
+    header[5] = 0;
+    header[6] = 0;
+    header[7] = 0;
+    return WriteAll(conn->fd, conn->out.data,
+        SERVER_REPLY_HEADER + conn->out.used);
+}
+
+/****************************************************************************
+*   Function   : ReplyError
+*   Description: This function writes an error reply whose data is the
+*                message for an errno value.
+*   Parameters : conn - connection to reply on
+*                err - errno value of the failure
+*   Effects    : The reply is written to the connection.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int ReplyError(conn_t *conn, int err)
+{
+    conn->out.used = 0;
+
+    if (0 != AppendSink(conn, strerror(err), strlen(strerror(err))))
+    {
+        conn->out.used = 0;
+    }
+
+    return Reply(conn, SERVER_ERROR);
+}
+
+/****************************************************************************
+*   Function   : Reserve
+*   Description: This function grows a buffer so that it can hold len more
+*                bytes, at least doubling it each time it grows.
+*   Parameters : buf - buffer to grow
+*                len - number of bytes that must fit after buf->used
+*   Effects    : buf->data may be reallocated and buf->size increased.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int Reserve(conn_buf_t *buf, size_t len)
+{
+    size_t size;
+    char *data;
+
+    if (buf->used + len <= buf->size)
+    {
+        return 0;
+    }
+
+    size = (0 == buf->size) ? IO_SIZE : buf->size;
+
+    while (size < buf->used + len)
+    {
+        size *= 2;
+    }
+
+    data = (char *)realloc(buf->data, size);
+
+    if (NULL == data)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    buf->data = data;
+    buf->size = size;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : Get32
+*   Description: This function reads a 32 bit big endian value.
+*   Parameters : p - the value's 4 bytes
+*   Effects    : None
+*   Returned   : The value.
+****************************************************************************/
+static uint32_t Get32(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+        ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+/****************************************************************************
+*   Function   : Put32
+*   Description: This function writes a 32 bit big endian value.
+*   Parameters : p - where the value's 4 bytes go
+*                value - the value
+*   Effects    : The 4 bytes at p are written.
+*   Returned   : None
+****************************************************************************/
+static void Put32(unsigned char *p, uint32_t value)
+{
+    p[0] = (unsigned char)(value >> 24);
+    p[1] = (unsigned char)(value >> 16);
+    p[2] = (unsigned char)(value >> 8);
+    p[3] = (unsigned char)value;
+}
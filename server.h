@@ -0,0 +1,87 @@
+/***************************************************************************
+*                                Trim Server
+*
+*   File    : server.h
+*   Purpose : Header for the server that trims requests from a Unix domain
+*             socket
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef SERVER_H
+#define SERVER_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include "trimmer.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+/* A request is a 12 byte header followed by a buffer to trim or the name
+ * of a file.  The 32 bit big endian length at the start of the header
+ * counts the rest of the request: the 8 bytes of fields that follow it
+ * and the data. */
+#define SERVER_REQUEST_HEADER   12
+
+/* offsets of the request fields after the length */
+#define SERVER_FIELD_OP         4   /* SERVER_OP_ value */
+#define SERVER_FIELD_SOURCE     5   /* SERVER_SOURCE_ value */
+#define SERVER_FIELD_TAB        6   /* tab size, 0 for the server's */
+#define SERVER_FIELD_KEEP       7   /* 0 server's, 1 expand, 2 keep tabs */
+#define SERVER_FIELD_RETAB      8   /* 0 server's, else RETAB_ value + 1 */
+#define SERVER_FIELD_EOL        9   /* 0 server's, else EOL_ value + 1 */
+#define SERVER_FIELD_UTF8       10  /* 0 server's, 1 bytes, 2 UTF-8 */
+                                    /* byte 11 is reserved and must be 0 */
+
+/* what is done with the data */
+#define SERVER_OP_TRIM          'T' /* reply with the trimmed bytes */
+#define SERVER_OP_CHECK         'C' /* reply with changed or unchanged */
+#define SERVER_OP_IN_PLACE      'W' /* trim a named file in place */
+
+/* what the data is */
+#define SERVER_SOURCE_BUFFER    'B' /* the bytes to be trimmed */
+#define SERVER_SOURCE_PATH      'P' /* name of a file, without a NUL */
+
+/* A reply is an 8 byte header followed by the trimmed bytes, nothing, or
+ * an error message.  The 32 bit big endian length at the start counts the
+ * rest of the reply, and the byte after it is the status.  The last 3
+ * bytes of the header are 0. */
+#define SERVER_REPLY_HEADER     8
+
+#define SERVER_UNCHANGED        0   /* trimming changes nothing */
+#define SERVER_CHANGED          1   /* trimming changes the data */
+#define SERVER_ERROR            2   /* the request failed */
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* serves requests on a Unix domain socket with a pool of threads until
+ * SIGINT or SIGTERM; opts are the defaults for each request */
+int TrimServe(const char *path, const trim_opts_t *opts,
+    unsigned int threads);
+
+#endif  /* ndef SERVER_H */
@@ -0,0 +1,257 @@
+/***************************************************************************
+*                            Trimming Statistics
+*
+*   File    : stats.c
+*   Purpose : Report the statistics of trimmed files as a table or as JSON
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "stats.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define NS_PER_SEC  1e9
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static void PrintRow(const stats_report_t *report, const char *name,
+    const trim_stats_t *stats);
+static void PrintObject(const stats_report_t *report, const char *name,
+    const trim_stats_t *stats);
+static void PrintJsonString(FILE *fp, const char *str);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : StatsBegin
+*   Description: This function starts a report of the statistics of the
+*                files being trimmed.  A table starts with its heading; a
+*                JSON report is an object with a "files" array and a
+*                "total" object.
+*   Parameters : report - report to start
+*                fp - stream the report is written to
+*                json - non-zero to write JSON instead of a table
+*   Effects    : The start of the report is written to fp.
+*   Returned   : None
+****************************************************************************/
+void StatsBegin(stats_report_t *report, FILE *fp, int json)
+{
+    report->fp = fp;
+    report->json = json;
+    report->files = 0;
+    memset(&report->total, 0, sizeof(report->total));
+
+    if (json)
+    {
+        fprintf(fp, "{\n  \"files\": [");
+    }
+    else
+    {
+        fprintf(fp, "%12s %12s %10s %9s %10s %8s %9s %9s %9s  %s\n",
+            "bytes in", "bytes out", "lines", "tabs", "trailing", "longest",
+            "read (s)", "trim (s)", "write (s)", "file");
+    }
+}
+
+/****************************************************************************
+*   Function   : StatsFile
+*   Description: This function reports the statistics of one file as a
+*                row of the table or an object in the "files" array, and
+*                adds them to the report's total.  Files are reported in
+*                the order they're written.
+*   Parameters : report - report started by StatsBegin
+*                name - name of the file
+*                stats - statistics of the file
+*   Effects    : A row or object is written to the report's stream.
+*   Returned   : None
+****************************************************************************/
+void StatsFile(stats_report_t *report, const char *name,
+    const trim_stats_t *stats)
+{
+    if (report->json)
+    {
+        fprintf(report->fp, (0 == report->files) ? "\n    " : ",\n    ");
+        PrintObject(report, name, stats);
+    }
+    else
+    {
+        PrintRow(report, name, stats);
+    }
+
+    report->files++;
+    TrimStatsAdd(&report->total, stats);
+}
+
+/****************************************************************************
+*   Function   : StatsEnd
+*   Description: This function ends a report with the total of the files
+*                reported.  Times in the total are summed, so they may be
+*                more than the time trimming took when files or stages
+*                were handled by several threads at once.
+*   Parameters : report - report started by StatsBegin
+*   Effects    : The total is written to the report's stream, and the
+*                stream is flushed.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+int StatsEnd(stats_report_t *report)
+{
+    if (report->json)
+    {
+        fprintf(report->fp, "%s],\n  \"total\": ",
+            (0 == report->files) ? "" : "\n  ");
+        PrintObject(report, NULL, &report->total);
+        fprintf(report->fp, "\n}\n");
+    }
+    else
+    {
+        PrintRow(report, NULL, &report->total);
+    }
+
+    if ((0 != fflush(report->fp)) || ferror(report->fp))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : PrintRow
+*   Description: This function writes the statistics of a file, or the
+*                total, as a row of the table.  Counts are written as
+*                doubles, which are exact well past any file size, since
+*                C90 has no format for 64 bit integers.
+*   Parameters : report - report being written
+*                name - name of the file, or NULL for the total
+*                stats - statistics to write
+*   Effects    : A row is written to the report's stream.
+*   Returned   : None
+****************************************************************************/
+static void PrintRow(const stats_report_t *report, const char *name,
+    const trim_stats_t *stats)
+{
+    fprintf(report->fp, "%12.0f %12.0f %10.0f %9.0f %10.0f %8.0f ",
+        (double)stats->bytesIn, (double)stats->bytesOut,
+        (double)stats->lines, (double)stats->tabs,
+        (double)stats->trailing, (double)stats->longest);
+    fprintf(report->fp, "%9.3f %9.3f %9.3f  ",
+        (double)stats->readNs / NS_PER_SEC,
+        (double)stats->trimNs / NS_PER_SEC,
+        (double)stats->writeNs / NS_PER_SEC);
+
+    if (NULL != name)
+    {
+        fprintf(report->fp, "%s\n", name);
+    }
+    else
+    {
+        fprintf(report->fp, "total (%lu file%s)\n", report->files,
+            (1 == report->files) ? "" : "s");
+    }
+}
+
+/****************************************************************************
+*   Function   : PrintObject
+*   Description: This function writes the statistics of a file, or the
+*                total, as a JSON object.  Times are in nanoseconds.
+*   Parameters : report - report being written
+*                name - name of the file, or NULL for the total
+*                stats - statistics to write
+*   Effects    : An object is written to the report's stream.
+*   Returned   : None
+****************************************************************************/
+static void PrintObject(const stats_report_t *report, const char *name,
+    const trim_stats_t *stats)
+{
+    fprintf(report->fp, "{");
+
+    if (NULL != name)
+    {
+        fprintf(report->fp, "\"name\": ");
+        PrintJsonString(report->fp, name);
+    }
+    else
+    {
+        fprintf(report->fp, "\"files\": %lu", report->files);
+    }
+
+    fprintf(report->fp, ", \"bytes_in\": %.0f, \"bytes_out\": %.0f, "
+        "\"lines\": %.0f, \"tabs\": %.0f, \"trailing\": %.0f, "
+        "\"longest\": %.0f, ",
+        (double)stats->bytesIn, (double)stats->bytesOut,
+        (double)stats->lines, (double)stats->tabs,
+        (double)stats->trailing, (double)stats->longest);
+    fprintf(report->fp, "\"read_ns\": %.0f, \"trim_ns\": %.0f, "
+        "\"write_ns\": %.0f}",
+        (double)stats->readNs, (double)stats->trimNs,
+        (double)stats->writeNs);
+}
+
+/****************************************************************************
+*   Function   : PrintJsonString
+*   Description: This function writes a string as a JSON string literal.
+*                Quotes, backslashes, and control characters are escaped;
+*                everything else, including bytes of UTF-8, is written as
+*                it is.
+*   Parameters : fp - stream to write to
+*                str - string to write
+*   Effects    : The quoted string is written to fp.
+*   Returned   : None
+****************************************************************************/
+static void PrintJsonString(FILE *fp, const char *str)
+{
+    const unsigned char *p;
+
+    putc('"', fp);
+
+    for (p = (const unsigned char *)str; '\0' != *p; p++)
+    {
+        if (('"' == *p) || ('\\' == *p))
+        {
+            putc('\\', fp);
+            putc(*p, fp);
+        }
+        else if (*p < 0x20)
+        {
+            fprintf(fp, "\\u%04x", (unsigned int)*p);
+        }
+        else
+        {
+            putc(*p, fp);
+        }
+    }
+
+    putc('"', fp);
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+*                            Trimming Statistics
+*
+*   File    : stats.h
+*   Purpose : Header for reporting the statistics of trimmed files
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef STATS_H
+#define STATS_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdio.h>
+#include "trimmer.h"
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+/* a report of the statistics of each file trimmed and their total */
+typedef struct stats_report_t
+{
+    FILE *fp;                   /* stream the report is written to */
+    int json;                   /* non-zero for JSON instead of a table */
+    unsigned long files;        /* number of files reported so far */
+    trim_stats_t total;         /* sum of the files reported so far */
+} stats_report_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* starts a report written to fp as a table, or as JSON if json is
+ * non-zero */
+void StatsBegin(stats_report_t *report, FILE *fp, int json);
+
+/* reports the statistics of one file and adds them to the total */
+void StatsFile(stats_report_t *report, const char *name,
+    const trim_stats_t *stats);
+
+/* reports the total and ends the report */
+int StatsEnd(stats_report_t *report);
+
+#endif  /* ndef STATS_H */
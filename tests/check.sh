@@ -0,0 +1,140 @@
+#!/bin/sh
+############################################################################
+# Regression checks for trim.  Input that arrives in pieces (a pipe written
+# with pauses) must be trimmed the same as the same bytes read from a file,
+# and server mode must keep its socket to itself.  gzip cases are skipped
+# if gzip isn't installed.
+#
+# Usage: tests/check.sh [path to trim]
+############################################################################
+TRIM=${1:-./trim}
+TMP=${TMPDIR:-/tmp}/trimcheck.$$
+FAILED=0
+
+mkdir "$TMP" || exit 1
+trap 'rm -rf "$TMP"' 0
+
+# check <name> <expected file> <actual file>
+check()
+{
+    if cmp -s "$2" "$3"; then
+        echo "ok   $1"
+    else
+        echo "FAIL $1"
+        FAILED=1
+    fi
+}
+
+# -e auto must pick the majority ending of the first 64K even when the
+# first read only holds one line
+printf 'a\nb\r\nc\r\nd\r\n' > "$TMP/mixed"
+"$TRIM" -e auto -i "$TMP/mixed" > "$TMP/file"
+printf 'a\r\nb\r\nc\r\nd\r\n' > "$TMP/want"
+check "eol auto from a file" "$TMP/want" "$TMP/file"
+
+(printf 'a\n'; sleep 1; printf 'b\r\nc\r\nd\r\n') |
+    "$TRIM" -e auto > "$TMP/split"
+check "eol auto split across reads" "$TMP/want" "$TMP/split"
+
+(printf 'a\n'; sleep 1; printf 'b\r\nc\r\nd\r\n') |
+    "$TRIM" -e auto -p > "$TMP/split"
+check "eol auto split across reads with -p" "$TMP/want" "$TMP/split"
+
+echo 'stdin:1:2: line ending' > "$TMP/want"
+(printf 'a\n'; sleep 1; printf 'b\r\nc\r\nd\r\n') |
+    "$TRIM" -e auto -l > "$TMP/split"
+check "eol auto split across reads with -l" "$TMP/want" "$TMP/split"
+
+# with -k, trailing whitespace split across reads is trimmed however often
+# it switches between spaces and tabs
+printf 'a\nb\n' > "$TMP/want"
+(printf 'a'; printf ' \t%.0s' $(seq 40); sleep 1; printf ' \t \nb\n') |
+    "$TRIM" -k > "$TMP/split"
+check "kept trailing whitespace split across reads" "$TMP/want" "$TMP/split"
+
+(printf 'a'; printf ' \t%.0s' $(seq 40); sleep 1; printf ' \t \nb\n') |
+    "$TRIM" -k -s json 2>&1 > /dev/null | grep -o '"trailing": [0-9]*' |
+    sort -u > "$TMP/split"
+echo '"trailing": 83' > "$TMP/want"
+check "kept trailing whitespace split across reads counted" "$TMP/want" \
+    "$TMP/split"
+
+(printf 'a'; printf '\t \t%.0s' $(seq 40); printf 'b\n') > "$TMP/want"
+(printf 'a'; printf '\t \t%.0s' $(seq 40); sleep 1; printf 'b\n') |
+    "$TRIM" -k > "$TMP/split"
+check "kept inner whitespace split across reads" "$TMP/want" "$TMP/split"
+
+# gzip input is found from its magic bytes even if the first read only
+# holds one of them
+if command -v gzip > /dev/null; then
+    printf 'a\t \nb\n' | gzip > "$TMP/gz"
+    printf 'a\nb\n' > "$TMP/want"
+    (head -c 1 "$TMP/gz"; sleep 1; tail -c +2 "$TMP/gz") |
+        "$TRIM" > "$TMP/split"
+    check "gzip magic split across reads" "$TMP/want" "$TMP/split"
+
+    (head -c 1 "$TMP/gz"; sleep 1; tail -c +2 "$TMP/gz") |
+        "$TRIM" -p > "$TMP/split"
+    check "gzip magic split across reads with -p" "$TMP/want" "$TMP/split"
+
+    # a named compressed file is decompressed, and one that can't be is
+    # refused rather than checked or rewritten as text
+    cp "$TMP/gz" "$TMP/gz.gz"
+    "$TRIM" "$TMP/gz.gz" > "$TMP/named"
+    check "named gzip file" "$TMP/want" "$TMP/named"
+
+    : > "$TMP/want"
+    : > "$TMP/taken"
+
+    for flag in -c -l -w; do
+        if "$TRIM" $flag "$TMP/gz.gz" > /dev/null 2>&1; then
+            echo "$flag" >> "$TMP/taken"
+        fi
+    done
+
+    cmp -s "$TMP/gz" "$TMP/gz.gz" || echo "rewritten" >> "$TMP/taken"
+    check "gzip file refused by -c, -l, and -w" "$TMP/want" "$TMP/taken"
+fi
+
+# -l reports a line's changes in column order, even when trailing
+# whitespace starts before a tab in it
+printf 'abcde \t\n' > "$TMP/list"
+"$TRIM" -l "$TMP/list" | cut -d : -f 2- > "$TMP/listed"
+printf '1:6: trailing whitespace\n1:7: tab\n' > "$TMP/want"
+check "list in column order" "$TMP/want" "$TMP/listed"
+
+# a tab size below 1 is refused rather than dividing by zero or wrapping
+for t in 0 -3; do
+    if printf 'a\tb\n' | "$TRIM" -t $t > /dev/null 2>&1; then
+        echo "taken" > "$TMP/tab"
+    else
+        : > "$TMP/tab"
+    fi
+
+    : > "$TMP/want"
+    check "tab size $t refused" "$TMP/want" "$TMP/tab"
+done
+
+# a server's socket is only open to its owner, and a second server on the
+# same path must not take it over
+"$TRIM" -S "$TMP/sock" 2> /dev/null &
+SERVER=$!
+for i in 1 2 3 4 5 6 7 8 9 10; do
+    [ -S "$TMP/sock" ] && break
+    sleep 1
+done
+ls -l "$TMP/sock" | cut -c 1-10 > "$TMP/mode"
+echo 'srw-------' > "$TMP/want"
+check "server socket mode" "$TMP/want" "$TMP/mode"
+
+"$TRIM" -S "$TMP/sock" 2> "$TMP/second" &
+SECOND=$!
+sleep 1
+kill $SECOND 2> /dev/null
+wait $SECOND 2> /dev/null
+echo "$TMP/sock: Address already in use" > "$TMP/want"
+check "second server refused" "$TMP/want" "$TMP/second"
+kill $SERVER
+wait $SERVER 2> /dev/null
+
+exit $FAILED
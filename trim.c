@@ -32,26 +32,78 @@
 /***************************************************************************
 *                             INCLUDED FILES
 ***************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "optlist/optlist.h"
+#include "trimfile.h"
+#include "batch.h"
+#include "pool.h"
+#include "diff.h"
+#include "codec.h"
+#include "stats.h"
+#include "server.h"
 
 /***************************************************************************
 *                                CONSTANTS
 ***************************************************************************/
 #define DEFAULT_TAB 4
+#define MAX_JOBS    256     /* most worker threads for -j */
+#define MIN_SERVE   8       /* least connections served at once by -S */
+
+/* statistics reported (-s) */
+#define STATS_NONE  0
+#define STATS_TEXT  1
+#define STATS_JSON  2
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+
+/* a long option and the short option it stands for */
+typedef struct long_opt_t
+{
+    const char *name;
+    char *shortOpt;
+} long_opt_t;
 
 /***************************************************************************
 *                            GLOBAL VARIABLES
 **************************************************************************/
+static const long_opt_t longOpts[] =
+{
+    {"--check", "-c"},
+    {"--dry-run", "-c"},
+    {"--list", "-l"},
+    {"--uring", "-a"},
+    {"--cache", "-C"},
+    {"--diff", "-d"},
+    {"--eol", "-e"},
+    {"--utf8", "-8"},
+    {"--stats", "-s"},
+    {"--serve", "-S"},
+    {NULL, NULL}
+};
 
 /***************************************************************************
 *                               PROTOTYPES
 ***************************************************************************/
 char *RemovePath(char *fullPath);
 
+static int ExpandLongOpts(int argc, char *argv[]);
+static char **GetFileArgs(int argc, char *argv[], const option_t *optList,
+    size_t *count);
+static int RunBatch(char **args, size_t argCount, int readList, int fdOut,
+    const trim_opts_t *opts, const batch_opts_t *batchOpts);
+static int RunDiff(const char *inFile, const char *outFile,
+    const trim_opts_t *opts, const batch_opts_t *batchOpts);
+
 /***************************************************************************
 *                                FUNCTIONS
 ***************************************************************************/
@@ -61,7 +113,9 @@ char *RemovePath(char *fullPath);
 *   Description: This is the main function for this program, it validates
 *                the command line input and, if valid, it will open the
 *                specified input file and write out a copy with tabs expaned
-*                to spaces and trailing spaces trimmed.
+*                to spaces and trailing spaces trimmed.  If file names are
+*                given without -i, each of the files is trimmed and the
+*                results are written one after the other.
 *   Parameters : argc - number of parameters
 *                argv - parameter list
 *   Effects    : Writes version of input file with tabs expanded and trailing
@@ -70,22 +124,79 @@ char *RemovePath(char *fullPath);
 ****************************************************************************/
 int main(int argc, char *argv[])
 {
-    FILE *fpIn, *fpOut;
+    int fdIn, fdOut;
     char *inFile, *outFile;
-    int c, pos, spaces;
-    unsigned int tabSize, keepTabs;
+    const char *socketName;
+    int status;
+    trim_opts_t opts;
+    tab_stops_t tabStops;
+    batch_opts_t batchOpts;
     option_t *optList, *thisOpt;
+    char **files;
+    size_t fileCount;
+    long tabSize;
+    char *end;
+    int readList, jobsSet, changed, diffMode, statsMode;
+    char *report;
+    size_t reportLen;
+    trim_stats_t stats;
+    stats_report_t statsReport;
 
     /* initialize variables */
     inFile = NULL;
-    fpIn = stdin;
+    socketName = NULL;
+    fdIn = STDIN_FILENO;
     outFile = NULL;
-    fpOut = stdout;
-    tabSize = DEFAULT_TAB;
-    keepTabs = 0;
+    fdOut = STDOUT_FILENO;
+    opts.tabSize = DEFAULT_TAB;
+    opts.tabStops = NULL;
+    tabStops.widths = NULL;
+    opts.keepTabs = 0;
+    opts.retab = RETAB_NONE;
+    opts.eol = EOL_KEEP;
+    opts.utf8 = 0;
+    opts.jobs = 1;
+    opts.pipeline = (PoolCpuCount() > 1);
+    opts.codec = CODEC_NONE;
+    opts.stats = NULL;
+    readList = 0;
+    jobsSet = 0;
+    diffMode = 0;
+    statsMode = STATS_NONE;
+    batchOpts.threads = 1;
+    batchOpts.recursive = 0;
+    batchOpts.include = NULL;
+    batchOpts.exclude = NULL;
+    batchOpts.inPlace = 0;
+    batchOpts.sync = 0;
+    batchOpts.check = 0;
+    batchOpts.list = 0;
+    batchOpts.uring = 0;
+    batchOpts.cache = NULL;
+    batchOpts.stats = NULL;
 
     /* parse command line */
-    optList = GetOptList(argc, argv, "t:ki:o:h?");
+    if (0 != ExpandLongOpts(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (0 != GetOptArena(argc, argv,
+        "t:T:kuUe:8j:p0rg:x:wFcalC:ds:S:i:o:h?", &optList))
+    {
+        perror("Memory allocation");
+        return EXIT_FAILURE;
+    }
+
+    files = GetFileArgs(argc, argv, optList, &fileCount);
+
+    if (NULL == files)
+    {
+        perror("Memory allocation");
+        FreeOptArena(optList);
+        return EXIT_FAILURE;
+    }
+
     thisOpt = optList;
 
     while (thisOpt != NULL)
@@ -93,193 +204,731 @@ int main(int argc, char *argv[])
         switch(thisOpt->option)
         {
             case 't':       /* tab size */
-                tabSize = atoi(thisOpt->argument);
+                tabSize = strtol(thisOpt->argument, &end, 10);
+
+                if ((end == thisOpt->argument) || ('\0' != *end) ||
+                    (tabSize < 1) || (tabSize > TRIMMER_MAX_TAB))
+                {
+                    fprintf(stderr, "Invalid tab size %s.\n",
+                        thisOpt->argument);
+                    free(files);
+                    FreeOptArena(optList);
+                    TabStopsFree(&tabStops);
+                    return EXIT_FAILURE;
+                }
+
+                opts.tabSize = (unsigned int)tabSize;
+                break;
+
+            case 'T':       /* list of tab stops */
+                TabStopsFree(&tabStops);
+
+                if (0 != TabStopsInit(&tabStops, thisOpt->argument))
+                {
+                    fprintf(stderr, "Invalid tab stops %s.\n",
+                        thisOpt->argument);
+                    free(files);
+                    FreeOptArena(optList);
+                    return EXIT_FAILURE;
+                }
+
+                opts.tabStops = &tabStops;
                 break;
 
             case 'k':       /* keep tabs; don't convert them to spaces */
-                keepTabs = 1;
+                opts.keepTabs = 1;
                 break;
 
-            case 'i':       /* input file name */
-                if (inFile != NULL)
-                {
-                    fprintf(stderr, "Multiple input files not allowed.\n");
-                    free(inFile);
+            case 'u':       /* leading whitespace to tabs and spaces */
+                opts.retab = RETAB_LEADING;
+                break;
 
-                    if (outFile != NULL)
-                    {
-                        free(outFile);
-                    }
+            case 'U':       /* all whitespace to tabs and spaces */
+                opts.retab = RETAB_ALL;
+                break;
 
-                    FreeOptList(optList);
-                    return EXIT_FAILURE;
+            case 'e':       /* line endings */
+                if (0 == strcmp(thisOpt->argument, "lf"))
+                {
+                    opts.eol = EOL_LF;
                 }
-                else if ((inFile =
-                    (char *)malloc(strlen(thisOpt->argument) + 1)) == NULL)
+                else if (0 == strcmp(thisOpt->argument, "crlf"))
                 {
-                    perror("Memory allocation");
-
-                    if (outFile != NULL)
-                    {
-                        free(outFile);
-                    }
-
-                    FreeOptList(optList);
+                    opts.eol = EOL_CRLF;
+                }
+                else if (0 == strcmp(thisOpt->argument, "auto"))
+                {
+                    opts.eol = EOL_AUTO;
+                }
+                else
+                {
+                    fprintf(stderr, "Invalid line endings %s.\n",
+                        thisOpt->argument);
+                    free(files);
+                    FreeOptArena(optList);
+                    TabStopsFree(&tabStops);
                     return EXIT_FAILURE;
                 }
+                break;
 
-                strcpy(inFile, thisOpt->argument);
+            case '8':       /* columns are UTF-8 display widths */
+                opts.utf8 = 1;
                 break;
 
-            case 'o':       /* output file name */
-                if (outFile != NULL)
+            case 'j':       /* number of threads trimming a large file */
+                opts.jobs = atoi(thisOpt->argument);
+
+                if (opts.jobs < 1)
                 {
-                    fprintf(stderr, "Multiple output files not allowed.\n");
-                    free(outFile);
+                    opts.jobs = 1;
+                }
+                else if (opts.jobs > MAX_JOBS)
+                {
+                    opts.jobs = MAX_JOBS;
+                }
+
+                jobsSet = 1;
+                break;
+
+            case 'p':       /* read, trim, and write on separate threads */
+                opts.pipeline = 1;
+                break;
+
+            case '0':       /* read NUL separated file names from stdin */
+                readList = 1;
+                break;
+
+            case 'r':       /* trim the files in named directory trees */
+                batchOpts.recursive = 1;
+                break;
+
+            case 'g':       /* globs of files to trim in directory trees */
+                batchOpts.include = thisOpt->argument;
+                break;
+
+            case 'x':       /* globs of names to skip in directory trees */
+                batchOpts.exclude = thisOpt->argument;
+                break;
+
+            case 'w':       /* write trimmed files back in place */
+                batchOpts.inPlace = 1;
+                break;
+
+            case 'F':       /* fsync files written in place */
+                batchOpts.sync = 1;
+                break;
 
-                    if (inFile != NULL)
-                    {
-                        free(inFile);
-                    }
+            case 'a':       /* load batches of small files with io_uring */
+                batchOpts.uring = 1;
+                break;
+
+            case 'c':       /* only check whether files would change */
+                batchOpts.check = 1;
+                break;
+
+            case 'l':       /* list where checked files would change */
+                batchOpts.check = 1;
+                batchOpts.list = 1;
+                break;
 
-                    FreeOptList(optList);
+            case 'C':       /* cache of files known to be clean */
+                batchOpts.cache = thisOpt->argument;
+                break;
+
+            case 'd':       /* only the lines added by a diff */
+                diffMode = 1;
+                break;
+
+            case 's':       /* report statistics */
+                if (0 == strcmp(thisOpt->argument, "text"))
+                {
+                    statsMode = STATS_TEXT;
+                }
+                else if (0 == strcmp(thisOpt->argument, "json"))
+                {
+                    statsMode = STATS_JSON;
+                }
+                else
+                {
+                    fprintf(stderr, "Invalid statistics format %s.\n",
+                        thisOpt->argument);
+                    free(files);
+                    FreeOptArena(optList);
+                    TabStopsFree(&tabStops);
                     return EXIT_FAILURE;
                 }
-                else if ((outFile =
-                    (char *)malloc(strlen(thisOpt->argument) + 1)) == NULL)
+                break;
+
+            case 'S':       /* serve requests on a Unix domain socket */
+                socketName = thisOpt->argument;
+                break;
+
+            case 'i':       /* input file name */
+                if (inFile != NULL)
                 {
-                    perror("Memory allocation");
+                    fprintf(stderr, "Multiple input files not allowed.\n");
+                    free(files);
+                    FreeOptArena(optList);
+                    TabStopsFree(&tabStops);
+                    return EXIT_FAILURE;
+                }
 
-                    if (inFile != NULL)
-                    {
-                        free(inFile);
-                    }
+                inFile = thisOpt->argument;
+                break;
 
-                    FreeOptList(optList);
+            case 'o':       /* output file name */
+                if (outFile != NULL)
+                {
+                    fprintf(stderr, "Multiple output files not allowed.\n");
+                    free(files);
+                    FreeOptArena(optList);
+                    TabStopsFree(&tabStops);
                     return EXIT_FAILURE;
                 }
 
-                strcpy(outFile, thisOpt->argument);
+                outFile = thisOpt->argument;
                 break;
 
             case 'h':
             case '?':
-                printf("Usage: %s <options>\n\n", RemovePath(argv[0]));
+                printf("Usage: %s <options> [file ...]\n\n",
+                    RemovePath(argv[0]));
                 printf("Options:\n");
-                printf("  -t : Tab size.\n");
+                printf("  -t : Tab size, from 1 to 65536.\n");
+                printf("  -T <list> : Tab stop columns (e.g. 8,12,20).  ");
+                printf("The last interval repeats.\n");
                 printf("  -k : Keep tabs.  Do not convert them to spaces.\n");
+                printf("  -u : Convert leading whitespace to tabs and ");
+                printf("spaces.\n");
+                printf("  -U : Convert all whitespace to tabs and spaces.\n");
+                printf("  -e | --eol <lf|crlf|auto> : End every line with ");
+                printf("LF, CRLF, or the most\n");
+                printf("                              common ending.\n");
+                printf("  -8 | --utf8 : Count columns of UTF-8 text by ");
+                printf("display width (CJK is 2).\n");
+                printf("  -j <n> : Trim a large input file with n threads,\n");
+                printf("           or trim n of multiple files at once.\n");
+                printf("  -p : Read, trim, and write streams on separate ");
+                printf("threads.\n");
+                printf("  -0 : Read NUL separated file names from stdin.\n");
+                printf("  -r : Trim all files in named directories.\n");
+                printf("  -g <globs> : With -r, only trim files matching ");
+                printf("globs (e.g. \"*.c,*.h\").\n");
+                printf("  -x <globs> : With -r, skip names matching globs ");
+                printf("(e.g. \".git\").\n");
+                printf("  -w : Trim files in place.  Clean files are ");
+                printf("not rewritten.\n");
+                printf("  -F : With -w, fsync rewritten files.\n");
+                printf("  -a | --uring : Open and read small files in ");
+                printf("batches with io_uring.\n");
+                printf("  -c | --check | --dry-run : Write nothing; fail if ");
+                printf("any file would change.\n");
+                printf("  -l | --list : Check, listing each tab and trailing ");
+                printf("space as file:line:col.\n");
+                printf("  -C | --cache <file> : With -c, -l, or -w, skip ");
+                printf("files known to be clean.\n");
+                printf("  -d | --diff : With -c, -l, or -w, only the lines ");
+                printf("added by the diff input.\n");
+                printf("  -s | --stats <text|json> : Report counts and ");
+                printf("times per file on stderr.\n");
+                printf("  -S | --serve <socket> : Serve trimming requests ");
+                printf("on a Unix domain socket.\n");
                 printf("  -i <filename> : Name of input file.\n");
-                printf("  -o <filename> : Name of output file.\n");
+                printf("  -o <filename> : Name of output file.  ");
+                printf("Compressed if it ends in .gz or .zst.\n");
                 printf("  -h | ?  : Print out command line options.\n\n");
                 printf("Default: %s -t4 -i stdin -o stdout\n",
                     RemovePath(argv[0]));
+                printf("Files named without -i are trimmed and written to ");
+                printf("the output in order.\n");
 
-                FreeOptList(optList);
+                free(files);
+                FreeOptArena(optList);
+                TabStopsFree(&tabStops);
                 return EXIT_SUCCESS;
         }
 
-        optList = thisOpt->next;
-        free(thisOpt);
-        thisOpt = optList;
+        thisOpt = thisOpt->next;
     }
 
-    /* open file to be trimmed */
-    if (NULL != inFile)
+    /* the list is one block; the names kept from it point into argv */
+    FreeOptArena(optList);
+
+    if (NULL != socketName)
     {
-        fpIn = fopen(inFile, "r");
-    }
+        /* every request names its own input and gets its own output */
+        if ((0 != fileCount) || readList || (NULL != inFile) ||
+            (NULL != outFile) || diffMode || batchOpts.inPlace ||
+            batchOpts.check || (STATS_NONE != statsMode))
+        {
+            fprintf(stderr, "Files, -i, -o, -c, -l, -w, -d, and -s not "
+                "allowed with -S.\n");
+            status = -1;
+        }
+        else
+        {
+            /* a client may hold a thread while it keeps a connection */
+            batchOpts.threads = jobsSet ? opts.jobs : PoolCpuCount();
+
+            if (!jobsSet && (batchOpts.threads < MIN_SERVE))
+            {
+                batchOpts.threads = MIN_SERVE;
+            }
 
-    free(inFile);
+            status = TrimServe(socketName, &opts, batchOpts.threads);
 
-    if (NULL == fpIn)
+            if (0 != status)
+            {
+                perror(socketName);
+            }
+        }
+
+        free(files);
+        TabStopsFree(&tabStops);
+        return (0 == status) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if ((STATS_NONE != statsMode) &&
+        (diffMode || batchOpts.inPlace || batchOpts.check))
     {
-        perror(inFile);
-        free(outFile);
+        /* only output that is written is counted */
+        fprintf(stderr, "Statistics not allowed with -c, -l, -w, or -d.\n");
+        free(files);
+        TabStopsFree(&tabStops);
         return EXIT_FAILURE;
     }
 
+    if (diffMode)
+    {
+        /* files and lines come from the diff; -i names the diff */
+        status = 0;
+
+        if ((0 != fileCount) || readList || batchOpts.recursive)
+        {
+            fprintf(stderr, "File names not allowed with -d.\n");
+            status = -1;
+        }
+        else if (batchOpts.inPlace == batchOpts.check)
+        {
+            fprintf(stderr, "Diff mode needs one of -c, -l, or -w.\n");
+            status = -1;
+        }
+        else if (batchOpts.inPlace && (NULL != outFile))
+        {
+            fprintf(stderr, "Output file not allowed with -w.\n");
+            status = -1;
+        }
+        else
+        {
+            status = RunDiff(inFile, outFile, &opts, &batchOpts);
+        }
+
+        free(files);
+        TabStopsFree(&tabStops);
+        return (0 == status) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (batchOpts.inPlace)
+    {
+        /* in place; -i is just one more file */
+        if (batchOpts.check)
+        {
+            fprintf(stderr, "Check not allowed with -w.\n");
+            free(files);
+            TabStopsFree(&tabStops);
+            return EXIT_FAILURE;
+        }
+
+        if (NULL != outFile)
+        {
+            fprintf(stderr, "Output file not allowed with -w.\n");
+            free(files);
+            TabStopsFree(&tabStops);
+            return EXIT_FAILURE;
+        }
+
+        if (NULL != inFile)
+        {
+            files[fileCount] = inFile;
+            fileCount++;
+        }
+        else if ((0 == fileCount) && !readList)
+        {
+            fprintf(stderr, "No files to trim in place.\n");
+            free(files);
+            TabStopsFree(&tabStops);
+            return EXIT_FAILURE;
+        }
+
+        batchOpts.threads = jobsSet ? opts.jobs : PoolCpuCount();
+        status = RunBatch(files, fileCount, readList, -1, &opts, &batchOpts);
+        free(files);
+        TabStopsFree(&tabStops);
+        return (0 == status) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if ((NULL != outFile) && !batchOpts.check)
+    {
+        /* the output file's extension picks its compression */
+        opts.codec = (unsigned int)CodecFromName(outFile);
+        status = 0;
+
+        if ((CODEC_NONE != opts.codec) && !CodecSupported((int)opts.codec))
+        {
+            fprintf(stderr, "%s: Compression not supported by this build.\n",
+                outFile);
+            status = -1;
+        }
+        else if ((CODEC_NONE != opts.codec) && ((0 != fileCount) || readList))
+        {
+            fprintf(stderr, "Compressed output needs a single input.\n");
+            status = -1;
+        }
+
+        if (0 != status)
+        {
+            free(files);
+            TabStopsFree(&tabStops);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ((0 != fileCount) || readList)
+    {
+        /* batch mode; the input files come from the command line or stdin */
+        if (NULL != inFile)
+        {
+            fprintf(stderr, "Multiple input files not allowed.\n");
+            free(files);
+            TabStopsFree(&tabStops);
+            return EXIT_FAILURE;
+        }
+
+        batchOpts.threads = jobsSet ? opts.jobs : PoolCpuCount();
+    }
+    else if (NULL != inFile)
+    {
+        /* open file to be trimmed */
+        fdIn = open(inFile, O_RDONLY);
+
+        if (fdIn < 0)
+        {
+            perror(inFile);
+            free(files);
+            TabStopsFree(&tabStops);
+            return EXIT_FAILURE;
+        }
+    }
+
     /* open output file */
     if (NULL != outFile)
     {
-        fpOut = fopen(outFile, "w");
+        fdOut = open(outFile, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+        if (fdOut < 0)
+        {
+            perror(outFile);
+            free(files);
+            close(fdIn);
+            TabStopsFree(&tabStops);
+            return EXIT_FAILURE;
+        }
     }
 
-    free(outFile);
+    if (STATS_NONE != statsMode)
+    {
+        StatsBegin(&statsReport, stderr, (STATS_JSON == statsMode));
+        memset(&stats, 0, sizeof(stats));
+        opts.stats = &stats;
+        batchOpts.stats = &statsReport;
+    }
 
-    if (NULL == fpOut)
+    if ((0 != fileCount) || readList)
     {
-        perror(outFile);
-        return EXIT_FAILURE;
+        /* errors are reported per file */
+        status = RunBatch(files, fileCount, readList, fdOut, &opts,
+            &batchOpts);
     }
+    else if (batchOpts.check)
+    {
+        /* the report, if any, is the only output */
+        status = CheckFd(fdIn, &opts, (NULL != inFile) ? inFile : "stdin",
+            batchOpts.list, &report, &reportLen, &changed);
 
-    pos = 0;
-    spaces = 0;
+        if (0 != status)
+        {
+            perror("trim");
+        }
+        else
+        {
+            if ((0 != reportLen) && (0 != WriteAll(fdOut, report, reportLen)))
+            {
+                perror("trim");
+                status = -1;
+            }
+            else if (changed)
+            {
+                status = 1;
+            }
+
+            free(report);
+        }
+    }
+    else
+    {
+        status = TrimFd(fdIn, fdOut, &opts);
 
-    /* copy file 1 character at a time, replacing tabs and trimming spaces */
-    while ((c = fgetc(fpIn)) != EOF)
+        if (0 != status)
+        {
+            perror("trim");
+        }
+        else if (STATS_NONE != statsMode)
+        {
+            StatsFile(&statsReport, (NULL != inFile) ? inFile : "stdin",
+                &stats);
+        }
+    }
+
+    if ((STATS_NONE != statsMode) && (0 != StatsEnd(&statsReport)) &&
+        (0 == status))
+    {
+        perror("Writing statistics");
+        status = -1;
+    }
+
+    free(files);
+
+    close(fdIn);
+
+    if (0 != close(fdOut) && 0 == status)
+    {
+        perror("trim");
+        status = -1;
+    }
+
+    TabStopsFree(&tabStops);
+
+    return (0 == status) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/****************************************************************************
+*   Function   : ExpandLongOpts
+*   Description: This function replaces each long option in the command
+*                line with the short option it stands for, so it can be
+*                parsed by GetOptArena.
+*   Parameters : argc - number of parameters
+*                argv - parameter list
+*   Effects    : Long options in argv are replaced.  Unknown long options
+*                are reported on stderr.
+*   Returned   : 0 for success, otherwise -1.
+****************************************************************************/
+static int ExpandLongOpts(int argc, char *argv[])
+{
+    const long_opt_t *opt;
+    int i;
+
+    for (i = 1; i < argc; i++)
     {
-        switch (c)
+        if (('-' != argv[i][0]) || ('-' != argv[i][1]))
         {
-            case '\n':
-            case '\r':
-                /* end of line (maybe other OS format) */
-                pos = 0;
-                spaces = 0;
-                fputc(c, fpOut);
-                break;
+            continue;
+        }
 
-            case '\t':
-                if (keepTabs)
-                {
-                    if (0 == spaces)
-                    {
-                        /* I could use the else clause, but this is faster */
-                        fputc('\t', fpOut);
-                    }
-                    else
-                    {
-                        /* write out leading spaces too */
-                        fprintf(fpOut, "%*c", spaces + 1, c);
-                        spaces = 0;
-                    }
-
-                    pos++;
-                }
-                else
-                {
-                    /* convert tab to spaces; compute width of tab */
-                    c = tabSize - (pos % tabSize);
-                    spaces += c;
-                    pos += c;
-                }
+        for (opt = longOpts; opt->name != NULL; opt++)
+        {
+            if (0 == strcmp(argv[i], opt->name))
+            {
                 break;
+            }
+        }
 
-            case ' ':
-                spaces++;
-                pos++;
-                break;
+        if (NULL == opt->name)
+        {
+            fprintf(stderr, "Unknown option %s.\n", argv[i]);
+            return -1;
+        }
 
-            default:
-                if (0 == spaces)
-                {
-                    /* I could use the else clause, but this is faster */
-                    fputc(c, fpOut);
-                }
-                else
-                {
-                    /* write out leading spaces too */
-                    fprintf(fpOut, "%*c", spaces + 1, c);
-                    spaces = 0;
-                }
+        argv[i] = opt->shortOpt;
+    }
 
-                pos++;
-                break;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : GetFileArgs
+*   Description: This function finds the command line arguments that are
+*                neither options nor the arguments of options.  These are
+*                the names of files to be trimmed in batch mode.
+*   Parameters : argc - number of parameters
+*                argv - parameter list
+*                optList - options parsed from argv by GetOptArena
+*                count - set to the number of file names found
+*   Effects    : None
+*   Returned   : malloc'd array of pointers to the file names in argv, or
+*                NULL if it can't be allocated.
+****************************************************************************/
+static char **GetFileArgs(int argc, char *argv[], const option_t *optList,
+    size_t *count)
+{
+    char **files;
+    const option_t *opt;
+    int i;
+
+    files = (char **)malloc(argc * sizeof(char *));
+    *count = 0;
+
+    if (NULL == files)
+    {
+        return NULL;
+    }
+
+    for (i = 1; i < argc; i++)
+    {
+        if (('-' == argv[i][0]) && ('\0' != argv[i][1]))
+        {
+            continue;       /* an option */
+        }
+
+        for (opt = optList; opt != NULL; opt = opt->next)
+        {
+            if ((opt->argIndex == i) && (opt->argument == argv[i]))
+            {
+                break;      /* an option's argument */
+            }
+        }
+
+        if (NULL == opt)
+        {
+            files[*count] = argv[i];
+            (*count)++;
+        }
+    }
+
+    return files;
+}
+
+/****************************************************************************
+*   Function   : RunBatch
+*   Description: This function trims the files named on the command line
+*                followed by any named in a NUL separated list on stdin.
+*   Parameters : args - file names from the command line
+*                argCount - number of names in args
+*                readList - non-zero if names should be read from stdin
+*                fdOut - descriptor the trimmed files are written to
+*                opts - trimming options
+*                batchOpts - thread count, recursion, and glob options
+*   Effects    : Trimmed copies of the files, or a check report, are
+*                written to fdOut.  Files that can't be trimmed are
+*                reported on stderr.
+*   Returned   : 0 if every file was trimmed, 1 if a checked file would
+*                change, otherwise -1.
+****************************************************************************/
+static int RunBatch(char **args, size_t argCount, int readList, int fdOut,
+    const trim_opts_t *opts, const batch_opts_t *batchOpts)
+{
+    char *listBuf, **list, **all;
+    size_t listCount;
+    int status;
+
+    if (!readList)
+    {
+        return TrimBatch(args, argCount, fdOut, opts, batchOpts);
+    }
+
+    if (0 != ReadFileList(STDIN_FILENO, &listBuf, &list, &listCount))
+    {
+        perror("Reading file list");
+        return -1;
+    }
+
+    all = (char **)malloc((argCount + listCount + 1) * sizeof(char *));
+
+    if (NULL == all)
+    {
+        perror("Memory allocation");
+        free(list);
+        free(listBuf);
+        return -1;
+    }
+
+    memcpy(all, args, argCount * sizeof(char *));
+    memcpy(all + argCount, list, listCount * sizeof(char *));
+    status = TrimBatch(all, argCount + listCount, fdOut, opts,
+        batchOpts);
+
+    free(all);
+    free(list);
+    free(listBuf);
+    return status;
+}
+
+/****************************************************************************
+*   Function   : RunDiff
+*   Description: This function reads a unified diff and checks or trims
+*                in place only the lines it adds to each file.  Names in
+*                the diff are relative to where it was made, so this is
+*                run from the same directory (the top of a git work tree).
+*   Parameters : inFile - name of the diff, or NULL for stdin
+*                outFile - name of the check report, or NULL for stdout
+*                opts - trimming options
+*                batchOpts - check, list, in place, and sync options
+*   Effects    : Files in the diff are trimmed in place, or a check report
+*                is written.  Files that can't be trimmed are reported on
+*                stderr.
+*   Returned   : 0 if every file was trimmed, 1 if a checked file would
+*                change, otherwise -1.
+****************************************************************************/
+static int RunDiff(const char *inFile, const char *outFile,
+    const trim_opts_t *opts, const batch_opts_t *batchOpts)
+{
+    diff_file_t *files;
+    size_t count;
+    int fdIn, fdOut, status;
+
+    fdIn = STDIN_FILENO;
+    fdOut = STDOUT_FILENO;
+
+    if ((NULL != inFile) && ((fdIn = open(inFile, O_RDONLY)) < 0))
+    {
+        perror(inFile);
+        return -1;
+    }
+
+    status = DiffRead(fdIn, &files, &count);
+
+    if (NULL != inFile)
+    {
+        close(fdIn);
+    }
+
+    if (0 != status)
+    {
+        perror("Reading diff");
+        return -1;
+    }
+
+    if (NULL != outFile)
+    {
+        fdOut = open(outFile, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+        if (fdOut < 0)
+        {
+            perror(outFile);
+            DiffFree(files, count);
+            return -1;
         }
     }
 
-    fclose(fpIn);
-    fclose(fpOut);
-    return EXIT_SUCCESS;
+    status = TrimDiff(files, count, fdOut, opts, batchOpts);
+    DiffFree(files, count);
+
+    if ((NULL != outFile) && (0 != close(fdOut)) && (0 == status))
+    {
+        perror(outFile);
+        status = -1;
+    }
+
+    return status;
 }
 
 /****************************************************************************
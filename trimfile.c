@@ -0,0 +1,2503 @@
+/***************************************************************************
+*                   Tab Remover and Trailing Space Trimmer
+*
+*   File    : trimfile.c
+*   Purpose : Trim a file descriptor using block reads, memory mapping, or
+*             a pool of threads
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#define _XOPEN_SOURCE 700      /* realpath() */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <pthread.h>
+#include "trimfile.h"
+#include "scan.h"
+#include "pipeline.h"
+#include "codec.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define BLOCK_SIZE  (256 * 1024)    /* bytes requested per read(2) */
+#define OUT_SIZE    (256 * 1024)    /* bytes buffered per write(2) */
+#define OUT_IOVS    64              /* spans gathered per writev(2) */
+#define ZC_MIN      512             /* shortest span written in place */
+
+#define CHUNK_SIZE  (4 * 1024 * 1024)   /* input per parallel work item */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef struct out_buf_t
+{
+    int fd;                     /* descriptor output is written to */
+    char *buf;                  /* output waiting to be written */
+    size_t used;                /* number of bytes in buf */
+    size_t size;                /* capacity of buf */
+    size_t spanStart;           /* start of buf not yet in iov */
+    int stable;                 /* input stays valid until flush (mmap) */
+    struct iovec iov[OUT_IOVS]; /* spans gathered for writev(2) */
+    int iovCount;               /* number of spans in iov */
+    uint64_t writeNs;           /* time spent writing the descriptor */
+} out_buf_t;
+
+/* output of one chunk trimmed by a worker thread (fd < 0, so it grows) */
+typedef struct chunk_slot_t
+{
+    out_buf_t out;              /* trimmed chunk */
+    int ready;                  /* non-zero once out holds the chunk */
+} chunk_slot_t;
+
+/* position of the check mode scanner, used to report changes */
+typedef struct check_state_t
+{
+    trimmer_t trim;             /* state machine; tracks pending spaces */
+    const char *name;           /* name of the file reported */
+    unsigned long line;         /* line number (1 based) */
+    unsigned long col;          /* byte column of the next character */
+    unsigned long wsLine;       /* line of the pending whitespace */
+    unsigned long wsCol;        /* column of the pending whitespace */
+    size_t wsReport;            /* length of the report when the pending
+                                 * whitespace started */
+    int afterCR;                /* the last character was a '\r' */
+    unsigned long crCol;        /* column of the last '\r' */
+    int mixed;                  /* a space came before a tab in whitespace
+                                 * being retabbed */
+    unsigned long found;        /* number of changes found */
+} check_state_t;
+
+/* a mapped file being trimmed in line aligned chunks by -j workers */
+typedef struct par_job_t
+{
+    const char *data;           /* the mapped file */
+    size_t len;                 /* length of the mapped file */
+    const trimmer_t *initial;   /* state at the start of every chunk */
+    pthread_mutex_t lock;       /* protects everything below */
+    pthread_cond_t cond;        /* signaled when any of it changes */
+    size_t nextStart;           /* start of the first unclaimed chunk */
+    unsigned long claimed;      /* number of chunks given to workers */
+    unsigned long written;      /* number of chunks written out */
+    unsigned int window;        /* number of slots */
+    chunk_slot_t *slots;        /* chunk n is held in slot n % window */
+    int failed;                 /* non-zero if a worker or write failed */
+    trim_stats_t stats;         /* counts of the chunks trimmed so far */
+} par_job_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static int TrimFdToBuf(int fdIn, out_buf_t *out, const trim_opts_t *opts);
+static ssize_t ReadFirst(int fd, char *buf, size_t len, size_t want);
+static int TrimDecoded(int fdIn, char *buf, const char *data, size_t len,
+    int format, trimmer_t *state, out_buf_t *out, uint64_t *readNs);
+static int RefuseCompressed(const char *data, size_t len);
+static void AddStats(const trim_opts_t *opts, const trimmer_t *state,
+    uint64_t start, uint64_t readNs, uint64_t writeNs);
+static int TrimMapped(int fdIn, size_t len, trimmer_t *state,
+    out_buf_t *out, unsigned int jobs);
+static int TrimMapping(const char *data, size_t len, trimmer_t *state,
+    out_buf_t *out, unsigned int jobs);
+static int ReplaceFile(const char *path, const struct stat *sb,
+    const char *data, size_t len, const line_range_t *ranges, size_t count,
+    const trim_opts_t *opts, int sync);
+static int TrimParallel(const char *data, size_t len, trimmer_t *state,
+    out_buf_t *out, unsigned int jobs);
+static void *ChunkWorker(void *arg);
+static size_t NextLineStart(const char *data, size_t from, size_t len);
+static const char *FindChange(trimmer_t *state, const char *buf,
+    size_t len);
+static int RetabChanges(const trimmer_t *state);
+static void CheckInit(check_state_t *check, const trim_opts_t *opts,
+    const char *name);
+static int CheckDone(check_state_t *check, int status, out_buf_t *out,
+    int list, char **report, size_t *reportLen, int *changed);
+static int CheckRanges(check_state_t *check, const char *data, size_t len,
+    const line_range_t *ranges, size_t count, out_buf_t *out);
+static int CheckBlock(check_state_t *check, const char *buf, size_t len,
+    out_buf_t *out);
+static int CheckReport(check_state_t *check, unsigned long line,
+    unsigned long col, const char *what, out_buf_t *out);
+static int CheckTrailing(check_state_t *check, out_buf_t *out);
+static void Reverse(char *start, char *end);
+
+static int OutInit(out_buf_t *out, int fd);
+static int OutWrite(out_buf_t *out, const char *data, size_t len);
+static int OutSink(void *context, const char *data, size_t len);
+static int OutFlush(out_buf_t *out);
+static int OutReserve(out_buf_t *out, size_t len);
+static int OutAddSpan(out_buf_t *out, const char *data, size_t len);
+static int WriteAllV(int fd, struct iovec *iov, int count);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : TrimFd
+*   Description: This function trims everything read from one descriptor
+*                and writes the result to another, using an output buffer
+*                that is written out in large blocks.  Streams that aren't
+*                regular files are handed to the pipeline when it's
+*                requested.  Compressed input, and output that is to be
+*                compressed, always go through the pipeline.
+*   Parameters : fdIn - descriptor of the file to be trimmed
+*                fdOut - descriptor the trimmed file is written to
+*                opts - trimming options
+*   Effects    : Writes version of input file with tabs expanded and
+*                trailing spaces removed.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+int TrimFd(int fdIn, int fdOut, const trim_opts_t *opts)
+{
+    out_buf_t out;
+    struct stat sb;
+    char magic[CODEC_MAGIC];
+    ssize_t got;
+    uint64_t written;
+    int piped, status;
+
+    if ((fdOut >= 0) && (0 == fstat(fdIn, &sb)))
+    {
+        if (S_ISREG(sb.st_mode))
+        {
+            got = pread(fdIn, magic, CODEC_MAGIC, 0);
+            piped = (got > 0) &&
+                (CODEC_NONE != CodecFromMagic(magic, (size_t)got));
+        }
+        else
+        {
+            piped = opts->pipeline;
+        }
+
+        if (piped || (CODEC_NONE != opts->codec))
+        {
+            status = TrimPipeline(fdIn, fdOut, opts, NULL, 0);
+
+            if (1 != status)
+            {
+                return status;
+            }
+
+            if (S_ISREG(sb.st_mode) && piped)
+            {
+                /* it can't be decompressed without the threads */
+                errno = EAGAIN;
+                return -1;
+            }
+
+            /* the threads didn't start; trim it here */
+        }
+    }
+
+    if (0 != OutInit(&out, fdOut))
+    {
+        return -1;
+    }
+
+    status = TrimFdToBuf(fdIn, &out, opts);
+    written = out.writeNs;
+
+    if ((0 == status) && (0 != OutFlush(&out)))
+    {
+        status = -1;
+    }
+
+    if (NULL != opts->stats)
+    {
+        /* TrimFdToBuf counted what it wrote itself */
+        opts->stats->writeNs += out.writeNs - written;
+    }
+
+    free(out.buf);
+    return status;
+}
+
+/****************************************************************************
+*   Function   : TrimFdToMemory
+*   Description: This function trims everything read from a descriptor
+*                into a buffer allocated with malloc.
+*   Parameters : fdIn - descriptor of the file to be trimmed
+*                opts - trimming options
+*                buf - set to the trimmed output.  It may be NULL if the
+*                      output is empty.
+*                len - set to the number of bytes in *buf
+*   Effects    : Allocates a buffer holding the trimmed file.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+*
+*   NOTE: The caller is responsible for freeing *buf.
+****************************************************************************/
+int TrimFdToMemory(int fdIn, const trim_opts_t *opts, char **buf,
+    size_t *len)
+{
+    out_buf_t out;
+    struct stat sb;
+
+    (void)OutInit(&out, -1);
+
+    /* the output is usually about the size of the input */
+    if ((0 == fstat(fdIn, &sb)) && S_ISREG(sb.st_mode) && (sb.st_size > 0) &&
+        ((off_t)(size_t)sb.st_size == sb.st_size))
+    {
+        if (0 != OutReserve(&out, (size_t)sb.st_size))
+        {
+            return -1;
+        }
+    }
+
+    if (0 != TrimFdToBuf(fdIn, &out, opts))
+    {
+        free(out.buf);
+        return -1;
+    }
+
+    *buf = out.buf;
+    *len = out.used;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : TrimMemory
+*   Description: This function trims a file that has already been read
+*                into memory into a buffer allocated with malloc.
+*   Parameters : data - contents of the file to be trimmed
+*                dataLen - length of data
+*                opts - trimming options
+*                buf - set to the trimmed output.  It may be NULL if the
+*                      output is empty.
+*                len - set to the number of bytes in *buf
+*   Effects    : Allocates a buffer holding the trimmed file.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+*
+*   NOTE: The caller is responsible for freeing *buf.
+****************************************************************************/
+int TrimMemory(const char *data, size_t dataLen, const trim_opts_t *opts,
+    char **buf, size_t *len)
+{
+    out_buf_t out;
+    trimmer_t state;
+    uint64_t start, readNs;
+    int format, status;
+
+    (void)OutInit(&out, -1);
+
+    if ((0 != dataLen) && (0 != OutReserve(&out, dataLen)))
+    {
+        return -1;
+    }
+
+    start = TrimClock();
+    readNs = 0;
+    TrimmerInit(&state, opts);
+    format = CodecFromMagic(data, dataLen);
+
+    if (CODEC_NONE != format)
+    {
+        status = TrimDecoded(-1, NULL, data, dataLen, format, &state, &out,
+            &readNs);
+    }
+    else
+    {
+        status = TrimMapping(data, dataLen, &state, &out, 1);
+    }
+
+    if (0 != status)
+    {
+        free(out.buf);
+        return -1;
+    }
+
+    AddStats(opts, &state, start, readNs, 0);
+    *buf = out.buf;
+    *len = out.used;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : CheckFd
+*   Description: This function determines whether trimming would change a
+*                file without writing anything.  If only the answer is
+*                needed, the scan stops at the first byte that would
+*                change.  Otherwise the whole file is scanned, and a report
+*                line of the form "name:line:column: what" is made for each
+*                tab that would be expanded and each run of trailing
+*                whitespace.
+*   Parameters : fdIn - descriptor of the file to check
+*                opts - trimming options
+*                name - name of the file used in the report
+*                list - non-zero to build a report of every change
+*                report - set to a malloc'd report, or NULL if there is
+*                         nothing to report
+*                reportLen - set to the length of the report
+*                changed - set to 1 if trimming would change the file,
+*                          otherwise 0
+*   Effects    : Reads some or all of fdIn.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+*
+*   NOTE: The caller is responsible for freeing *report.
+****************************************************************************/
+int CheckFd(int fdIn, const trim_opts_t *opts, const char *name, int list,
+    char **report, size_t *reportLen, int *changed)
+{
+    check_state_t check;
+    out_buf_t out, *pOut;
+    struct stat sb;
+    void *map;
+    char *inBuf;
+    ssize_t got;
+    int first, status;
+
+    *report = NULL;
+    *reportLen = 0;
+    *changed = 0;
+
+    CheckInit(&check, opts, name);
+    (void)OutInit(&out, -1);
+    pOut = list ? &out : NULL;
+    status = 0;
+    map = MAP_FAILED;
+
+    if ((0 == fstat(fdIn, &sb)) && S_ISREG(sb.st_mode) && (sb.st_size > 0) &&
+        ((off_t)(size_t)sb.st_size == sb.st_size))
+    {
+        map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fdIn,
+            0);
+    }
+
+    if (MAP_FAILED != map)
+    {
+        (void)posix_madvise(map, (size_t)sb.st_size, POSIX_MADV_SEQUENTIAL);
+        status = RefuseCompressed((const char *)map, (size_t)sb.st_size);
+
+        if (0 == status)
+        {
+            status = CheckBlock(&check, (const char *)map,
+                (size_t)sb.st_size, pOut);
+        }
+
+        munmap(map, (size_t)sb.st_size);
+    }
+    else
+    {
+        inBuf = (char *)malloc(BLOCK_SIZE);
+
+        if (NULL == inBuf)
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+
+        /* stop reading at the first change unless they're all wanted */
+        first = 1;
+
+        while ((0 == status) && (list || (0 == check.found)))
+        {
+            if (first)
+            {
+                /* the format is found from whole magic bytes, and -e auto
+                 * picks endings from a whole sample */
+                got = ReadFirst(fdIn, inBuf, BLOCK_SIZE,
+                    (EOL_AUTO == opts->eol) ? TRIMMER_EOL_SAMPLE :
+                    CODEC_MAGIC);
+                first = 0;
+
+                if ((got > 0) && (0 != RefuseCompressed(inBuf, (size_t)got)))
+                {
+                    status = -1;
+                    continue;
+                }
+            }
+            else
+            {
+                got = read(fdIn, inBuf, BLOCK_SIZE);
+            }
+
+            if (got < 0)
+            {
+                if (EINTR != errno)
+                {
+                    status = -1;
+                }
+
+                continue;
+            }
+
+            if (0 == got)
+            {
+                break;
+            }
+
+            status = CheckBlock(&check, inBuf, (size_t)got, pOut);
+        }
+
+        free(inBuf);
+    }
+
+    return CheckDone(&check, status, &out, list, report, reportLen, changed);
+}
+
+/****************************************************************************
+*   Function   : CheckMemory
+*   Description: This function is CheckFd for a file that has already
+*                been read into memory.
+*   Parameters : data - contents of the file to check
+*                dataLen - length of data
+*                opts - trimming options
+*                name - name of the file used in the report
+*                list - non-zero to build a report of every change
+*                report - set to a malloc'd report, or NULL if there is
+*                         nothing to report
+*                reportLen - set to the length of the report
+*                changed - set to 1 if trimming would change the file,
+*                          otherwise 0
+*   Effects    : None
+*   Returned   : 0 for success, otherwise -1 with errno set.
+*
+*   NOTE: The caller is responsible for freeing *report.
+****************************************************************************/
+int CheckMemory(const char *data, size_t dataLen, const trim_opts_t *opts,
+    const char *name, int list, char **report, size_t *reportLen,
+    int *changed)
+{
+    check_state_t check;
+    out_buf_t out;
+    int status;
+
+    CheckInit(&check, opts, name);
+    (void)OutInit(&out, -1);
+    status = RefuseCompressed(data, dataLen);
+
+    if (0 == status)
+    {
+        status = CheckBlock(&check, data, dataLen, list ? &out : NULL);
+    }
+
+    return CheckDone(&check, status, &out, list, report, reportLen, changed);
+}
+
+/****************************************************************************
+*   Function   : CheckFileLines
+*   Description: This function is CheckFd for only some lines of a named
+*                file, such as the lines a change added.  The lines between
+*                ranges are skipped by searching for line feeds, without
+*                going through the state machine.
+*   Parameters : path - name of the file to check, also used in the report
+*                ranges - lines to check, in increasing order
+*                count - number of ranges
+*                opts - trimming options
+*                list - non-zero to build a report of every change
+*                report - set to a malloc'd report, or NULL if there is
+*                         nothing to report
+*                reportLen - set to the length of the report
+*                changed - set to 1 if trimming the lines would change the
+*                          file, otherwise 0
+*   Effects    : Reads the file.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+*
+*   NOTE: The caller is responsible for freeing *report.
+****************************************************************************/
+int CheckFileLines(const char *path, const line_range_t *ranges,
+    size_t count, const trim_opts_t *opts, int list, char **report,
+    size_t *reportLen, int *changed)
+{
+    check_state_t check;
+    out_buf_t out;
+    struct stat sb;
+    void *map;
+    int fd, status, err;
+
+    *report = NULL;
+    *reportLen = 0;
+    *changed = 0;
+
+    fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (0 != fstat(fd, &sb))
+    {
+        err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    if (!S_ISREG(sb.st_mode) || ((off_t)(size_t)sb.st_size != sb.st_size))
+    {
+        close(fd);
+        errno = S_ISDIR(sb.st_mode) ? EISDIR : EINVAL;
+        return -1;
+    }
+
+    CheckInit(&check, opts, path);
+    (void)OutInit(&out, -1);
+    status = 0;
+
+    if (0 != sb.st_size)
+    {
+        map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (MAP_FAILED == map)
+        {
+            err = errno;
+            close(fd);
+            errno = err;
+            return -1;
+        }
+
+        status = RefuseCompressed((const char *)map, (size_t)sb.st_size);
+
+        if (0 == status)
+        {
+            status = CheckRanges(&check, (const char *)map,
+                (size_t)sb.st_size, ranges, count, list ? &out : NULL);
+        }
+
+        munmap(map, (size_t)sb.st_size);
+    }
+
+    close(fd);
+    return CheckDone(&check, status, &out, list, report, reportLen, changed);
+}
+
+/****************************************************************************
+*   Function   : CheckInit
+*   Description: This function initializes the state of a check.
+*   Parameters : check - state to initialize
+*                opts - trimming options
+*                name - name of the file used in the report
+*   Effects    : check is ready to be passed to CheckBlock.
+*   Returned   : None
+****************************************************************************/
+static void CheckInit(check_state_t *check, const trim_opts_t *opts,
+    const char *name)
+{
+    TrimmerInit(&check->trim, opts);
+    check->name = name;
+    check->line = 1;
+    check->col = 0;
+    check->wsLine = 0;
+    check->wsCol = 0;
+    check->wsReport = 0;
+    check->afterCR = 0;
+    check->crCol = 0;
+    check->mixed = 0;
+    check->found = 0;
+}
+
+/****************************************************************************
+*   Function   : CheckDone
+*   Description: This function finishes a check once the whole file (or
+*                enough of it) has been passed to CheckBlock, reporting
+*                whitespace at the end of a file without a line ending,
+*                and a lone CR ending the file that would become CRLF.
+*   Parameters : check - state of the check
+*                status - result of the CheckBlock calls
+*                out - memory only buffer holding the report
+*                list - non-zero if a report of every change is wanted
+*                report - set to out's malloc'd report, or NULL
+*                reportLen - set to the length of the report
+*                changed - set to 1 if trimming would change the file,
+*                          otherwise 0
+*   Effects    : out's buffer is handed to report or freed.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int CheckDone(check_state_t *check, int status, out_buf_t *out,
+    int list, char **report, size_t *reportLen, int *changed)
+{
+    *report = NULL;
+    *reportLen = 0;
+    *changed = 0;
+
+    if ((0 == status) && (0 != check->trim.spaces) &&
+        (list || (0 == check->found)))
+    {
+        /* whitespace at the end of the file without a line ending */
+        status = CheckTrailing(check, list ? out : NULL);
+    }
+
+    if ((0 == status) && check->trim.cr && (list || (0 == check->found)))
+    {
+        status = CheckReport(check, check->line - 1, check->crCol,
+            "line ending", list ? out : NULL);
+    }
+
+    if (0 != status)
+    {
+        free(out->buf);
+        return -1;
+    }
+
+    *report = out->buf;
+    *reportLen = out->used;
+    *changed = (0 != check->found);
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : TrimFileInPlace
+*   Description: This function trims a regular file in place.  The file is
+*                first scanned for anything that trimming would change, and
+*                a file that is already clean is left alone: it isn't
+*                written, renamed, or touched.  Otherwise the trimmed copy
+*                is written to a temporary file in the same directory,
+*                given the original's mode and ownership, optionally
+*                synced, and renamed over the original.  Symbolic links
+*                are followed, so the file they point to is replaced.
+*   Parameters : path - name of the file to trim
+*                opts - trimming options
+*                sync - non-zero to fsync the new file and its directory
+*                       before and after the rename
+*                changed - set to 1 if the file was rewritten, otherwise 0
+*   Effects    : The file may be replaced by a trimmed version of itself.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+int TrimFileInPlace(const char *path, const trim_opts_t *opts, int sync,
+    int *changed)
+{
+    return TrimFileLinesInPlace(path, NULL, 0, opts, sync, changed);
+}
+
+/****************************************************************************
+*   Function   : TrimFileLinesInPlace
+*   Description: This function is TrimFileInPlace, but only the lines in
+*                ranges are trimmed.  The rest of the file is copied as is.
+*   Parameters : path - name of the file to trim
+*                ranges - lines to trim in increasing order, or NULL to
+*                         trim the whole file
+*                count - number of ranges
+*                opts - trimming options
+*                sync - non-zero to fsync the new file and its directory
+*                       before and after the rename
+*                changed - set to 1 if the file was rewritten, otherwise 0
+*   Effects    : The file may be replaced by a trimmed version of itself.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+int TrimFileLinesInPlace(const char *path, const line_range_t *ranges,
+    size_t count, const trim_opts_t *opts, int sync, int *changed)
+{
+    trimmer_t state;
+    check_state_t check;
+    struct stat sb;
+    char *realPath;
+    void *map;
+    int fd, status, err, clean;
+
+    *changed = 0;
+    realPath = realpath(path, NULL);
+
+    if (NULL == realPath)
+    {
+        return -1;
+    }
+
+    fd = open(realPath, O_RDONLY);
+
+    if (fd < 0)
+    {
+        err = errno;
+        free(realPath);
+        errno = err;
+        return -1;
+    }
+
+    if (0 != fstat(fd, &sb))
+    {
+        err = errno;
+        close(fd);
+        free(realPath);
+        errno = err;
+        return -1;
+    }
+
+    if (!S_ISREG(sb.st_mode) || ((off_t)(size_t)sb.st_size != sb.st_size))
+    {
+        close(fd);
+        free(realPath);
+        errno = S_ISDIR(sb.st_mode) ? EISDIR : EINVAL;
+        return -1;
+    }
+
+    if (0 == sb.st_size)
+    {
+        /* nothing to trim */
+        close(fd);
+        free(realPath);
+        return 0;
+    }
+
+    map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    err = errno;
+    close(fd);
+
+    if (MAP_FAILED == map)
+    {
+        free(realPath);
+        errno = err;
+        return -1;
+    }
+
+    (void)posix_madvise(map, (size_t)sb.st_size, POSIX_MADV_SEQUENTIAL);
+    TrimmerInit(&state, opts);
+
+    if (0 != RefuseCompressed((const char *)map, (size_t)sb.st_size))
+    {
+        /* trimming its bytes as text would corrupt it */
+        munmap(map, (size_t)sb.st_size);
+        free(realPath);
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    if (NULL != ranges)
+    {
+        CheckInit(&check, opts, path);
+        status = CheckRanges(&check, (const char *)map, (size_t)sb.st_size,
+            ranges, count, NULL);
+        clean = (0 == status) && (0 == check.found) &&
+            (0 == check.trim.spaces) && !check.trim.cr;
+    }
+    else
+    {
+        clean = (NULL == FindChange(&state, (const char *)map,
+            (size_t)sb.st_size)) && (0 == state.spaces) && !state.cr;
+    }
+
+    if (clean)
+    {
+        /* already clean */
+        status = 0;
+    }
+    else
+    {
+        status = ReplaceFile(realPath, &sb, (const char *)map,
+            (size_t)sb.st_size, ranges, count, opts, sync);
+        *changed = (0 == status);
+    }
+
+    err = errno;
+    munmap(map, (size_t)sb.st_size);
+    free(realPath);
+    errno = err;
+    return status;
+}
+
+/****************************************************************************
+*   Function   : ReplaceFile
+*   Description: This function writes a trimmed copy of a mapped file to a
+*                temporary file in the same directory and renames it over
+*                the original.  The temporary file is removed if anything
+*                fails.
+*   Parameters : path - name of the file being replaced (no symbolic links)
+*                sb - status of the file being replaced
+*                data - the file mapped into memory
+*                len - length of the file
+*                ranges - lines to trim, or NULL to trim the whole file
+*                count - number of ranges
+*                opts - trimming options
+*                sync - non-zero to fsync the new file and its directory
+*   Effects    : path is replaced by a trimmed version of itself.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int ReplaceFile(const char *path, const struct stat *sb,
+    const char *data, size_t len, const line_range_t *ranges, size_t count,
+    const trim_opts_t *opts, int sync)
+{
+    trimmer_t state;
+    out_buf_t out;
+    char *tmpName, *slash;
+    size_t pathLen;
+    int fd, status, err;
+
+    pathLen = strlen(path);
+    tmpName = (char *)malloc(pathLen + sizeof(".trim.XXXXXX") + 1);
+
+    if (NULL == tmpName)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    /* <dir>/.<name>.trim.XXXXXX keeps the temporary file hidden */
+    slash = strrchr(path, '/');
+    pathLen = (NULL == slash) ? 0 : (size_t)(slash - path) + 1;
+    memcpy(tmpName, path, pathLen);
+    sprintf(tmpName + pathLen, ".%s.trim.XXXXXX", path + pathLen);
+
+    fd = mkstemp(tmpName);
+
+    if (fd < 0)
+    {
+        err = errno;
+        free(tmpName);
+        errno = err;
+        return -1;
+    }
+
+    status = OutInit(&out, fd);
+
+    if ((0 == status) && (NULL != ranges))
+    {
+        /* untouched lines are written straight from the mapping */
+        TrimmerInit(&state, opts);
+        out.stable = 1;
+        status = TrimmerFeedRanges(&state, data, len, ranges, count,
+            OutSink, &out);
+        TrimmerFree(&state);
+
+        if (0 == status)
+        {
+            status = OutFlush(&out);
+        }
+
+        free(out.buf);
+    }
+    else if (0 == status)
+    {
+        TrimmerInit(&state, opts);
+        status = TrimMapping(data, len, &state, &out, opts->jobs);
+        free(out.buf);
+    }
+
+    /* keep the original's permissions; ownership only if we're allowed */
+    if ((0 == status) && (0 != fchmod(fd, sb->st_mode & 07777)))
+    {
+        status = -1;
+    }
+
+    if (0 == status)
+    {
+        (void)fchown(fd, sb->st_uid, sb->st_gid);
+    }
+
+    if ((0 == status) && sync && (0 != fsync(fd)))
+    {
+        status = -1;
+    }
+
+    err = errno;
+
+    if ((0 != close(fd)) && (0 == status))
+    {
+        err = errno;
+        status = -1;
+    }
+
+    if ((0 == status) && (0 != rename(tmpName, path)))
+    {
+        err = errno;
+        status = -1;
+    }
+
+    if (0 != status)
+    {
+        unlink(tmpName);
+    }
+    else if (sync)
+    {
+        /* make the rename itself durable */
+        tmpName[pathLen] = '\0';
+        fd = open((0 == pathLen) ? "." : tmpName, O_RDONLY);
+
+        if (fd >= 0)
+        {
+            (void)fsync(fd);
+            close(fd);
+        }
+    }
+
+    free(tmpName);
+    errno = err;
+    return status;
+}
+
+/****************************************************************************
+*   Function   : TrimFdToBuf
+*   Description: This function reads the input file in large blocks and
+*                runs each block through the tab expansion and trimming
+*                state machine.  The state is carried from one block to
+*                the next so lines and whitespace runs split across blocks
+*                are handled the same as any other.  Regular files are
+*                memory mapped instead of read, pipes and terminals are
+*                always read, and so are compressed files.  A stream that
+*                turns out to be compressed is handed to the pipeline to
+*                be decompressed if out writes to a descriptor, and is
+*                decompressed by TrimDecoded if out is only memory.
+*   Parameters : fdIn - descriptor of the file to be trimmed
+*                out - output buffer the trimmed file is written to
+*                opts - trimming options
+*   Effects    : Writes version of input file with tabs expanded and
+*                trailing spaces removed to out.  Some of it may still be
+*                buffered in out when this function returns.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int TrimFdToBuf(int fdIn, out_buf_t *out, const trim_opts_t *opts)
+{
+    trimmer_t state;
+    char *inBuf;
+    ssize_t got;
+    int first, status;
+    struct stat sb;
+    uint64_t start, readNs, now;
+    char magic[CODEC_MAGIC];
+    int format;
+
+    start = TrimClock();
+    readNs = 0;
+    TrimmerInit(&state, opts);
+
+    /* a compressed file is read, to be decompressed as it is */
+    if ((0 == fstat(fdIn, &sb)) && S_ISREG(sb.st_mode) && (sb.st_size > 0) &&
+        ((off_t)(size_t)sb.st_size == sb.st_size) &&
+        ((got = pread(fdIn, magic, CODEC_MAGIC, 0)) > 0) &&
+        (CODEC_NONE == CodecFromMagic(magic, (size_t)got)))
+    {
+        status = TrimMapped(fdIn, (size_t)sb.st_size, &state, out,
+            opts->jobs);
+
+        if (1 != status)
+        {
+            /* a mapping is read as it's trimmed */
+            AddStats(opts, &state, start, 0, out->writeNs);
+            return status;
+        }
+
+        /* the file can't be mapped; read it instead */
+    }
+
+    inBuf = (char *)malloc(BLOCK_SIZE);
+
+    if (NULL == inBuf)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    status = 0;
+
+    first = 1;
+
+    for (;;)
+    {
+        now = TrimClock();
+
+        if (first)
+        {
+            /* the format is found from whole magic bytes, and -e auto
+             * picks endings from a whole sample */
+            got = ReadFirst(fdIn, inBuf, BLOCK_SIZE,
+                (EOL_AUTO == opts->eol) ? TRIMMER_EOL_SAMPLE : CODEC_MAGIC);
+        }
+        else
+        {
+            got = read(fdIn, inBuf, BLOCK_SIZE);
+        }
+
+        readNs += TrimClock() - now;
+
+        if (got < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            status = -1;
+            break;
+        }
+
+        if (0 == got)
+        {
+            /* end of file; any pending whitespace is trailing */
+            status = TrimmerFinish(&state, OutSink, out);
+            AddStats(opts, &state, start, readNs, out->writeNs);
+            break;
+        }
+
+        format = first ? CodecFromMagic(inBuf, (size_t)got) : CODEC_NONE;
+
+        if ((CODEC_NONE != format) && (out->fd >= 0))
+        {
+            /* nothing has been written to out yet; the pipeline counts
+             * the stream itself */
+            status = TrimPipeline(fdIn, out->fd, opts, inBuf, (size_t)got);
+            break;
+        }
+
+        if (CODEC_NONE != format)
+        {
+            /* memory output is decompressed here, without the threads */
+            status = TrimDecoded(fdIn, inBuf, inBuf, (size_t)got, format,
+                &state, out, &readNs);
+
+            if (0 == status)
+            {
+                AddStats(opts, &state, start, readNs, out->writeNs);
+            }
+
+            break;
+        }
+
+        first = 0;
+
+        if (0 != TrimmerFeed(&state, inBuf, (size_t)got, OutSink, out))
+        {
+            status = -1;
+            break;
+        }
+    }
+
+    /* a stream given up part way may hold kept whitespace */
+    TrimmerFree(&state);
+    free(inBuf);
+    return status;
+}
+
+/****************************************************************************
+*   Function   : ReadFirst
+*   Description: This function reads the start of a stream, reading again
+*                until there are at least want bytes, so that decisions
+*                made from the first block don't depend on how a pipe or
+*                terminal happened to split the stream.
+*   Parameters : fd - descriptor to read
+*                buf - buffer to read into
+*                len - size of buf
+*                want - bytes wanted, no more than len
+*   Effects    : Reads fd.
+*   Returned   : Number of bytes read, which is less than want only at end
+*                of file, or -1 with errno set.
+****************************************************************************/
+static ssize_t ReadFirst(int fd, char *buf, size_t len, size_t want)
+{
+    size_t have;
+    ssize_t got;
+
+    have = 0;
+
+    while (have < want)
+    {
+        got = read(fd, buf + have, len - have);
+
+        if (got < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            return -1;
+        }
+
+        if (0 == got)
+        {
+            break;
+        }
+
+        have += (size_t)got;
+    }
+
+    return (ssize_t)have;
+}
+
+/****************************************************************************
+*   Function   : TrimDecoded
+*   Description: This function decompresses a stream and trims it on the
+*                calling thread, for output that goes to memory and so
+*                gains nothing from the pipeline.  Decompressed bytes are
+*                gathered into blocks of BLOCK_SIZE, so the first block
+*                holds all of -e auto's sample.  Members or frames that
+*                follow one another are one stream.
+*   Parameters : fdIn - descriptor the rest of the stream is read from, or
+*                       -1 if data is all of it
+*                buf - buffer of BLOCK_SIZE bytes the rest of the stream
+*                      is read into, which may be data; unused without fdIn
+*                data - the start of the compressed stream
+*                len - number of bytes in data
+*                format - format of the stream, from CodecFromMagic
+*                state - initialized trimming state
+*                out - output buffer the trimmed stream is written to
+*                readNs - time spent reading and decompressing is added
+*   Effects    : Reads fdIn, and writes the trimmed stream to out.
+*                Corrupt or cut off input is an error (EBADMSG).
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int TrimDecoded(int fdIn, char *buf, const char *data, size_t len,
+    int format, trimmer_t *state, out_buf_t *out, uint64_t *readNs)
+{
+    codec_t *decoder;
+    char *plain;
+    size_t used, made;
+    ssize_t got;
+    uint64_t now;
+    int eof, status, err;
+
+    decoder = CodecNew(format, 0);
+
+    if (NULL == decoder)
+    {
+        return -1;
+    }
+
+    plain = (char *)malloc(BLOCK_SIZE);
+
+    if (NULL == plain)
+    {
+        CodecFree(decoder);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    used = 0;
+    eof = (fdIn < 0);
+
+    for (;;)
+    {
+        now = TrimClock();
+        status = CodecRun(decoder, &data, &len, plain + used,
+            BLOCK_SIZE - used, &made, eof);
+        *readNs += TrimClock() - now;
+        used += made;
+
+        if (status < 0)
+        {
+            break;
+        }
+
+        if (((1 == status) || (BLOCK_SIZE == used)) && (0 != used))
+        {
+            if (0 != TrimmerFeed(state, plain, used, OutSink, out))
+            {
+                status = -1;
+                break;
+            }
+
+            used = 0;
+        }
+
+        if (1 == status)
+        {
+            status = TrimmerFinish(state, OutSink, out);
+            break;
+        }
+
+        if ((0 == len) && !eof)
+        {
+            now = TrimClock();
+            got = read(fdIn, buf, BLOCK_SIZE);
+            *readNs += TrimClock() - now;
+
+            if (got < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+
+                status = -1;
+                break;
+            }
+
+            data = buf;
+            len = (size_t)got;
+            eof = (0 == got);
+        }
+    }
+
+    err = errno;
+    TrimmerFree(state);
+    free(plain);
+    CodecFree(decoder);
+    errno = err;
+    return (0 == status) ? 0 : -1;
+}
+
+/****************************************************************************
+*   Function   : RefuseCompressed
+*   Description: This function refuses a file that starts with the magic
+*                bytes of a compressed format, for the checks and in place
+*                trims that only work on text.  Their bytes would be
+*                checked or rewritten as if they were text, corrupting a
+*                file trimmed in place.
+*   Parameters : data - start of the file
+*                len - number of bytes in data
+*   Effects    : None
+*   Returned   : 0 if data isn't compressed, otherwise -1 with errno set
+*                to ENOTSUP.
+****************************************************************************/
+static int RefuseCompressed(const char *data, size_t len)
+{
+    if (CODEC_NONE != CodecFromMagic(data, len))
+    {
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : AddStats
+*   Description: This function adds the counts of a finished stream and
+*                the time it took to the statistics opts asks for.  Time
+*                not spent reading or writing is trimming time.
+*   Parameters : opts - trimming options; nothing is done if opts->stats
+*                       is NULL
+*                state - trimmer that trimmed the stream
+*                start - TrimClock() when the stream was started
+*                readNs - time spent reading the stream
+*                writeNs - time spent writing the stream
+*   Effects    : *opts->stats is updated.
+*   Returned   : None
+****************************************************************************/
+static void AddStats(const trim_opts_t *opts, const trimmer_t *state,
+    uint64_t start, uint64_t readNs, uint64_t writeNs)
+{
+    uint64_t elapsed;
+
+    if (NULL == opts->stats)
+    {
+        return;
+    }
+
+    elapsed = TrimClock() - start;
+    TrimmerAddStats(state, opts->stats);
+    opts->stats->readNs += readNs;
+    opts->stats->writeNs += writeNs;
+
+    if (elapsed > readNs + writeNs)
+    {
+        opts->stats->trimNs += elapsed - readNs - writeNs;
+    }
+}
+
+/****************************************************************************
+*   Function   : TrimMapped
+*   Description: This function maps a regular file into memory and trims
+*                the mapping.
+*   Parameters : fdIn - descriptor of a regular file to be trimmed
+*                len - length of the file
+*                state - initialized trimming state
+*                out - empty output buffer
+*                jobs - number of threads that may trim the file
+*   Effects    : Writes version of input file with tabs expanded and
+*                trailing spaces removed.
+*   Returned   : 0 for success, 1 if the file couldn't be mapped and
+*                nothing was written, otherwise -1 with errno set.
+****************************************************************************/
+static int TrimMapped(int fdIn, size_t len, trimmer_t *state,
+    out_buf_t *out, unsigned int jobs)
+{
+    void *map;
+    int status;
+
+    map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fdIn, 0);
+
+    if (MAP_FAILED == map)
+    {
+        return 1;
+    }
+
+    (void)posix_madvise(map, len, POSIX_MADV_SEQUENTIAL);
+    status = TrimMapping((const char *)map, len, state, out, jobs);
+    munmap(map, len);
+    return status;
+}
+
+/****************************************************************************
+*   Function   : TrimMapping
+*   Description: This function runs a whole file that is mapped into
+*                memory through the trimming state machine.  Long unchanged
+*                spans are handed to writev(2) straight from the mapping,
+*                so a file that needs few edits is mostly written without
+*                being copied into a user space buffer.  Large files may
+*                be trimmed by several threads.
+*   Parameters : data - the mapped file
+*                len - length of the file
+*                state - initialized trimming state
+*                out - empty output buffer.  Writes to memory only buffers
+*                      are done by a single thread and always copied.
+*                jobs - number of threads that may trim the file
+*   Effects    : Writes version of input file with tabs expanded and
+*                trailing spaces removed.  Everything is flushed from out
+*                unless it's a memory only buffer.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int TrimMapping(const char *data, size_t len, trimmer_t *state,
+    out_buf_t *out, unsigned int jobs)
+{
+    int status;
+
+    if ((jobs > 1) && (len > CHUNK_SIZE) && (out->fd >= 0))
+    {
+        /* every chunk must write the same line endings */
+        TrimmerDetectEol(state, data, len);
+        return TrimParallel(data, len, state, out, jobs);
+    }
+
+    /* the mapping outlives every flush, so spans may point into it */
+    out->stable = (out->fd >= 0);
+    status = TrimmerFeed(state, data, len, OutSink, out);
+
+    if (0 == status)
+    {
+        status = TrimmerFinish(state, OutSink, out);
+    }
+    else
+    {
+        TrimmerFree(state);
+    }
+
+    if ((0 == status) && out->stable)
+    {
+        status = OutFlush(out);
+    }
+
+    out->stable = 0;
+    return status;
+}
+
+/****************************************************************************
+*   Function   : TrimParallel
+*   Description: This function trims a mapped file using a pool of worker
+*                threads.  The file is cut into chunks that end just after
+*                a line ending.  Because pos and spaces are always zero
+*                after a line ending, each chunk can be trimmed on its own
+*                and the results written in order are identical to trimming
+*                the file serially.  Workers are never more than a fixed
+*                window of chunks ahead of the writer, so memory use does
+*                not depend on the size of the file.
+*   Parameters : data - the mapped file
+*                len - length of the mapped file
+*                state - initialized trimming state
+*                out - empty output buffer (its descriptor is used)
+*                jobs - number of worker threads
+*   Effects    : Writes version of input file with tabs expanded and
+*                trailing spaces removed.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int TrimParallel(const char *data, size_t len, trimmer_t *state,
+    out_buf_t *out, unsigned int jobs)
+{
+    par_job_t job;
+    pthread_t *threads;
+    unsigned int i, started;
+    unsigned long chunk;
+    chunk_slot_t *slot;
+    uint64_t now;
+    int status, err;
+
+    job.data = data;
+    job.len = len;
+    job.initial = state;
+    job.nextStart = 0;
+    job.claimed = 0;
+    job.written = 0;
+    job.window = 2 * jobs;
+    job.failed = 0;
+    memset(&job.stats, 0, sizeof(job.stats));
+
+    threads = (pthread_t *)malloc(jobs * sizeof(pthread_t));
+    job.slots = (chunk_slot_t *)calloc(job.window, sizeof(chunk_slot_t));
+
+    if ((NULL == threads) || (NULL == job.slots))
+    {
+        free(threads);
+        free(job.slots);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    for (i = 0; i < job.window; i++)
+    {
+        job.slots[i].out.fd = -1;
+    }
+
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.cond, NULL);
+    status = 0;
+    err = 0;
+
+    for (started = 0; started < jobs; started++)
+    {
+        if (0 != pthread_create(&threads[started], NULL, ChunkWorker, &job))
+        {
+            break;
+        }
+    }
+
+    if (0 == started)
+    {
+        err = EAGAIN;
+        status = -1;
+        job.failed = 1;
+    }
+
+    /* write the chunks out in order as they are completed */
+    for (chunk = 0; 0 == status; chunk++)
+    {
+        slot = &job.slots[chunk % job.window];
+        pthread_mutex_lock(&job.lock);
+
+        while (!job.failed && !((chunk < job.claimed) && slot->ready) &&
+            !((chunk == job.claimed) && (job.nextStart >= job.len)))
+        {
+            pthread_cond_wait(&job.cond, &job.lock);
+        }
+
+        if (job.failed)
+        {
+            err = ENOMEM;
+            status = -1;
+        }
+
+        pthread_mutex_unlock(&job.lock);
+
+        if ((0 != status) || (chunk == job.claimed))
+        {
+            /* error or all chunks are written */
+            break;
+        }
+
+        now = TrimClock();
+
+        if (0 != WriteAll(out->fd, slot->out.buf, slot->out.used))
+        {
+            err = errno;
+            status = -1;
+        }
+
+        out->writeNs += TrimClock() - now;
+
+        pthread_mutex_lock(&job.lock);
+        slot->ready = 0;
+        job.written++;
+
+        if (0 != status)
+        {
+            job.failed = 1;
+        }
+
+        pthread_cond_broadcast(&job.cond);
+        pthread_mutex_unlock(&job.lock);
+    }
+
+    for (i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (i = 0; i < job.window; i++)
+    {
+        free(job.slots[i].out.buf);
+    }
+
+    pthread_cond_destroy(&job.cond);
+    pthread_mutex_destroy(&job.lock);
+    free(job.slots);
+    free(threads);
+    TrimStatsAdd(&state->stats, &job.stats);
+
+    if (0 != status)
+    {
+        errno = err;
+    }
+
+    return status;
+}
+
+/****************************************************************************
+*   Function   : ChunkWorker
+*   Description: This function is run by each -j worker thread.  It claims
+*                the next line aligned chunk of the file, trims it into the
+*                chunk's slot, and repeats until the whole file has been
+*                claimed or something has failed.
+*   Parameters : arg - pointer to the par_job_t being worked on
+*   Effects    : Trimmed chunks are placed in the job's slots.
+*   Returned   : NULL
+****************************************************************************/
+static void *ChunkWorker(void *arg)
+{
+    par_job_t *job;
+    chunk_slot_t *slot;
+    trimmer_t state;
+    size_t start, end;
+    int status;
+
+    job = (par_job_t *)arg;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&job->lock);
+
+        /* stay within the window of chunks the writer can hold */
+        while (!job->failed && (job->nextStart < job->len) &&
+            (job->claimed - job->written >= job->window))
+        {
+            pthread_cond_wait(&job->cond, &job->lock);
+        }
+
+        if (job->failed || (job->nextStart >= job->len))
+        {
+            pthread_mutex_unlock(&job->lock);
+            break;
+        }
+
+        start = job->nextStart;
+        end = NextLineStart(job->data, start + CHUNK_SIZE, job->len);
+        job->nextStart = end;
+        slot = &job->slots[job->claimed % job->window];
+        job->claimed++;
+        pthread_mutex_unlock(&job->lock);
+
+        /* every chunk starts at the beginning of a line */
+        state = *job->initial;
+        slot->out.used = 0;
+        status = TrimmerFeed(&state, job->data + start, end - start,
+            OutSink, &slot->out);
+
+        /* chunks end at a line start, where only a CR may be pending, and
+         * the next chunk never starts with its LF */
+        if (0 == status)
+        {
+            status = TrimmerFinish(&state, OutSink, &slot->out);
+        }
+        else
+        {
+            TrimmerFree(&state);
+        }
+
+        pthread_mutex_lock(&job->lock);
+
+        if (0 != status)
+        {
+            job->failed = 1;
+        }
+        else
+        {
+            slot->ready = 1;
+            TrimmerAddStats(&state, &job->stats);
+        }
+
+        pthread_cond_broadcast(&job->cond);
+        pthread_mutex_unlock(&job->lock);
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+*   Function   : NextLineStart
+*   Description: This function finds the start of the first line that
+*                begins at or after a given offset.
+*   Parameters : data - text being searched
+*                from - offset to start searching from
+*                len - length of data
+*   Effects    : None
+*   Returned   : Offset of the character following the first '\n' or '\r'
+*                at or after from - 1, or len if there is none.  A CRLF
+*                isn't split.
+****************************************************************************/
+static size_t NextLineStart(const char *data, size_t from, size_t len)
+{
+    if (from >= len)
+    {
+        return len;
+    }
+
+    for (from--; from < len; from++)
+    {
+        if ('\n' == data[from])
+        {
+            return from + 1;
+        }
+
+        if ('\r' == data[from])
+        {
+            return ((from + 1 < len) && ('\n' == data[from + 1])) ?
+                from + 2 : from + 1;
+        }
+    }
+
+    return len;
+}
+
+/****************************************************************************
+*   Function   : FindChange
+*   Description: This function runs a block of input through the trimming
+*                state machine without producing any output, stopping at
+*                the first byte that trimming would change.  It's used to
+*                find files that are already clean.  Whitespace pending at
+*                the end of the block is left in state->spaces; if it is
+*                still pending at the end of the file, the file changes.
+*                The same goes for a CR ending the block that would become
+*                CRLF unless an LF follows; it's left in state->cr.
+*   Parameters : state - trimming state carried between blocks
+*                buf - block of input
+*                len - number of bytes in buf
+*   Effects    : state is updated to reflect the end of the block, or the
+*                changed byte.
+*   Returned   : Pointer to the first tab that would be expanded, line
+*                ending that trailing whitespace would be removed from or
+*                that would be converted, or end of whitespace that would
+*                be retabbed differently, NULL if there are none.
+****************************************************************************/
+static const char *FindChange(trimmer_t *state, const char *buf,
+    size_t len)
+{
+    const char *p, *end, *next, *wide;
+    unsigned int width;
+
+    end = buf + len;
+    p = buf;
+
+    if (EOL_AUTO == state->eol)
+    {
+        TrimmerDetectEol(state, buf, len);
+    }
+
+    if (state->cr && (0 != len))
+    {
+        /* a CR ended the last block */
+        state->cr = 0;
+
+        if ('\n' != *p)
+        {
+            return p;
+        }
+
+        p++;
+    }
+
+    if (TRIMMER_UTF8_CUT(state, buf, len))
+    {
+        state->pos++;
+        state->ucsNeed = 0;
+    }
+
+    wide = state->utf8 ? FindNonAscii(p, end) : end;
+
+    while (p < end)
+    {
+        switch (*p)
+        {
+            case '\n':
+            case '\r':
+                if (0 != state->spaces)
+                {
+                    return p;
+                }
+
+                if ('\n' == *p)
+                {
+                    if (EOL_CRLF == state->eol)
+                    {
+                        return p;       /* a bare LF */
+                    }
+                }
+                else if (EOL_LF == state->eol)
+                {
+                    return p;
+                }
+                else if (EOL_CRLF == state->eol)
+                {
+                    if (p + 1 == end)
+                    {
+                        state->cr = 1;
+                    }
+                    else if ('\n' != p[1])
+                    {
+                        return p;       /* a lone CR */
+                    }
+                    else
+                    {
+                        p++;
+                    }
+                }
+
+                state->pos = 0;
+                state->leading = 1;
+                p++;
+                break;
+
+            case ' ':
+                if (state->spaceCol < 0)
+                {
+                    state->spaceCol = (int64_t)state->pos;
+                }
+
+                state->spaces++;
+                state->pos++;
+                p++;
+                break;
+
+            case '\t':
+                if (TRIMMER_RETABS(state))
+                {
+                    if (state->spaceCol >= 0)
+                    {
+                        return p;       /* spaces before a tab */
+                    }
+                }
+                else if (!state->keepTabs)
+                {
+                    return p;
+                }
+
+                /* a kept tab only changes if it's trailing */
+                width = TrimmerTabWidth(state, state->pos);
+                state->spaces += width;
+                state->pos += width;
+                p++;
+                break;
+
+            default:
+                if ((0 != state->spaces) && TRIMMER_RETABS(state) &&
+                    RetabChanges(state))
+                {
+                    return p;
+                }
+
+                state->spaces = 0;
+                state->spaceCol = -1;
+                state->leading = 0;
+                next = FindSpecial(p + 1, end);
+
+                if (next <= wide)
+                {
+                    state->pos += (uint64_t)(next - p);
+                }
+                else
+                {
+                    state->pos += TrimmerRunWidth(state, p, next, end);
+                    wide = FindNonAscii(next, end);
+                }
+
+                p = next;
+                break;
+        }
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+*   Function   : RetabChanges
+*   Description: This function determines whether retabbing would change
+*                the whitespace pending in a trimmer.  The whitespace must
+*                not have a space before a tab.  Then it only changes if
+*                its spaces reach a tab stop, or if it's a lone tab one
+*                column wide (which becomes a space).  A lone space never
+*                changes.
+*   Parameters : state - trimming state with whitespace pending
+*   Effects    : None
+*   Returned   : Non-zero if retabbing would change the whitespace.
+****************************************************************************/
+static int RetabChanges(const trimmer_t *state)
+{
+    uint64_t spaceCol;
+
+    if (state->spaceCol < 0)
+    {
+        /* only tabs */
+        return (1 == state->spaces);
+    }
+
+    if (1 == state->spaces)
+    {
+        return 0;
+    }
+
+    spaceCol = (uint64_t)state->spaceCol;
+    return TrimmerTabWidth(state, spaceCol) <= state->pos - spaceCol;
+}
+
+/****************************************************************************
+*   Function   : CheckRanges
+*   Description: This function passes only the listed lines of a whole
+*                file to CheckBlock, numbering each range's lines from its
+*                first line.  Each range starts at the beginning of a line,
+*                where the state is always reset.
+*   Parameters : check - state of the check
+*                data - the whole file
+*                len - length of the file
+*                ranges - lines to check, in increasing order
+*                count - number of ranges
+*                out - memory only buffer for a report of every change, or
+*                      NULL to stop at the first change
+*   Effects    : Updates check, and may add to out.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int CheckRanges(check_state_t *check, const char *data, size_t len,
+    const line_range_t *ranges, size_t count, out_buf_t *out)
+{
+    size_t i, pos, end;
+    uint64_t line;
+    int status;
+
+    status = 0;
+    pos = 0;
+    line = 1;
+    TrimmerDetectEol(&check->trim, data, len);
+
+    for (i = 0; (0 == status) && (i < count) && (pos < len) &&
+        ((NULL != out) || (0 == check->found)); i++)
+    {
+        pos = TrimmerSkipLines(data, len, pos, line, ranges[i].first);
+        line = ranges[i].first;
+        end = TrimmerSkipLines(data, len, pos, line, ranges[i].last + 1);
+
+        check->line = (unsigned long)line;
+        check->col = 0;
+        check->afterCR = 0;
+        status = CheckBlock(check, data + pos, end - pos, out);
+
+        pos = end;
+        line = ranges[i].last + 1;
+    }
+
+    return status;
+}
+
+/****************************************************************************
+*   Function   : CheckBlock
+*   Description: This function scans a block of input for changes that
+*                trimming would make.  Without an output buffer it stops at
+*                the first change.  With one, every tab that would be
+*                expanded, every run of whitespace removed from the end of
+*                a line, and every run of whitespace that would be retabbed
+*                differently is reported, along with every line ending that
+*                would be converted.  Lines end with '\n', '\r', or "\r\n",
+*                and columns count bytes from 1.
+*   Parameters : check - scanner state carried between blocks
+*                buf - block of input
+*                len - number of bytes in buf
+*                out - memory buffer the report is written to, or NULL to
+*                      stop at the first change
+*   Effects    : check is updated and the report may be extended.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int CheckBlock(check_state_t *check, const char *buf, size_t len,
+    out_buf_t *out)
+{
+    const char *p, *end, *next, *wide;
+    trimmer_t *state;
+    unsigned int width;
+
+    state = &check->trim;
+
+    if (NULL == out)
+    {
+        if (NULL != FindChange(state, buf, len))
+        {
+            check->found++;
+        }
+
+        return 0;
+    }
+
+    end = buf + len;
+    p = buf;
+
+    if (EOL_AUTO == state->eol)
+    {
+        TrimmerDetectEol(state, buf, len);
+    }
+
+    if (state->cr && (0 != len))
+    {
+        /* a CR ended the last block; alone, it would become CRLF */
+        state->cr = 0;
+
+        if (('\n' != *p) && (0 != CheckReport(check, check->line - 1,
+            check->crCol, "line ending", out)))
+        {
+            return -1;
+        }
+    }
+
+    if (TRIMMER_UTF8_CUT(state, buf, len))
+    {
+        state->pos++;
+        state->ucsNeed = 0;
+    }
+
+    wide = state->utf8 ? FindNonAscii(p, end) : end;
+
+    while (p < end)
+    {
+        switch (*p)
+        {
+            case '\n':
+            case '\r':
+                if ((0 != state->spaces) && (0 != CheckTrailing(check, out)))
+                {
+                    return -1;
+                }
+
+                if ('\r' == *p)
+                {
+                    check->crCol = check->col + 1;
+
+                    if ((EOL_CRLF == state->eol) && (p + 1 == end))
+                    {
+                        state->cr = 1;      /* wait for the next block */
+                    }
+                }
+
+                if (((EOL_LF == state->eol) && ('\r' == *p)) ||
+                    ((EOL_CRLF == state->eol) && (('\n' == *p) ?
+                    !check->afterCR : ((p + 1 < end) && ('\n' != p[1])))))
+                {
+                    if (0 != CheckReport(check, check->line,
+                        check->col + 1, "line ending", out))
+                    {
+                        return -1;
+                    }
+                }
+
+                if (('\r' == *p) || !check->afterCR)
+                {
+                    check->line++;
+                }
+
+                state->pos = 0;
+                state->spaces = 0;
+                state->spaceCol = -1;
+                state->leading = 1;
+                check->mixed = 0;
+                check->col = 0;
+                check->afterCR = ('\r' == *p);
+                p++;
+                break;
+
+            case '\t':
+            case ' ':
+                if (0 == state->spaces)
+                {
+                    check->wsLine = check->line;
+                    check->wsCol = check->col + 1;
+                    check->wsReport = out->used;
+                }
+
+                if ('\t' == *p)
+                {
+                    if (!TRIMMER_RETABS(state))
+                    {
+                        /* a kept tab is only reported if it's trailing */
+                        if (!state->keepTabs && (0 != CheckReport(check,
+                            check->line, check->col + 1, "tab", out)))
+                        {
+                            return -1;
+                        }
+                    }
+                    else if (state->spaceCol >= 0)
+                    {
+                        check->mixed = 1;       /* spaces before a tab */
+                    }
+
+                    width = TrimmerTabWidth(state, state->pos);
+                }
+                else
+                {
+                    width = 1;
+
+                    if (state->spaceCol < 0)
+                    {
+                        state->spaceCol = (int64_t)state->pos;
+                    }
+                }
+
+                state->spaces += width;
+                state->pos += width;
+                check->col++;
+                check->afterCR = 0;
+                p++;
+                break;
+
+            default:
+                if ((0 != state->spaces) && TRIMMER_RETABS(state) &&
+                    (check->mixed || RetabChanges(state)))
+                {
+                    if (0 != CheckReport(check, check->wsLine, check->wsCol,
+                        "whitespace not retabbed", out))
+                    {
+                        return -1;
+                    }
+                }
+
+                state->spaces = 0;
+                state->spaceCol = -1;
+                state->leading = 0;
+                check->mixed = 0;
+                check->afterCR = 0;
+                next = FindSpecial(p + 1, end);
+                check->col += (unsigned long)(next - p);
+
+                if (next <= wide)
+                {
+                    state->pos += (uint64_t)(next - p);
+                }
+                else
+                {
+                    state->pos += TrimmerRunWidth(state, p, next, end);
+                    wide = FindNonAscii(next, end);
+                }
+
+                p = next;
+                break;
+        }
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : CheckReport
+*   Description: This function counts a change found by the check mode
+*                scanner and, if there's a report, adds a line to it.
+*   Parameters : check - scanner state
+*                line - line number of the change
+*                col - column of the change
+*                what - description of the change
+*                out - memory buffer holding the report, may be NULL
+*   Effects    : check->found is incremented and the report is extended.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int CheckReport(check_state_t *check, unsigned long line,
+    unsigned long col, const char *what, out_buf_t *out)
+{
+    char numbers[64];
+    int len;
+
+    check->found++;
+
+    if (NULL == out)
+    {
+        return 0;
+    }
+
+    len = sprintf(numbers, ":%lu:%lu: ", line, col);
+
+    if ((0 != OutWrite(out, check->name, strlen(check->name))) ||
+        (0 != OutWrite(out, numbers, (size_t)len)) ||
+        (0 != OutWrite(out, what, strlen(what))) ||
+        (0 != OutWrite(out, "\n", 1)))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : CheckTrailing
+*   Description: This function reports the whitespace pending at the end
+*                of a line as trailing.  Its tabs were reported as they
+*                were found, so the report is moved ahead of theirs to
+*                keep the line's reports in column order.
+*   Parameters : check - scanner state with whitespace pending
+*                out - memory buffer holding the report, may be NULL
+*   Effects    : check->found is incremented and the report is extended.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int CheckTrailing(check_state_t *check, out_buf_t *out)
+{
+    size_t before;
+
+    before = (NULL == out) ? 0 : out->used;
+
+    if (0 != CheckReport(check, check->wsLine, check->wsCol,
+        "trailing whitespace", out))
+    {
+        return -1;
+    }
+
+    if ((NULL != out) && (check->wsReport < before))
+    {
+        /* rotate the new line in front of the tabs' */
+        Reverse(out->buf + check->wsReport, out->buf + before);
+        Reverse(out->buf + before, out->buf + out->used);
+        Reverse(out->buf + check->wsReport, out->buf + out->used);
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : Reverse
+*   Description: This function reverses the order of a run of bytes.
+*   Parameters : start - first byte of the run
+*                end - byte after the run
+*   Effects    : The bytes from start to end are reversed.
+*   Returned   : None
+****************************************************************************/
+static void Reverse(char *start, char *end)
+{
+    char c;
+
+    while (end - start > 1)
+    {
+        end--;
+        c = *start;
+        *start = *end;
+        *end = c;
+        start++;
+    }
+}
+
+/****************************************************************************
+*   Function   : OutInit
+*   Description: This function initializes an output buffer.  Buffers for
+*                a descriptor get a fixed size buffer that is flushed when
+*                full.  Memory only buffers (fd < 0) start empty and grow.
+*   Parameters : out - output buffer to initialize
+*                fd - descriptor output is written to, or -1 for memory
+*   Effects    : Memory may be allocated for the buffer.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int OutInit(out_buf_t *out, int fd)
+{
+    out->fd = fd;
+    out->buf = NULL;
+    out->used = 0;
+    out->size = 0;
+    out->spanStart = 0;
+    out->stable = 0;
+    out->iovCount = 0;
+    out->writeNs = 0;
+
+    if (fd >= 0)
+    {
+        out->buf = (char *)malloc(OUT_SIZE);
+
+        if (NULL == out->buf)
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+
+        out->size = OUT_SIZE;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : OutWrite
+*   Description: This function appends data to an output buffer, flushing
+*                the buffer when it fills.  If the data will remain valid
+*                until the next flush and it's long enough, a reference to
+*                it is gathered for writev(2) instead of copying it.  Other
+*                data larger than the buffer is written directly.
+*   Parameters : out - output buffer
+*                data - data to be written
+*                len - number of bytes in data
+*   Effects    : data is buffered or written to out's descriptor.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int OutWrite(out_buf_t *out, const char *data, size_t len)
+{
+    size_t first;
+    uint64_t start;
+    int status;
+
+    if (out->stable && (len >= ZC_MIN))
+    {
+        /* close off the copied bytes that come before this span; they're
+         * marked as gathered first, in case adding them forces a flush */
+        if (out->used != out->spanStart)
+        {
+            first = out->spanStart;
+            out->spanStart = out->used;
+
+            if (0 != OutAddSpan(out, out->buf + first, out->used - first))
+            {
+                return -1;
+            }
+        }
+
+        return OutAddSpan(out, data, len);
+    }
+
+    if (out->used + len > out->size)
+    {
+        if (out->fd < 0)
+        {
+            /* memory only buffer */
+            if (0 != OutReserve(out, len))
+            {
+                return -1;
+            }
+
+            memcpy(out->buf + out->used, data, len);
+            out->used += len;
+            return 0;
+        }
+
+        if (0 != OutFlush(out))
+        {
+            return -1;
+        }
+
+        if (len >= out->size)
+        {
+            start = TrimClock();
+            status = WriteAll(out->fd, data, len);
+            out->writeNs += TrimClock() - start;
+            return status;
+        }
+    }
+
+    memcpy(out->buf + out->used, data, len);
+    out->used += len;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : OutSink
+*   Description: This function is the trim_sink_t that passes the output
+*                of a trimmer to an output buffer.
+*   Parameters : context - output buffer
+*                data - trimmed output
+*                len - number of bytes in data
+*   Effects    : data is buffered or written to the buffer's descriptor.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int OutSink(void *context, const char *data, size_t len)
+{
+    return OutWrite((out_buf_t *)context, data, len);
+}
+
+/****************************************************************************
+*   Function   : OutFlush
+*   Description: This function writes everything held in an output buffer,
+*                both copied data and gathered spans, with writev(2).
+*   Parameters : out - output buffer
+*   Effects    : Buffered data is written to out's descriptor and the
+*                buffer is emptied.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int OutFlush(out_buf_t *out)
+{
+    uint64_t start;
+    int status;
+
+    if (out->fd < 0)
+    {
+        /* memory only buffers are never flushed */
+        return 0;
+    }
+
+    if (out->used != out->spanStart)
+    {
+        out->iov[out->iovCount].iov_base = out->buf + out->spanStart;
+        out->iov[out->iovCount].iov_len = out->used - out->spanStart;
+        out->iovCount++;
+    }
+
+    start = TrimClock();
+    status = WriteAllV(out->fd, out->iov, out->iovCount);
+    out->writeNs += TrimClock() - start;
+    out->used = 0;
+    out->spanStart = 0;
+    out->iovCount = 0;
+    return status;
+}
+
+/****************************************************************************
+*   Function   : OutReserve
+*   Description: This function grows a memory only output buffer (one with
+*                a negative descriptor) so that it can hold len more bytes.
+*   Parameters : out - memory only output buffer
+*                len - number of bytes that must fit after out->used
+*   Effects    : out->buf may be reallocated and out->size increased.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int OutReserve(out_buf_t *out, size_t len)
+{
+    size_t size;
+    char *buf;
+
+    if (out->used + len <= out->size)
+    {
+        return 0;
+    }
+
+    size = (0 == out->size) ? 4096 : out->size;
+
+    while (size < out->used + len)
+    {
+        size *= 2;
+    }
+
+    buf = (char *)realloc(out->buf, size);
+
+    if (NULL == buf)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    out->buf = buf;
+    out->size = size;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : OutAddSpan
+*   Description: This function adds a span to the list of spans gathered
+*                for the next writev(2), flushing the list when it is full.
+*                One slot is always left free for the copied data that
+*                OutFlush adds.
+*   Parameters : out - output buffer
+*                data - data to be written; it must remain valid until the
+*                       next flush
+*                len - number of bytes in data
+*   Effects    : data is added to out's span list.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int OutAddSpan(out_buf_t *out, const char *data, size_t len)
+{
+    out->iov[out->iovCount].iov_base = (void *)data;
+    out->iov[out->iovCount].iov_len = len;
+    out->iovCount++;
+
+    if (OUT_IOVS - 1 == out->iovCount)
+    {
+        return OutFlush(out);
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : TrimClock
+*   Description: This function reads a monotonic clock for timing the
+*                stages of trimming a stream.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Nanoseconds since some fixed point in the past.
+****************************************************************************/
+uint64_t TrimClock(void)
+{
+    struct timespec now;
+
+    if (0 != clock_gettime(CLOCK_MONOTONIC, &now))
+    {
+        return 0;
+    }
+
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/****************************************************************************
+*   Function   : WriteAll
+*   Description: This function calls write(2) until all of the data has
+*                been written, retrying short and interrupted writes.
+*   Parameters : fd - descriptor to write to
+*                data - data to be written
+*                len - number of bytes in data
+*   Effects    : data is written to fd.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+int WriteAll(int fd, const char *data, size_t len)
+{
+    struct iovec iov;
+
+    iov.iov_base = (void *)data;
+    iov.iov_len = len;
+    return WriteAllV(fd, &iov, 1);
+}
+
+/****************************************************************************
+*   Function   : WriteAllV
+*   Description: This function calls writev(2) until all of the spans have
+*                been written, retrying short and interrupted writes.
+*   Parameters : fd - descriptor to write to
+*                iov - spans to be written; entries are modified as they
+*                      are written
+*                count - number of entries in iov
+*   Effects    : The spans in iov are written to fd.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int WriteAllV(int fd, struct iovec *iov, int count)
+{
+    ssize_t wrote;
+
+    while (count > 0)
+    {
+        if (0 == iov->iov_len)
+        {
+            iov++;
+            count--;
+            continue;
+        }
+
+        wrote = writev(fd, iov, count);
+
+        if (wrote < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            return -1;
+        }
+
+        /* skip past everything that was written */
+        while ((count > 0) && ((size_t)wrote >= iov->iov_len))
+        {
+            wrote -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+
+        if (count > 0)
+        {
+            iov->iov_base = (char *)iov->iov_base + wrote;
+            iov->iov_len -= (size_t)wrote;
+        }
+    }
+
+    return 0;
+}
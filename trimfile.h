@@ -0,0 +1,84 @@
+/***************************************************************************
+*                   Tab Remover and Trailing Space Trimmer
+*
+*   File    : trimfile.h
+*   Purpose : Header for functions that trim a file descriptor
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef TRIMFILE_H
+#define TRIMFILE_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stddef.h>
+#include "trimmer.h"
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* trims everything read from fdIn and writes it to fdOut, decompressing
+ * gzip or zstd input and compressing the output as opts->codec asks */
+int TrimFd(int fdIn, int fdOut, const trim_opts_t *opts);
+
+/* trims everything read from fdIn into a malloc'd buffer */
+int TrimFdToMemory(int fdIn, const trim_opts_t *opts, char **buf,
+    size_t *len);
+
+/* trims a file already in memory into a malloc'd buffer */
+int TrimMemory(const char *data, size_t dataLen, const trim_opts_t *opts,
+    char **buf, size_t *len);
+
+/* checks whether trimming would change fdIn, optionally listing where */
+int CheckFd(int fdIn, const trim_opts_t *opts, const char *name, int list,
+    char **report, size_t *reportLen, int *changed);
+
+/* checks whether trimming would change a file already in memory */
+int CheckMemory(const char *data, size_t dataLen, const trim_opts_t *opts,
+    const char *name, int list, char **report, size_t *reportLen,
+    int *changed);
+
+/* checks whether trimming some lines of a file would change it */
+int CheckFileLines(const char *path, const line_range_t *ranges,
+    size_t count, const trim_opts_t *opts, int list, char **report,
+    size_t *reportLen, int *changed);
+
+/* trims a regular file in place, leaving it untouched if already clean */
+int TrimFileInPlace(const char *path, const trim_opts_t *opts, int sync,
+    int *changed);
+
+/* trims only some lines of a regular file in place */
+int TrimFileLinesInPlace(const char *path, const line_range_t *ranges,
+    size_t count, const trim_opts_t *opts, int sync, int *changed);
+
+/* writes all of data to fd, retrying short and interrupted writes */
+int WriteAll(int fd, const char *data, size_t len);
+
+/* returns the time from a monotonic clock in nanoseconds */
+uint64_t TrimClock(void);
+
+#endif  /* ndef TRIMFILE_H */
@@ -0,0 +1,1580 @@
+/***************************************************************************
+*                   Tab Remover and Trailing Space Trimmer
+*
+*   File    : trimmer.c
+*   Purpose : Streaming tab expansion and trailing space trimming state
+*             machine that buffers can be pushed through in pieces
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "trimmer.h"
+#include "scan.h"
+#include "width.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define SPACE_BLOCK 4096            /* spaces passed to a sink per call */
+
+/* words of held kept whitespace; a bit map word has the top bit clear */
+#define HELD_RUN        ((uint64_t)1 << 63)     /* the word is a run */
+#define HELD_TAB        ((uint64_t)1 << 62)     /* the run is of tabs */
+#define HELD_COUNT      (HELD_TAB - 1)          /* length of the run */
+#define HELD_BITS       63                      /* bytes in a bit map */
+
+/* when a feed kernel keeps whitespace as it is */
+#define KEEPS_NEVER     0           /* tabs are always expanded */
+#define KEEPS_ALWAYS    1           /* -k without retabbing */
+#define KEEPS_CHECK     2           /* TRIMMER_KEEPS decides as it goes */
+
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+/* width of a tab at column col; a table lookup or a single modulo */
+#define TAB_WIDTH(t, col) (((col) < (t)->last) ? (t)->widths[(col)] : \
+    (t)->interval - (unsigned int)(((col) - (t)->last) % (t)->interval))
+
+/* TAB_WIDTH in a feed kernel for stops every width columns, a power of 2,
+ * or for any stops if width is 0.  width is a constant in each kernel, so
+ * only one side is compiled in. */
+#define KERNEL_TAB_WIDTH(t, col, width) ((0 != (width)) ? \
+    (width) - (unsigned int)((col) & ((width) - 1)) : TAB_WIDTH(t, col))
+
+/* TRIMMER_KEEPS in a feed kernel; keeps is a KEEPS_ constant */
+#define KERNEL_KEEPS(t, keeps) ((KEEPS_CHECK == (keeps)) ? \
+    TRIMMER_KEEPS(t) : (KEEPS_ALWAYS == (keeps)))
+
+/* the feed kernel is copied into each variant so its constant arguments
+ * fold away; other compilers get the same code without the folding */
+#ifdef __GNUC__
+#define KERNEL_INLINE   __inline__ __attribute__((always_inline))
+#else
+#define KERNEL_INLINE
+#endif
+
+/* initializers for the blocks of spaces and tabs (4096 of each) */
+#define REP8(c)     c, c, c, c, c, c, c, c
+#define REP64(c)    REP8(c), REP8(c), REP8(c), REP8(c), \
+                    REP8(c), REP8(c), REP8(c), REP8(c)
+#define REP512(c)   REP64(c), REP64(c), REP64(c), REP64(c), \
+                    REP64(c), REP64(c), REP64(c), REP64(c)
+#define REP4096(c)  REP512(c), REP512(c), REP512(c), REP512(c), \
+                    REP512(c), REP512(c), REP512(c), REP512(c)
+
+/***************************************************************************
+*                            GLOBAL VARIABLES
+**************************************************************************/
+/* whitespace is handed to sinks from here, so runs of any length are
+ * passed on in large pieces without allocating anything */
+static const char spaceBlock[SPACE_BLOCK] = {REP4096(' ')};
+static const char tabBlock[SPACE_BLOCK] = {REP4096('\t')};
+
+/* converted line endings; LF is crlf + 1 */
+static const char crlf[] = "\r\n";
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static trim_feed_t PickFeed(const trimmer_t *trimmer);
+static KERNEL_INLINE int FeedKernel(trimmer_t *trimmer, const char *buf,
+    size_t len, trim_sink_t sink, void *context, int keeps,
+    unsigned int width);
+static int FeedExpand2(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context);
+static int FeedExpand4(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context);
+static int FeedExpand8(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context);
+static int FeedExpandAny(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context);
+static int FeedKeep(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context);
+static int FeedAny(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context);
+static int Emit(trimmer_t *trimmer, trim_sink_t sink, void *context,
+    const char *data, size_t len);
+static void EndLine(trimmer_t *trimmer, uint64_t len, uint64_t kept);
+static int SinkBlock(trimmer_t *trimmer, const char *block, uint64_t count,
+    trim_sink_t sink, void *context);
+static int SinkRetab(trimmer_t *trimmer, trim_sink_t sink, void *context);
+static int HoldBlanks(trimmer_t *trimmer, const char *p, const char *end);
+static int HoldRun(trimmer_t *trimmer, int tab, uint64_t count);
+static int SinkHeld(trimmer_t *trimmer, trim_sink_t sink, void *context);
+static uint64_t *HeldWord(trimmer_t *trimmer, size_t i);
+static void DropHeld(trimmer_t *trimmer);
+static int SinkEol(trimmer_t *trimmer, const char *run, size_t len,
+    trim_sink_t sink, void *context);
+static int NextStop(const char **list, unsigned long *stop);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : TabStopsInit
+*   Description: This function compiles a list of tab stops into a table
+*                holding the width of a tab at every column before the last
+*                stop.  Past the last stop, tabs are a fixed interval apart:
+*                the distance between the last two stops, or the only stop.
+*                A tab's width is then a table lookup or a single modulo,
+*                never a search of the list.
+*   Parameters : stops - tab stops to be initialized
+*                list - increasing, comma separated, 0 based columns that
+*                       tabs advance to (e.g. "8,12,20" puts the stops after
+*                       20 at 28, 36, ...)
+*   Effects    : Memory is allocated for the table.
+*   Returned   : 0 for success, otherwise -1 with errno set to EINVAL for a
+*                bad list or ENOMEM.
+*
+*   NOTE: TabStopsFree must be called to free the table.
+****************************************************************************/
+int TabStopsInit(tab_stops_t *stops, const char *list)
+{
+    const char *p;
+    unsigned long stop, prev, col;
+
+    stops->widths = NULL;
+    stops->last = 0;
+    stops->interval = 0;
+
+    /* validate the list and find the last stop and interval */
+    p = list;
+    prev = 0;
+
+    do
+    {
+        if ((0 != NextStop(&p, &stop)) || (stop <= prev) ||
+            (stop > TRIMMER_MAX_TAB))
+        {
+            errno = EINVAL;
+            return -1;
+        }
+
+        stops->interval = stop - prev;
+        prev = stop;
+    } while ('\0' != *p);
+
+    stops->last = (unsigned int)prev;
+    stops->widths = (unsigned int *)malloc(prev * sizeof(unsigned int));
+
+    if (NULL == stops->widths)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    /* a tab advances to the next stop after its column */
+    p = list;
+    col = 0;
+
+    do
+    {
+        (void)NextStop(&p, &stop);
+
+        for (; col < stop; col++)
+        {
+            stops->widths[col] = (unsigned int)(stop - col);
+        }
+    } while ('\0' != *p);
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : TabStopsFree
+*   Description: This function frees the table made by TabStopsInit.
+*   Parameters : stops - tab stops to be freed
+*   Effects    : The table is freed.
+*   Returned   : None
+****************************************************************************/
+void TabStopsFree(tab_stops_t *stops)
+{
+    free(stops->widths);
+    stops->widths = NULL;
+    stops->last = 0;
+}
+
+/****************************************************************************
+*   Function   : TrimmerInit
+*   Description: This function prepares a trimmer for the start of a
+*                stream.  A trimmer holds all of the state needed between
+*                calls to TrimmerFeed, so it may be declared anywhere.  It
+*                needs no clean up, except that kept whitespace split
+*                between pieces that takes more than TRIMMER_HELD_WORDS
+*                words is held in memory that is freed when the line goes
+*                on or ends, by TrimmerFinish, or by TrimmerFree.
+*   Parameters : trimmer - trimmer to be initialized
+*                opts - trimming options (jobs is not used).  Any tab stop
+*                       table must outlive the trimmer.
+*   Effects    : trimmer is initialized.
+*   Returned   : None
+****************************************************************************/
+void TrimmerInit(trimmer_t *trimmer, const trim_opts_t *opts)
+{
+    if (NULL != opts->tabStops)
+    {
+        trimmer->widths = opts->tabStops->widths;
+        trimmer->last = opts->tabStops->last;
+        trimmer->interval = opts->tabStops->interval;
+    }
+    else
+    {
+        /* evenly spaced stops are all past the (empty) table */
+        trimmer->widths = NULL;
+        trimmer->last = 0;
+        trimmer->interval = opts->tabSize;
+    }
+
+    trimmer->keepTabs = opts->keepTabs;
+    trimmer->retab = opts->retab;
+    trimmer->eolOpt = opts->eol;
+    trimmer->eol = opts->eol;
+    trimmer->cr = 0;
+    trimmer->pos = 0;
+    trimmer->spaces = 0;
+    trimmer->heldMore = NULL;
+    trimmer->heldSize = 0;
+    trimmer->heldWords = 0;
+    trimmer->heldBits = HELD_BITS;
+    trimmer->blanks = 0;
+    trimmer->lineLen = 0;
+    trimmer->leading = 1;
+    trimmer->spaceCol = -1;
+    memset(&trimmer->stats, 0, sizeof(trimmer->stats));
+
+    /* columns only matter to tabs that are expanded or retabbed */
+    trimmer->utf8 = opts->utf8 && (!opts->keepTabs ||
+        (RETAB_NONE != opts->retab));
+    trimmer->ucs = 0;
+    trimmer->ucsNeed = 0;
+
+    if (trimmer->utf8)
+    {
+        WidthInit();
+    }
+
+    trimmer->feed = PickFeed(trimmer);
+    ScanInit();
+}
+
+/****************************************************************************
+*   Function   : TrimmerTabWidth
+*   Description: This function returns the number of columns a tab at a
+*                given column advances to reach the next tab stop.
+*   Parameters : trimmer - initialized trimmer
+*                col - 0 based column of the tab
+*   Effects    : None
+*   Returned   : Width of the tab.
+****************************************************************************/
+unsigned int TrimmerTabWidth(const trimmer_t *trimmer, uint64_t col)
+{
+    return TAB_WIDTH(trimmer, col);
+}
+
+/****************************************************************************
+*   Function   : TrimmerDetectEol
+*   Description: This function picks the line endings an EOL_AUTO trimmer
+*                writes: CRLF if more of the lines in the first
+*                TRIMMER_EOL_SAMPLE bytes of the stream end with CRLF than
+*                with a bare LF, otherwise LF.  If that much of the stream
+*                holds no line endings yet, the choice is put off, unless
+*                there are already TRIMMER_EOL_SAMPLE bytes, or a lone CR;
+*                then it's LF.  TrimmerFeed calls this with its first
+*                piece, so it's only needed to pick the endings before the
+*                stream is trimmed in pieces by several threads.  The
+*                first piece must hold TRIMMER_EOL_SAMPLE bytes, or the
+*                whole stream, for the choice to be the majority's.
+*   Parameters : trimmer - trimmer at the start of a stream
+*                buf - start of the stream
+*                len - number of bytes in buf
+*   Effects    : trimmer's line endings may be set.
+*   Returned   : None
+****************************************************************************/
+void TrimmerDetectEol(trimmer_t *trimmer, const char *buf, size_t len)
+{
+    const char *p, *end;
+    size_t lf, crlf;
+
+    if (EOL_AUTO != trimmer->eol)
+    {
+        return;
+    }
+
+    end = buf + ((len > TRIMMER_EOL_SAMPLE) ? TRIMMER_EOL_SAMPLE : len);
+    lf = 0;
+    crlf = 0;
+
+    for (p = buf; (p < end) &&
+        (NULL != (p = (const char *)memchr(p, '\n', end - p))); p++)
+    {
+        if ((p > buf) && ('\r' == p[-1]))
+        {
+            crlf++;
+        }
+        else
+        {
+            lf++;
+        }
+    }
+
+    if ((0 != lf) || (0 != crlf) || (len >= TRIMMER_EOL_SAMPLE) ||
+        (NULL != memchr(buf, '\r', len)))
+    {
+        trimmer->eol = (crlf > lf) ? EOL_CRLF : EOL_LF;
+    }
+}
+
+/****************************************************************************
+*   Function   : TrimmerRunWidth
+*   Description: This function returns the number of columns a run of
+*                ordinary characters takes.  It's only used for runs that
+*                aren't plain ASCII.  A UTF-8 sequence may continue into
+*                the next piece of the stream, but one cut off by the
+*                whitespace or line ending after the run takes a column.
+*   Parameters : trimmer - trimmer counting display columns
+*                p - start of the run
+*                next - the whitespace or line ending after the run, or end
+*                end - end of the piece of the stream
+*   Effects    : The trimmer's unfinished UTF-8 sequence is updated.
+*   Returned   : Number of columns the run takes.
+****************************************************************************/
+uint64_t TrimmerRunWidth(trimmer_t *trimmer, const char *p,
+    const char *next, const char *end)
+{
+    uint64_t width;
+
+    width = Utf8Width(p, next, &trimmer->ucs, &trimmer->ucsNeed);
+
+    if ((0 != trimmer->ucsNeed) && (next != end))
+    {
+        width++;
+        trimmer->ucsNeed = 0;
+    }
+
+    return width;
+}
+
+/****************************************************************************
+*   Function   : TrimmerFeed
+*   Description: This function runs the next piece of a stream through the
+*                tab expansion and trimming state machine.  Pieces may be
+*                split anywhere, even in the middle of a line.  FindSpecial
+*                skips over runs of ordinary characters so that the state
+*                machine only runs at whitespace and line endings, and runs
+*                that are copied unchanged are passed to the sink as a
+*                single span of buf.  Whitespace is counted and only passed
+*                on when it is followed by a non-whitespace character on
+*                the same line.  It's passed on as spaces, or, when it's
+*                retabbed, as the fewest tabs and spaces that reach the
+*                same column.  Line endings that are converted end a span;
+*                a CR at the end of a piece is held until the next piece
+*                shows whether it's half of a CRLF.  With UTF-8 columns, a
+*                run is only decoded if FindNonAscii, which looks at whole
+*                blocks at a time, found a byte that isn't ASCII in it.
+*                Kept whitespace is left in buf, so a line's leading tabs
+*                go to the sink in one span with the rest of the line, and
+*                it's cut out of the span if the line ends.  Kept
+*                whitespace that reaches the end of buf is held until the
+*                next piece, taking at most a bit a byte.
+*   Parameters : trimmer - state carried between pieces of the stream
+*                buf - next piece of the stream
+*                len - number of bytes in buf
+*                sink - function that trimmed output is passed to
+*                context - passed to sink unchanged
+*   Effects    : Trimmed output is passed to sink, and trimmer is updated
+*                to reflect the end of buf.
+*   Returned   : 0 for success, -1 with errno set to ENOMEM if held
+*                whitespace can't be stored, otherwise the non-zero value
+*                returned by sink.
+****************************************************************************/
+int TrimmerFeed(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context)
+{
+    return trimmer->feed(trimmer, buf, len, sink, context);
+}
+
+/****************************************************************************
+*   Function   : FeedKernel
+*   Description: This function is the body of TrimmerFeed.  Each feed
+*                variant calls it with constants for the options that
+*                don't change during a stream, so that with GCC the
+*                variant gets its own copy with the checks of those
+*                options folded away: whether tabs are kept or expanded,
+*                and for evenly spaced stops 2, 4, or 8 apart, the width
+*                of a tab as a mask instead of a modulo.
+*   Parameters : trimmer - state carried between pieces of the stream
+*                buf - next piece of the stream
+*                len - number of bytes in buf
+*                sink - function that trimmed output is passed to
+*                context - passed to sink unchanged
+*                keeps - KEEPS_NEVER, KEEPS_ALWAYS, or KEEPS_CHECK
+*                width - distance between the trimmer's tab stops, a power
+*                        of 2, or 0 to look the widths up
+*   Effects    : Trimmed output is passed to sink, and trimmer is updated
+*                to reflect the end of buf.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+static KERNEL_INLINE int FeedKernel(trimmer_t *trimmer, const char *buf,
+    size_t len, trim_sink_t sink, void *context, int keeps,
+    unsigned int width)
+{
+    const char *p, *end, *run, *next, *wide, *kept, *line;
+    unsigned int tab;
+    int status;
+
+    end = buf + len;
+    run = buf;      /* start of input not yet passed on or discarded */
+    kept = NULL;    /* start of kept whitespace pending in buf */
+    p = buf;
+    trimmer->stats.bytesIn += len;
+
+    if (EOL_AUTO == trimmer->eol)
+    {
+        TrimmerDetectEol(trimmer, buf, len);
+    }
+
+    if (TRIMMER_UTF8_CUT(trimmer, buf, len))
+    {
+        trimmer->pos++;
+        trimmer->ucsNeed = 0;
+    }
+
+    if (trimmer->cr && (0 != len))
+    {
+        /* the CR ending the last piece becomes one line ending; a kept
+         * one has been passed on already */
+        trimmer->cr = 0;
+
+        if ((EOL_KEEP != trimmer->eol) &&
+            (0 != (status = SinkEol(trimmer, NULL, 0, sink, context))))
+        {
+            return status;
+        }
+
+        if ('\n' == *p)
+        {
+            p++;
+
+            if (EOL_KEEP != trimmer->eol)
+            {
+                run = p;
+            }
+        }
+    }
+
+    line = p;       /* start of the line in buf */
+
+    /* runs before the first byte that isn't ASCII are a column a byte */
+    wide = trimmer->utf8 ? FindNonAscii(p, end) : end;
+
+    while (p < end)
+    {
+        switch (*p)
+        {
+            case '\r':
+                EndLine(trimmer, (uint64_t)(p - line),
+                    (NULL != kept) ? (uint64_t)(p - kept) : 0);
+
+                if (NULL != kept)
+                {
+                    /* drop trailing kept whitespace */
+                    if ((kept != run) && (0 != (status = Emit(trimmer, sink,
+                        context, run, kept - run))))
+                    {
+                        return status;
+                    }
+
+                    run = p;
+                    kept = NULL;
+                }
+
+                if (EOL_KEEP == trimmer->eol)
+                {
+                    /* an LF is part of the same line ending */
+                    if (p + 1 == end)
+                    {
+                        trimmer->cr = 1;
+                    }
+                    else if ('\n' == p[1])
+                    {
+                        p++;
+                    }
+
+                    p++;
+                }
+                else if ((p + 1 < end) && ('\n' == p[1]))
+                {
+                    /* CRLF is passed on, or drops its CR */
+                    if ((EOL_LF == trimmer->eol) && (p != run))
+                    {
+                        if (0 != (status = Emit(trimmer, sink, context, run,
+                            p - run)))
+                        {
+                            return status;
+                        }
+                    }
+
+                    if (EOL_LF == trimmer->eol)
+                    {
+                        run = p + 1;
+                    }
+
+                    p += 2;
+                }
+                else
+                {
+                    if (p + 1 == end)
+                    {
+                        /* wait for the next piece to convert it */
+                        status = (p != run) ?
+                            Emit(trimmer, sink, context, run, p - run) : 0;
+                        trimmer->cr = 1;
+                    }
+                    else
+                    {
+                        status = SinkEol(trimmer, run, p - run, sink, context);
+                    }
+
+                    if (0 != status)
+                    {
+                        return status;
+                    }
+
+                    p++;
+                    run = p;
+                }
+
+                line = p;
+                break;
+
+            case '\n':
+                EndLine(trimmer, (uint64_t)(p - line),
+                    (NULL != kept) ? (uint64_t)(p - kept) : 0);
+
+                if (NULL != kept)
+                {
+                    /* drop trailing kept whitespace */
+                    if ((kept != run) && (0 != (status = Emit(trimmer, sink,
+                        context, run, kept - run))))
+                    {
+                        return status;
+                    }
+
+                    run = p;
+                    kept = NULL;
+                }
+
+                if (EOL_CRLF == trimmer->eol)
+                {
+                    /* a bare LF */
+                    if (0 != (status = SinkEol(trimmer, run, p - run, sink,
+                        context)))
+                    {
+                        return status;
+                    }
+
+                    run = p + 1;
+                }
+
+                p++;
+                line = p;
+                break;
+
+            case ' ':
+                if (KERNEL_KEEPS(trimmer, keeps))
+                {
+                    /* leave it in buf until the line goes on or ends */
+                    if (NULL == kept)
+                    {
+                        kept = p;
+                    }
+
+                    p++;
+                    trimmer->pos++;
+                    break;
+                }
+
+                if (p != run)
+                {
+                    if (0 != (status = Emit(trimmer, sink, context, run,
+                        p - run)))
+                    {
+                        return status;
+                    }
+                }
+
+                p++;
+                run = p;
+                trimmer->spaces++;
+                trimmer->blanks++;
+                trimmer->pos++;
+                break;
+
+            case '\t':
+                if (KERNEL_KEEPS(trimmer, keeps))
+                {
+                    if (NULL == kept)
+                    {
+                        kept = p;
+                    }
+
+                    p++;
+                    trimmer->pos++;
+                    break;
+                }
+
+                if (p != run)
+                {
+                    if (0 != (status = Emit(trimmer, sink, context, run,
+                        p - run)))
+                    {
+                        return status;
+                    }
+                }
+
+                /* convert tab to spaces; look up width of tab */
+                p++;
+                run = p;
+
+                tab = KERNEL_TAB_WIDTH(trimmer, trimmer->pos, width);
+
+                trimmer->spaces += tab;
+                trimmer->blanks++;
+                trimmer->pos += tab;
+                trimmer->stats.tabs++;
+                break;
+
+            default:
+                if (0 != trimmer->heldWords)
+                {
+                    /* kept whitespace from the last piece goes first */
+                    if (0 != (status = SinkHeld(trimmer, sink, context)))
+                    {
+                        return status;
+                    }
+                }
+
+                /* kept whitespace in buf goes out with the run */
+                kept = NULL;
+
+                if (0 != trimmer->spaces)
+                {
+                    /* write out leading spaces too */
+                    if (TRIMMER_RETABS(trimmer))
+                    {
+                        status = SinkRetab(trimmer, sink, context);
+                    }
+                    else
+                    {
+                        status = SinkBlock(trimmer, spaceBlock,
+                            trimmer->spaces, sink, context);
+                    }
+
+                    if (0 != status)
+                    {
+                        return status;
+                    }
+
+                    trimmer->spaces = 0;
+                    trimmer->blanks = 0;
+                    run = p;
+                }
+
+                trimmer->leading = 0;
+
+                /* skip the rest of the run of ordinary characters */
+                next = FindSpecial(p + 1, end);
+
+                if (next <= wide)
+                {
+                    trimmer->pos += (uint64_t)(next - p);
+                }
+                else
+                {
+                    trimmer->pos += TrimmerRunWidth(trimmer, p, next, end);
+                    wide = FindNonAscii(next, end);
+                }
+
+                p = next;
+                break;
+        }
+    }
+
+    trimmer->lineLen += (uint64_t)(end - line);
+
+    if (NULL != kept)
+    {
+        /* hold it; it's trailing if the next piece ends the line */
+        if ((kept != run) &&
+            (0 != (status = Emit(trimmer, sink, context, run, kept - run))))
+        {
+            return status;
+        }
+
+        return HoldBlanks(trimmer, kept, end);
+    }
+
+    if (end != run)
+    {
+        return Emit(trimmer, sink, context, run, end - run);
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : FeedExpand2
+*   Description: This function is TrimmerFeed for a trimmer that expands
+*                tabs to stops every 2 columns.
+*   Parameters : trimmer - state carried between pieces of the stream
+*                buf - next piece of the stream
+*                len - number of bytes in buf
+*                sink - function that trimmed output is passed to
+*                context - passed to sink unchanged
+*   Effects    : Trimmed output is passed to sink, and trimmer is updated
+*                to reflect the end of buf.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+static int FeedExpand2(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context)
+{
+    return FeedKernel(trimmer, buf, len, sink, context, KEEPS_NEVER, 2);
+}
+
+/****************************************************************************
+*   Function   : FeedExpand4
+*   Description: This function is TrimmerFeed for a trimmer that expands
+*                tabs to stops every 4 columns.
+*   Parameters : trimmer - state carried between pieces of the stream
+*                buf - next piece of the stream
+*                len - number of bytes in buf
+*                sink - function that trimmed output is passed to
+*                context - passed to sink unchanged
+*   Effects    : Trimmed output is passed to sink, and trimmer is updated
+*                to reflect the end of buf.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+static int FeedExpand4(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context)
+{
+    return FeedKernel(trimmer, buf, len, sink, context, KEEPS_NEVER, 4);
+}
+
+/****************************************************************************
+*   Function   : FeedExpand8
+*   Description: This function is TrimmerFeed for a trimmer that expands
+*                tabs to stops every 8 columns.
+*   Parameters : trimmer - state carried between pieces of the stream
+*                buf - next piece of the stream
+*                len - number of bytes in buf
+*                sink - function that trimmed output is passed to
+*                context - passed to sink unchanged
+*   Effects    : Trimmed output is passed to sink, and trimmer is updated
+*                to reflect the end of buf.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+static int FeedExpand8(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context)
+{
+    return FeedKernel(trimmer, buf, len, sink, context, KEEPS_NEVER, 8);
+}
+
+/****************************************************************************
+*   Function   : FeedExpandAny
+*   Description: This function is TrimmerFeed for a trimmer that expands
+*                tabs to any other stops.
+*   Parameters : trimmer - state carried between pieces of the stream
+*                buf - next piece of the stream
+*                len - number of bytes in buf
+*                sink - function that trimmed output is passed to
+*                context - passed to sink unchanged
+*   Effects    : Trimmed output is passed to sink, and trimmer is updated
+*                to reflect the end of buf.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+static int FeedExpandAny(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context)
+{
+    return FeedKernel(trimmer, buf, len, sink, context, KEEPS_NEVER, 0);
+}
+
+/****************************************************************************
+*   Function   : FeedKeep
+*   Description: This function is TrimmerFeed for a trimmer that keeps tabs
+*                and doesn't retab, so it never needs the width of a tab.
+*   Parameters : trimmer - state carried between pieces of the stream
+*                buf - next piece of the stream
+*                len - number of bytes in buf
+*                sink - function that trimmed output is passed to
+*                context - passed to sink unchanged
+*   Effects    : Trimmed output is passed to sink, and trimmer is updated
+*                to reflect the end of buf.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+static int FeedKeep(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context)
+{
+    return FeedKernel(trimmer, buf, len, sink, context, KEEPS_ALWAYS, 0);
+}
+
+/****************************************************************************
+*   Function   : FeedAny
+*   Description: This function is TrimmerFeed for a trimmer that keeps tabs
+*                on some lines and retabs others, checking which as it goes.
+*   Parameters : trimmer - state carried between pieces of the stream
+*                buf - next piece of the stream
+*                len - number of bytes in buf
+*                sink - function that trimmed output is passed to
+*                context - passed to sink unchanged
+*   Effects    : Trimmed output is passed to sink, and trimmer is updated
+*                to reflect the end of buf.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+static int FeedAny(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context)
+{
+    return FeedKernel(trimmer, buf, len, sink, context, KEEPS_CHECK, 0);
+}
+
+/****************************************************************************
+*   Function   : PickFeed
+*   Description: This function picks the feed kernel TrimmerFeed uses for
+*                the options a trimmer was initialized with, so that none
+*                of those options are checked byte by byte.
+*   Parameters : trimmer - an initialized trimmer
+*   Effects    : None
+*   Returned   : The feed kernel for trimmer.
+****************************************************************************/
+static trim_feed_t PickFeed(const trimmer_t *trimmer)
+{
+    if (trimmer->keepTabs && (RETAB_ALL != trimmer->retab))
+    {
+        return (RETAB_NONE == trimmer->retab) ? FeedKeep : FeedAny;
+    }
+
+    /* tabs are always expanded (or retabbed, which needs their widths) */
+    if (0 == trimmer->last)
+    {
+        switch (trimmer->interval)
+        {
+            case 2:
+                return FeedExpand2;
+
+            case 4:
+                return FeedExpand4;
+
+            case 8:
+                return FeedExpand8;
+
+            default:
+                break;
+        }
+    }
+
+    return FeedExpandAny;
+}
+
+/****************************************************************************
+*   Function   : TrimmerFinish
+*   Description: This function ends a stream.  Whitespace still pending at
+*                the end of the stream is trailing whitespace, so it is
+*                dropped, and a CR still held is a line ending on its own.
+*                The trimmer is left ready for a new stream with the same
+*                options, but its counts go on from where they were.
+*   Parameters : trimmer - state of the stream
+*                sink - function that trimmed output is passed to
+*                context - passed to sink unchanged
+*   Effects    : Any remaining output is passed to sink, and trimmer is
+*                reset.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+int TrimmerFinish(trimmer_t *trimmer, trim_sink_t sink, void *context)
+{
+    int status;
+
+    status = 0;
+
+    if (trimmer->cr && (EOL_KEEP != trimmer->eol))
+    {
+        status = SinkEol(trimmer, NULL, 0, sink, context);
+    }
+
+    /* a last line without an ending */
+    if (trimmer->lineLen > trimmer->stats.longest)
+    {
+        trimmer->stats.longest = trimmer->lineLen;
+    }
+
+    trimmer->stats.trailing += trimmer->blanks;
+    trimmer->eol = trimmer->eolOpt;
+    trimmer->cr = 0;
+    trimmer->ucsNeed = 0;
+    trimmer->pos = 0;
+    trimmer->spaces = 0;
+    DropHeld(trimmer);
+    trimmer->blanks = 0;
+    trimmer->lineLen = 0;
+    trimmer->leading = 1;
+    trimmer->spaceCol = -1;
+    return status;
+}
+
+/****************************************************************************
+*   Function   : TrimmerFree
+*   Description: This function frees the memory a trimmer may hold for
+*                kept whitespace, for a stream that is given up before
+*                TrimmerFinish, such as when a sink fails.  It does
+*                nothing after TrimmerFinish.  The trimmer must be
+*                initialized again before it's used.
+*   Parameters : trimmer - trimmer to free
+*   Effects    : Any memory held by trimmer is freed.
+*   Returned   : None
+****************************************************************************/
+void TrimmerFree(trimmer_t *trimmer)
+{
+    DropHeld(trimmer);
+}
+
+/****************************************************************************
+*   Function   : TrimmerAddStats
+*   Description: This function adds the counts a trimmer has kept since it
+*                was initialized to a set of statistics.  The counts are
+*                plain fields of the trimmer, so each thread keeps its own
+*                without any locking or atomics.
+*   Parameters : trimmer - trimmer with counts
+*                stats - statistics the counts are added to
+*   Effects    : stats is updated.
+*   Returned   : None
+****************************************************************************/
+void TrimmerAddStats(const trimmer_t *trimmer, trim_stats_t *stats)
+{
+    TrimStatsAdd(stats, &trimmer->stats);
+}
+
+/****************************************************************************
+*   Function   : TrimStatsAdd
+*   Description: This function adds one set of statistics to another, as
+*                when totalling the files of a batch or the chunks of a
+*                file.  Times are summed, so a total for work done on
+*                several threads may be more than the time that passed.
+*   Parameters : total - statistics being added to
+*                add - statistics to add
+*   Effects    : total is updated.
+*   Returned   : None
+****************************************************************************/
+void TrimStatsAdd(trim_stats_t *total, const trim_stats_t *add)
+{
+    total->bytesIn += add->bytesIn;
+    total->bytesOut += add->bytesOut;
+    total->lines += add->lines;
+    total->tabs += add->tabs;
+    total->trailing += add->trailing;
+
+    if (add->longest > total->longest)
+    {
+        total->longest = add->longest;
+    }
+
+    total->readNs += add->readNs;
+    total->trimNs += add->trimNs;
+    total->writeNs += add->writeNs;
+}
+
+/****************************************************************************
+*   Function   : Emit
+*   Description: This function passes output to a sink, counting it.
+*   Parameters : trimmer - trimmer the output comes from
+*                sink - function the output is passed to
+*                context - passed to sink unchanged
+*                data - output
+*                len - number of bytes in data
+*   Effects    : data is passed to sink.
+*   Returned   : The value returned by sink.
+****************************************************************************/
+static int Emit(trimmer_t *trimmer, trim_sink_t sink, void *context,
+    const char *data, size_t len)
+{
+    trimmer->stats.bytesOut += len;
+    return sink(context, data, len);
+}
+
+/****************************************************************************
+*   Function   : EndLine
+*   Description: This function counts the end of a line and resets the
+*                trimmer for the next one.  Whitespace still pending is
+*                trailing, so it's dropped.
+*   Parameters : trimmer - trimmer at a line ending
+*                len - bytes of the line in the current piece
+*                kept - bytes of kept whitespace pending in the current
+*                       piece
+*   Effects    : trimmer's counts and line state are updated.
+*   Returned   : None
+****************************************************************************/
+static void EndLine(trimmer_t *trimmer, uint64_t len, uint64_t kept)
+{
+    len += trimmer->lineLen;
+
+    if (len > trimmer->stats.longest)
+    {
+        trimmer->stats.longest = len;
+    }
+
+    trimmer->stats.lines++;
+    trimmer->stats.trailing += trimmer->blanks + kept;
+    trimmer->pos = 0;
+    trimmer->spaces = 0;
+    DropHeld(trimmer);
+    trimmer->blanks = 0;
+    trimmer->lineLen = 0;
+    trimmer->leading = 1;
+}
+
+/****************************************************************************
+*   Function   : SinkBlock
+*   Description: This function passes a run of spaces or tabs to a sink,
+*                SPACE_BLOCK at a time, from one of the static blocks.  The
+*                count is 64 bits, so runs of any length are handled.
+*   Parameters : trimmer - trimmer counting the output
+*                block - spaceBlock or tabBlock
+*                count - number of characters
+*                sink - function the characters are passed to
+*                context - passed to sink unchanged
+*   Effects    : count characters are passed to sink.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+static int SinkBlock(trimmer_t *trimmer, const char *block, uint64_t count,
+    trim_sink_t sink, void *context)
+{
+    size_t chunk;
+    int status;
+
+    while (count > 0)
+    {
+        chunk = (count > SPACE_BLOCK) ? SPACE_BLOCK : (size_t)count;
+
+        if (0 != (status = Emit(trimmer, sink, context, block, chunk)))
+        {
+            return status;
+        }
+
+        count -= chunk;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : SinkRetab
+*   Description: This function passes the pending whitespace to a sink as
+*                the fewest tabs and spaces that reach the same column: a
+*                tab to each tab stop up to the end of the whitespace, then
+*                spaces.  A single space is left alone even if it reaches a
+*                stop, so words separated by one space stay that way.
+*   Parameters : trimmer - trimmer with whitespace pending
+*                sink - function the whitespace is passed to
+*                context - passed to sink unchanged
+*   Effects    : The whitespace is passed to sink.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+static int SinkRetab(trimmer_t *trimmer, trim_sink_t sink, void *context)
+{
+    uint64_t col, end, tabs;
+    unsigned int width;
+    int status;
+
+    if (1 == trimmer->spaces)
+    {
+        return SinkBlock(trimmer, spaceBlock, 1, sink, context);
+    }
+
+    end = trimmer->pos;
+    col = end - trimmer->spaces;
+    tabs = 0;
+
+    if (col >= trimmer->last)
+    {
+        /* evenly spaced stops; count the tabs without walking them */
+        width = TAB_WIDTH(trimmer, col);
+
+        if (width <= end - col)
+        {
+            col += width;
+            tabs = 1 + (end - col) / trimmer->interval;
+            col += (tabs - 1) * trimmer->interval;
+        }
+    }
+    else
+    {
+        while ((width = TAB_WIDTH(trimmer, col)) <= end - col)
+        {
+            col += width;
+            tabs++;
+        }
+    }
+
+    if (0 != (status = SinkBlock(trimmer, tabBlock, tabs, sink, context)))
+    {
+        return status;
+    }
+
+    return SinkBlock(trimmer, spaceBlock, end - col, sink, context);
+}
+
+/****************************************************************************
+*   Function   : HoldBlanks
+*   Description: This function adds kept whitespace that reaches the end of
+*                a piece of the stream to what the trimmer holds, a run of
+*                spaces or tabs at a time.
+*   Parameters : trimmer - trimmer keeping whitespace
+*                p - start of the whitespace
+*                end - end of the whitespace and the piece
+*   Effects    : The whitespace is added to trimmer's held words.
+*   Returned   : 0 for success, otherwise -1 with errno set to ENOMEM.
+****************************************************************************/
+static int HoldBlanks(trimmer_t *trimmer, const char *p, const char *end)
+{
+    const char *q;
+
+    while (p < end)
+    {
+        for (q = p + 1; (q < end) && (*q == *p); q++)
+        {
+        }
+
+        if (0 != HoldRun(trimmer, ('\t' == *p), (uint64_t)(q - p)))
+        {
+            return -1;
+        }
+
+        trimmer->blanks += (uint64_t)(q - p);
+        p = q;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : HoldRun
+*   Description: This function adds a run of spaces or tabs to the kept
+*                whitespace a trimmer holds.  A run that continues a held
+*                run is added to its count.  Otherwise the run fills out a
+*                bit map word that isn't full, and what's left of it
+*                becomes a run word if it would fill a bit map of its own,
+*                or starts a new bit map.  Only the last word may be a bit
+*                map that isn't full, so whitespace that switches between
+*                spaces and tabs takes no more than a bit a byte, and long
+*                runs take a word each.
+*   Parameters : trimmer - trimmer keeping whitespace
+*                tab - non-zero for a run of tabs
+*                count - length of the run
+*   Effects    : The run is added to trimmer's held words, which may grow.
+*   Returned   : 0 for success, otherwise -1 with errno set to ENOMEM.
+****************************************************************************/
+static int HoldRun(trimmer_t *trimmer, int tab, uint64_t count)
+{
+    uint64_t *word, *more;
+    uint64_t fill;
+    size_t size;
+
+    word = (0 == trimmer->heldWords) ? NULL :
+        HeldWord(trimmer, trimmer->heldWords - 1);
+
+    if ((NULL != word) && (0 != (*word & HELD_RUN)) &&
+        ((0 != (*word & HELD_TAB)) == tab))
+    {
+        /* it continues the last run */
+        *word += count;
+        return 0;
+    }
+
+    if (trimmer->heldBits < HELD_BITS)
+    {
+        /* fill out the last bit map */
+        fill = HELD_BITS - trimmer->heldBits;
+        fill = (count < fill) ? count : fill;
+
+        if (tab)
+        {
+            *word |= (((uint64_t)1 << fill) - 1) << trimmer->heldBits;
+        }
+
+        trimmer->heldBits += (unsigned int)fill;
+        count -= fill;
+
+        if (0 == count)
+        {
+            return 0;
+        }
+    }
+
+    if (TRIMMER_HELD_WORDS + trimmer->heldSize == trimmer->heldWords)
+    {
+        size = (0 == trimmer->heldSize) ? TRIMMER_HELD_WORDS :
+            2 * trimmer->heldSize;
+        more = (uint64_t *)realloc(trimmer->heldMore,
+            size * sizeof(uint64_t));
+
+        if (NULL == more)
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+
+        trimmer->heldMore = more;
+        trimmer->heldSize = size;
+    }
+
+    trimmer->heldWords++;
+    word = HeldWord(trimmer, trimmer->heldWords - 1);
+
+    if (count >= HELD_BITS)
+    {
+        *word = HELD_RUN | (tab ? HELD_TAB : 0) | count;
+        trimmer->heldBits = HELD_BITS;
+    }
+    else
+    {
+        *word = tab ? (((uint64_t)1 << count) - 1) : 0;
+        trimmer->heldBits = (unsigned int)count;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : SinkHeld
+*   Description: This function passes the kept whitespace a trimmer holds
+*                to a sink, once a character after it shows it isn't
+*                trailing.  Each run, whole or in a bit map, is passed on
+*                from one of the static blocks.
+*   Parameters : trimmer - trimmer holding whitespace
+*                sink - function the whitespace is passed to
+*                context - passed to sink unchanged
+*   Effects    : The held whitespace is passed to sink and emptied.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+static int SinkHeld(trimmer_t *trimmer, trim_sink_t sink, void *context)
+{
+    uint64_t word;
+    unsigned int bits, i, start;
+    size_t w;
+    int status;
+
+    for (w = 0; w < trimmer->heldWords; w++)
+    {
+        word = *HeldWord(trimmer, w);
+
+        if (0 != (word & HELD_RUN))
+        {
+            status = SinkBlock(trimmer,
+                (0 != (word & HELD_TAB)) ? tabBlock : spaceBlock,
+                word & HELD_COUNT, sink, context);
+
+            if (0 != status)
+            {
+                return status;
+            }
+
+            continue;
+        }
+
+        bits = (w + 1 == trimmer->heldWords) ? trimmer->heldBits : HELD_BITS;
+
+        for (start = 0; start < bits; start = i)
+        {
+            /* the bits that match the first make one run */
+            for (i = start + 1; (i < bits) &&
+                (((word >> i) & 1) == ((word >> start) & 1)); i++)
+            {
+            }
+
+            status = SinkBlock(trimmer,
+                (0 != ((word >> start) & 1)) ? tabBlock : spaceBlock,
+                i - start, sink, context);
+
+            if (0 != status)
+            {
+                return status;
+            }
+        }
+    }
+
+    DropHeld(trimmer);
+    trimmer->blanks = 0;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : HeldWord
+*   Description: This function finds where a trimmer holds one of its
+*                words of kept whitespace.
+*   Parameters : trimmer - trimmer holding whitespace
+*                i - index of the word, less than heldWords
+*   Effects    : None
+*   Returned   : Pointer to the word.
+****************************************************************************/
+static uint64_t *HeldWord(trimmer_t *trimmer, size_t i)
+{
+    return (i < TRIMMER_HELD_WORDS) ? &trimmer->held[i] :
+        &trimmer->heldMore[i - TRIMMER_HELD_WORDS];
+}
+
+/****************************************************************************
+*   Function   : DropHeld
+*   Description: This function empties a trimmer's held kept whitespace
+*                and frees any memory it took.
+*   Parameters : trimmer - trimmer holding whitespace
+*   Effects    : The held whitespace is emptied.
+*   Returned   : None
+****************************************************************************/
+static void DropHeld(trimmer_t *trimmer)
+{
+    trimmer->heldWords = 0;
+    trimmer->heldBits = HELD_BITS;
+
+    if (NULL != trimmer->heldMore)
+    {
+        free(trimmer->heldMore);
+        trimmer->heldMore = NULL;
+        trimmer->heldSize = 0;
+    }
+}
+
+/****************************************************************************
+*   Function   : SinkEol
+*   Description: This function passes the end of a line to a sink: the
+*                characters before the line ending, then the line ending
+*                the trimmer writes in place of the one in the input.
+*   Parameters : trimmer - trimmer converting line endings
+*                run - characters before the line ending, may be NULL
+*                len - number of characters in run
+*                sink - function the line end is passed to
+*                context - passed to sink unchanged
+*   Effects    : The run and a line ending are passed to sink.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+static int SinkEol(trimmer_t *trimmer, const char *run, size_t len,
+    trim_sink_t sink, void *context)
+{
+    int status;
+
+    if ((0 != len) &&
+        (0 != (status = Emit(trimmer, sink, context, run, len))))
+    {
+        return status;
+    }
+
+    if (EOL_CRLF == trimmer->eol)
+    {
+        return Emit(trimmer, sink, context, crlf, 2);
+    }
+
+    return Emit(trimmer, sink, context, crlf + 1, 1);
+}
+
+/****************************************************************************
+*   Function   : NextStop
+*   Description: This function parses the next column of a tab stop list.
+*   Parameters : list - pointer to the current position in the list; it's
+*                       moved past the column and any following comma
+*                stop - set to the column
+*   Effects    : *list is advanced.
+*   Returned   : 0 for success, -1 if the list isn't a number followed by
+*                a comma or the end of the list.
+****************************************************************************/
+static int NextStop(const char **list, unsigned long *stop)
+{
+    const char *p;
+
+    p = *list;
+    *stop = 0;
+
+    if ((*p < '0') || (*p > '9'))
+    {
+        return -1;
+    }
+
+    while ((*p >= '0') && (*p <= '9'))
+    {
+        if (*stop <= TRIMMER_MAX_TAB)
+        {
+            *stop = (*stop * 10) + (*p - '0');
+        }
+
+        p++;
+    }
+
+    if (',' == *p)
+    {
+        p++;
+
+        if ('\0' == *p)
+        {
+            return -1;      /* trailing comma */
+        }
+    }
+    else if ('\0' != *p)
+    {
+        return -1;
+    }
+
+    *list = p;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : TrimmerFeedRanges
+*   Description: This function trims only some lines of a stream that is
+*                entirely in memory, such as the lines a change added to a
+*                file.  The bytes between ranges are passed to the sink in
+*                one piece each without going through the state machine,
+*                so the cost depends mostly on the size of the ranges.
+*                Lines end with LF, like the lines of a diff.  Each range
+*                starts at the beginning of a line, where the trimmer's
+*                state is always reset, and only a range that reaches the
+*                end of the stream needs TrimmerFinish.  Line endings are
+*                detected from the start of the whole stream.
+*   Parameters : trimmer - state of a new stream
+*                buf - the whole stream
+*                len - number of bytes in buf
+*                ranges - lines to trim, in increasing order without
+*                         overlaps
+*                count - number of ranges
+*                sink - function that output is passed to
+*                context - passed to sink unchanged
+*   Effects    : Passes the stream, with the lines in ranges trimmed, to
+*                sink.  The trimmer is left ready for a new stream.
+*   Returned   : 0 for success, otherwise the non-zero value returned by
+*                sink.
+****************************************************************************/
+int TrimmerFeedRanges(trimmer_t *trimmer, const char *buf, size_t len,
+    const line_range_t *ranges, size_t count, trim_sink_t sink,
+    void *context)
+{
+    size_t i, pos, start;
+    uint64_t line;
+    int status;
+
+    pos = 0;
+    line = 1;
+    TrimmerDetectEol(trimmer, buf, len);
+
+    for (i = 0; (i < count) && (pos < len); i++)
+    {
+        /* copy the lines before the range untouched */
+        start = pos;
+        pos = TrimmerSkipLines(buf, len, pos, line, ranges[i].first);
+        line = ranges[i].first;
+
+        trimmer->stats.bytesIn += pos - start;
+
+        if ((pos > start) && (0 != (status = Emit(trimmer, sink, context,
+            buf + start, pos - start))))
+        {
+            return status;
+        }
+
+        /* trim the range */
+        start = pos;
+        pos = TrimmerSkipLines(buf, len, pos, line, ranges[i].last + 1);
+        line = ranges[i].last + 1;
+
+        if (0 != (status = TrimmerFeed(trimmer, buf + start, pos - start,
+            sink, context)))
+        {
+            return status;
+        }
+    }
+
+    if (pos < len)
+    {
+        trimmer->stats.bytesIn += len - pos;
+        status = Emit(trimmer, sink, context, buf + pos, len - pos);
+    }
+    else
+    {
+        status = TrimmerFinish(trimmer, sink, context);
+    }
+
+    /* ready for a new stream, as if TrimmerFinish had been called */
+    trimmer->eol = trimmer->eolOpt;
+    return status;
+}
+
+/****************************************************************************
+*   Function   : TrimmerSkipLines
+*   Description: This function finds the start of a line by searching for
+*                line feeds with memchr, so skipped lines cost little more
+*                than reading them.
+*   Parameters : buf - the whole stream
+*                len - number of bytes in buf
+*                from - offset of the start of a line
+*                line - number of the line starting at from
+*                target - number of the line to find.  If it's before
+*                         line, from is returned.
+*   Effects    : None
+*   Returned   : Offset of the start of line target, or len if the stream
+*                has fewer lines.
+****************************************************************************/
+size_t TrimmerSkipLines(const char *buf, size_t len, size_t from,
+    uint64_t line, uint64_t target)
+{
+    const char *lf;
+
+    while ((line < target) && (from < len))
+    {
+        lf = (const char *)memchr(buf + from, '\n', len - from);
+
+        if (NULL == lf)
+        {
+            return len;
+        }
+
+        from = (size_t)(lf - buf) + 1;
+        line++;
+    }
+
+    return from;
+}
@@ -0,0 +1,236 @@
+/***************************************************************************
+*                   Tab Remover and Trailing Space Trimmer
+*
+*   File    : trimmer.h
+*   Purpose : Header for the streaming trimmer library (libtrim.a)
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef TRIMMER_H
+#define TRIMMER_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+/* whitespace rewritten as tabs and spaces (trim_opts_t retab) */
+#define RETAB_NONE      0       /* expand (or keep) tabs */
+#define RETAB_LEADING   1       /* retab whitespace at the start of lines */
+#define RETAB_ALL       2       /* retab all whitespace */
+
+/* line endings written (trim_opts_t eol) */
+#define EOL_KEEP        0       /* leave line endings as they are */
+#define EOL_LF          1       /* end every line with LF */
+#define EOL_CRLF        2       /* end every line with CRLF */
+#define EOL_AUTO        3       /* end every line like most of the first
+                                 * 64K of the stream */
+
+/* largest tab size, and largest column of a tab stop list */
+#define TRIMMER_MAX_TAB     65536
+
+/* bytes at the start of a stream EOL_AUTO picks line endings from.  A
+ * stream read in pieces should start with a piece this long, or all of the
+ * stream if it's shorter, so the choice doesn't depend on how reads split
+ * it. */
+#define TRIMMER_EOL_SAMPLE  (64 * 1024)
+
+/* 64 bit words of kept whitespace that a trimmer_t holds in itself while
+ * waiting for the next piece of a stream.  A word holds a run of spaces or
+ * of tabs of any length, or up to 63 bytes that mix them, one bit a byte.
+ * More words are held in memory TrimmerFeed allocates. */
+#define TRIMMER_HELD_WORDS  8
+
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+/* non-zero if the pending whitespace of a trimmer_t will be retabbed */
+#define TRIMMER_RETABS(t) ((RETAB_ALL == (t)->retab) || \
+    ((RETAB_LEADING == (t)->retab) && (t)->leading))
+
+/* non-zero if whitespace a trimmer_t reaches is kept as it is, unless it's
+ * trailing */
+#define TRIMMER_KEEPS(t) ((t)->keepTabs && !TRIMMER_RETABS(t))
+
+/* non-zero if a piece of a stream starting with buf doesn't finish the
+ * UTF-8 sequence the last piece of a trimmer_t ended in */
+#define TRIMMER_UTF8_CUT(t, buf, len) ((0 != (t)->ucsNeed) && \
+    (0 != (len)) && (0x80 != ((buf)[0] & 0xC0)))
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+/* tab stops compiled so the width of any tab is found in O(1) */
+typedef struct tab_stops_t
+{
+    unsigned int *widths;       /* width of a tab at each column < last */
+    unsigned int last;          /* column of the last listed stop */
+    unsigned int interval;      /* distance between stops from last on */
+} tab_stops_t;
+
+/* what trimming a stream did.  A trimmer_t counts everything but the
+ * times, which are measured by the functions in trimfile.h. */
+typedef struct trim_stats_t
+{
+    uint64_t bytesIn;           /* bytes of input */
+    uint64_t bytesOut;          /* bytes of output */
+    uint64_t lines;             /* line endings; CRLF is one */
+    uint64_t tabs;              /* tabs expanded or retabbed, even if they
+                                 * turn out to be trailing */
+    uint64_t trailing;          /* bytes of trailing whitespace removed */
+    uint64_t longest;           /* bytes in the longest line, not counting
+                                 * its ending */
+    uint64_t readNs;            /* time spent reading and decompressing */
+    uint64_t trimNs;            /* time spent trimming */
+    uint64_t writeNs;           /* time spent compressing and writing */
+} trim_stats_t;
+
+typedef struct trim_opts_t
+{
+    unsigned int tabSize;       /* columns between tab stops */
+    const tab_stops_t *tabStops;    /* custom tab stops, or NULL */
+    unsigned int keepTabs;      /* non-zero if tabs are not expanded */
+    unsigned int retab;         /* RETAB_NONE, RETAB_LEADING or RETAB_ALL */
+    unsigned int eol;           /* EOL_KEEP, EOL_LF, EOL_CRLF or EOL_AUTO */
+    unsigned int utf8;          /* non-zero to count display columns of
+                                 * UTF-8 instead of bytes */
+    unsigned int jobs;          /* threads that may trim one mapped file */
+    unsigned int pipeline;      /* non-zero to read, trim, write streams
+                                 * on separate threads */
+    unsigned int codec;         /* format output is compressed in; a
+                                 * CODEC_ value from codec.h */
+    trim_stats_t *stats;        /* the file functions add the counts and
+                                 * times of each stream here, or NULL */
+} trim_opts_t;
+
+/* lines first through last of a stream, counting from 1 */
+typedef struct line_range_t
+{
+    uint64_t first;
+    uint64_t last;
+} line_range_t;
+
+/* receives trimmed output.  data is only valid during the call.  Returns 0
+ * to continue, or non-zero to stop trimming. */
+typedef int (*trim_sink_t)(void *context, const char *data, size_t len);
+
+struct trimmer_t;
+
+/* the kernel TrimmerFeed runs for a trimmer's options */
+typedef int (*trim_feed_t)(struct trimmer_t *trimmer, const char *buf,
+    size_t len, trim_sink_t sink, void *context);
+
+/* state of one stream being trimmed; the fields are private */
+typedef struct trimmer_t
+{
+    const unsigned int *widths; /* tab widths before the last stop */
+    unsigned int last;          /* column of the last listed stop */
+    unsigned int interval;      /* distance between stops from last on */
+    unsigned int keepTabs;      /* non-zero if tabs are not expanded */
+    unsigned int retab;         /* whitespace rewritten as tabs and spaces */
+    unsigned int eolOpt;        /* line endings asked for */
+    unsigned int eol;           /* line endings written; EOL_AUTO until
+                                 * they're detected */
+    int cr;                     /* the last piece ended with a CR; an LF
+                                 * may follow */
+    unsigned int utf8;          /* non-zero if columns are display width */
+    uint32_t ucs;               /* bits of an unfinished UTF-8 sequence */
+    unsigned int ucsNeed;       /* bytes the sequence still needs */
+    uint64_t pos;               /* column of the next character */
+    uint64_t spaces;            /* whitespace pending a non-space character */
+    uint64_t held[TRIMMER_HELD_WORDS];  /* kept whitespace pending from
+                                 * earlier pieces, as runs and bit maps */
+    uint64_t *heldMore;         /* words after the first
+                                 * TRIMMER_HELD_WORDS, or NULL */
+    size_t heldSize;            /* number of words heldMore has room for */
+    size_t heldWords;           /* number of words in held and heldMore */
+    unsigned int heldBits;      /* bytes in the last word if it's a bit
+                                 * map that isn't full */
+    uint64_t blanks;            /* bytes of input whitespace pending */
+    uint64_t lineLen;           /* bytes of the line in earlier pieces */
+    trim_stats_t stats;         /* counts since TrimmerInit */
+    int leading;                /* nothing but whitespace on the line yet */
+    int64_t spaceCol;           /* column of the first space pending, or -1;
+                                 * only used to find changes */
+    trim_feed_t feed;           /* TrimmerFeed's kernel for these options */
+} trimmer_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* compiles a comma separated list of tab stop columns, such as "8,12,20";
+ * the last interval repeats */
+int TabStopsInit(tab_stops_t *stops, const char *list);
+
+/* frees the table made by TabStopsInit */
+void TabStopsFree(tab_stops_t *stops);
+
+/* returns the width of a tab at column col */
+unsigned int TrimmerTabWidth(const trimmer_t *trimmer, uint64_t col);
+
+/* prepares trimmer for the start of a stream */
+void TrimmerInit(trimmer_t *trimmer, const trim_opts_t *opts);
+
+/* picks the line endings of an EOL_AUTO trimmer from the start of a stream */
+void TrimmerDetectEol(trimmer_t *trimmer, const char *buf, size_t len);
+
+/* returns the display width of the run of ordinary characters [p, next);
+ * end is the end of the piece of the stream holding it */
+uint64_t TrimmerRunWidth(trimmer_t *trimmer, const char *p,
+    const char *next, const char *end);
+
+/* trims the next len bytes of the stream, passing the output to sink.
+ * Kept whitespace that a piece ends in may be held in allocated memory. */
+int TrimmerFeed(trimmer_t *trimmer, const char *buf, size_t len,
+    trim_sink_t sink, void *context);
+
+/* ends the stream, passing any remaining output to sink */
+int TrimmerFinish(trimmer_t *trimmer, trim_sink_t sink, void *context);
+
+/* frees what a trimmer holds for a stream given up without TrimmerFinish */
+void TrimmerFree(trimmer_t *trimmer);
+
+/* adds the counts trimmer has kept since TrimmerInit to stats */
+void TrimmerAddStats(const trimmer_t *trimmer, trim_stats_t *stats);
+
+/* adds the counts and times in add to total; longest is the larger */
+void TrimStatsAdd(trim_stats_t *total, const trim_stats_t *add);
+
+/* trims only the listed lines of a whole stream, passing the rest through */
+int TrimmerFeedRanges(trimmer_t *trimmer, const char *buf, size_t len,
+    const line_range_t *ranges, size_t count, trim_sink_t sink,
+    void *context);
+
+/* returns the offset of the start of line target, counting from line at
+ * offset from, or len if the stream ends first */
+size_t TrimmerSkipLines(const char *buf, size_t len, size_t from,
+    uint64_t line, uint64_t target);
+
+#endif  /* ndef TRIMMER_H */
@@ -0,0 +1,756 @@
+/***************************************************************************
+*                            Batched File Loader
+*
+*   File    : uring.c
+*   Purpose : Open, stat, read, and close batches of small files with a
+*             few io_uring system calls instead of several calls each
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE     /* syscall() */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include "uring.h"
+
+#if defined(__linux__) && !defined(NO_URING)
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/stat.h>
+#include <linux/io_uring.h>
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define RING_ENTRIES    (2 * URING_BATCH)   /* an open and a statx each */
+
+/* operations, kept in the low bits of each entry's user_data */
+#define OP_OPEN         0
+#define OP_STATX        1
+#define OP_READ         2
+#define OP_CLOSE        3
+#define OP_BITS         2
+
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+/* user_data of an entry for operation op on the file at index i */
+#define USER_DATA(i, op)    (((uint64_t)(i) << OP_BITS) | (op))
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+struct uring_t
+{
+    int fd;                     /* io_uring descriptor */
+    void *sqMap;                /* submission ring mapping */
+    size_t sqMapLen;
+    void *cqMap;                /* completion ring mapping, maybe sqMap */
+    size_t cqMapLen;
+    struct io_uring_sqe *sqes;  /* submission queue entries */
+    size_t sqesLen;
+    unsigned int *sqHead;
+    unsigned int *sqTail;
+    unsigned int sqMask;
+    unsigned int *sqArray;
+    unsigned int *cqHead;
+    unsigned int *cqTail;
+    unsigned int cqMask;
+    struct io_uring_cqe *cqes;
+    unsigned int pending;       /* entries queued but not submitted */
+    int broken;                 /* completions may still be outstanding, so
+                                 * the ring can't be used again */
+
+    int fixed;                  /* non-zero if the buffers are registered */
+    char *buffers;              /* slots * slotSize bytes */
+    size_t slotSize;            /* size of each buffer */
+    int *freeSlots;             /* stack of unused buffers */
+    unsigned int freeCount;     /* number of unused buffers */
+    pthread_mutex_t lock;       /* protects the free stack */
+
+    struct statx stx[URING_BATCH];  /* statx results of a load */
+};
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static int Probe(int fd);
+static struct io_uring_sqe *GetSqe(uring_t *ring);
+static int SubmitAndWait(uring_t *ring, uring_file_t **files, int *ok);
+static size_t Abandon(uring_t *ring, uring_file_t **files, size_t count);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : UringCreate
+*   Description: This function sets up an io_uring and a set of buffers to
+*                load files into.  The buffers are registered with the
+*                kernel if it allows, so reads into them skip mapping user
+*                pages on every call.  If they can't be registered, plain
+*                reads are used instead.
+*   Parameters : slots - number of buffers, the most files that may be
+*                        loaded but not yet released
+*                slotSize - size of each buffer.  Only files smaller than
+*                           this are read into one.
+*   Effects    : Creates an io_uring and allocates its buffers.
+*   Returned   : Pointer to the ring, or NULL if io_uring isn't available
+*                or doesn't support the operations needed.
+****************************************************************************/
+uring_t *UringCreate(unsigned int slots, size_t slotSize)
+{
+    uring_t *ring;
+    struct io_uring_params params;
+    struct iovec *iov;
+    unsigned int i;
+    char *sq, *cq;
+
+    ring = (uring_t *)calloc(1, sizeof(uring_t));
+
+    if (NULL == ring)
+    {
+        return NULL;
+    }
+
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+
+    if (ring->fd < 0)
+    {
+        free(ring);
+        return NULL;
+    }
+
+    if (!Probe(ring->fd))
+    {
+        close(ring->fd);
+        free(ring);
+        return NULL;
+    }
+
+    pthread_mutex_init(&ring->lock, NULL);
+    ring->sqMapLen = params.sq_off.array +
+        params.sq_entries * sizeof(unsigned int);
+    ring->cqMapLen = params.cq_off.cqes +
+        params.cq_entries * sizeof(struct io_uring_cqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cqMapLen > ring->sqMapLen)
+        {
+            ring->sqMapLen = ring->cqMapLen;
+        }
+
+        ring->cqMapLen = ring->sqMapLen;
+    }
+
+    ring->sqMap = mmap(NULL, ring->sqMapLen, PROT_READ | PROT_WRITE,
+        MAP_SHARED, ring->fd, IORING_OFF_SQ_RING);
+    ring->cqMap = MAP_FAILED;
+    ring->sqes = (struct io_uring_sqe *)MAP_FAILED;
+
+    if (MAP_FAILED != ring->sqMap)
+    {
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            ring->cqMap = ring->sqMap;
+        }
+        else
+        {
+            ring->cqMap = mmap(NULL, ring->cqMapLen, PROT_READ | PROT_WRITE,
+                MAP_SHARED, ring->fd, IORING_OFF_CQ_RING);
+        }
+
+        ring->sqesLen = params.sq_entries * sizeof(struct io_uring_sqe);
+        ring->sqes = (struct io_uring_sqe *)mmap(NULL, ring->sqesLen,
+            PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, IORING_OFF_SQES);
+    }
+
+    ring->buffers = (char *)malloc((size_t)slots * slotSize);
+    ring->freeSlots = (int *)malloc(slots * sizeof(int));
+
+    if ((MAP_FAILED == ring->cqMap) ||
+        ((struct io_uring_sqe *)MAP_FAILED == ring->sqes) ||
+        (NULL == ring->buffers) || (NULL == ring->freeSlots))
+    {
+        UringDestroy(ring);
+        return NULL;
+    }
+
+    sq = (char *)ring->sqMap;
+    cq = (char *)ring->cqMap;
+    ring->sqHead = (unsigned int *)(sq + params.sq_off.head);
+    ring->sqTail = (unsigned int *)(sq + params.sq_off.tail);
+    ring->sqMask = *(unsigned int *)(sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned int *)(sq + params.sq_off.array);
+    ring->cqHead = (unsigned int *)(cq + params.cq_off.head);
+    ring->cqTail = (unsigned int *)(cq + params.cq_off.tail);
+    ring->cqMask = *(unsigned int *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    ring->pending = 0;
+    ring->broken = 0;
+
+    ring->slotSize = slotSize;
+    ring->freeCount = slots;
+
+    for (i = 0; i < slots; i++)
+    {
+        ring->freeSlots[i] = (int)(slots - 1 - i);
+    }
+
+    /* registering pins the buffers; it may be refused by the memlock limit */
+    iov = (struct iovec *)malloc(slots * sizeof(struct iovec));
+
+    if (NULL != iov)
+    {
+        for (i = 0; i < slots; i++)
+        {
+            iov[i].iov_base = ring->buffers + (size_t)i * slotSize;
+            iov[i].iov_len = slotSize;
+        }
+
+        ring->fixed = (0 == syscall(__NR_io_uring_register, ring->fd,
+            IORING_REGISTER_BUFFERS, iov, slots));
+        free(iov);
+    }
+
+    return ring;
+}
+
+/****************************************************************************
+*   Function   : UringDestroy
+*   Description: This function tears down a ring made by UringCreate.
+*                Every loaded file should have been released.
+*   Parameters : ring - ring to destroy, may be NULL
+*   Effects    : Closes the io_uring and frees its buffers.
+*   Returned   : None
+****************************************************************************/
+void UringDestroy(uring_t *ring)
+{
+    if (NULL == ring)
+    {
+        return;
+    }
+
+    if ((struct io_uring_sqe *)MAP_FAILED != ring->sqes)
+    {
+        munmap(ring->sqes, ring->sqesLen);
+    }
+
+    if ((MAP_FAILED != ring->cqMap) && (ring->cqMap != ring->sqMap))
+    {
+        munmap(ring->cqMap, ring->cqMapLen);
+    }
+
+    if (MAP_FAILED != ring->sqMap)
+    {
+        munmap(ring->sqMap, ring->sqMapLen);
+    }
+
+    /* closing the ring unregisters the buffers */
+    close(ring->fd);
+    pthread_mutex_destroy(&ring->lock);
+    free(ring->buffers);
+    free(ring->freeSlots);
+    free(ring);
+}
+
+/****************************************************************************
+*   Function   : UringLoad
+*   Description: This function loads a batch of files with three trips
+*                into the kernel: one that opens and stats every file, one
+*                that reads every small regular file into a buffer, and
+*                one that closes the files that were read.  Loading each
+*                file the ordinary way takes several system calls.  A file
+*                that can't be read whole into a buffer (a big file, a
+*                pipe, or a file that grew) is left open for the caller to
+*                read.  Only as many files are handled as there are free
+*                buffers.
+*   Parameters : ring - ring made by UringCreate
+*                files - files to load, with their paths set
+*                count - number of files
+*   Effects    : Sets the fd, slot, data, len, and err of the files
+*                handled.  Each slot must be passed to UringRelease.
+*   Returned   : The number of files handled, from the start of files.
+*                Zero if every buffer is in use, or if the ring failed and
+*                the files must be opened the ordinary way.
+****************************************************************************/
+size_t UringLoad(uring_t *ring, uring_file_t **files, size_t count)
+{
+    struct io_uring_sqe *sqe;
+    uring_file_t *file;
+    int ok[URING_BATCH];
+    size_t i;
+    int queued;
+
+    pthread_mutex_lock(&ring->lock);
+
+    /* a file can only be read into a buffer reserved for it */
+    if (count > ring->freeCount)
+    {
+        count = ring->freeCount;
+    }
+
+    pthread_mutex_unlock(&ring->lock);
+
+    if (count > URING_BATCH)
+    {
+        count = URING_BATCH;
+    }
+
+    if ((0 == count) || ring->broken)
+    {
+        return 0;
+    }
+
+    /* open and stat each file */
+    for (i = 0; i < count; i++)
+    {
+        file = files[i];
+        file->fd = -1;
+        file->slot = -1;
+        file->data = NULL;
+        file->len = 0;
+        file->err = 0;
+
+        sqe = GetSqe(ring);
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t)(uintptr_t)file->path;
+        sqe->open_flags = O_RDONLY;
+        sqe->user_data = USER_DATA(i, OP_OPEN);
+
+        sqe = GetSqe(ring);
+        sqe->opcode = IORING_OP_STATX;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t)(uintptr_t)file->path;
+        sqe->len = STATX_TYPE | STATX_SIZE;
+        sqe->off = (uint64_t)(uintptr_t)&ring->stx[i];
+        sqe->user_data = USER_DATA(i, OP_STATX);
+        ok[i] = 0;
+    }
+
+    if (0 != SubmitAndWait(ring, files, ok))
+    {
+        return Abandon(ring, files, count);
+    }
+
+    /* read the small regular files */
+    queued = 0;
+    pthread_mutex_lock(&ring->lock);
+
+    for (i = 0; i < count; i++)
+    {
+        file = files[i];
+
+        if ((file->fd < 0) || !ok[i] || !S_ISREG(ring->stx[i].stx_mode) ||
+            (ring->stx[i].stx_size >= ring->slotSize))
+        {
+            continue;
+        }
+
+        file->slot = ring->freeSlots[--ring->freeCount];
+        file->data = ring->buffers + (size_t)file->slot * ring->slotSize;
+
+        sqe = GetSqe(ring);
+        sqe->opcode = ring->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->fd = file->fd;
+        sqe->addr = (uint64_t)(uintptr_t)file->data;
+        sqe->len = (unsigned int)ring->slotSize;
+        sqe->off = 0;
+        sqe->buf_index = ring->fixed ? (unsigned short)file->slot : 0;
+        sqe->user_data = USER_DATA(i, OP_READ);
+        ok[i] = 0;
+        queued = 1;
+    }
+
+    pthread_mutex_unlock(&ring->lock);
+
+    if (!queued)
+    {
+        return count;
+    }
+
+    if (0 != SubmitAndWait(ring, files, ok))
+    {
+        return Abandon(ring, files, count);
+    }
+
+    /* close the files that were read whole */
+    queued = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        file = files[i];
+
+        if (file->slot < 0)
+        {
+            continue;
+        }
+
+        if (!ok[i] || (file->len >= ring->slotSize))
+        {
+            /* it failed or grew; reading from the start is harmless */
+            UringRelease(ring, file->slot);
+            file->slot = -1;
+            file->data = NULL;
+            file->len = 0;
+            continue;
+        }
+
+        sqe = GetSqe(ring);
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->fd = file->fd;
+        sqe->user_data = USER_DATA(i, OP_CLOSE);
+        queued = 1;
+    }
+
+    if (queued && (0 != SubmitAndWait(ring, files, ok)) && !ring->broken)
+    {
+        /* the files are in their buffers; close what the ring didn't */
+        for (i = 0; i < count; i++)
+        {
+            if ((files[i]->slot >= 0) && (files[i]->fd >= 0))
+            {
+                close(files[i]->fd);
+                files[i]->fd = -1;
+            }
+        }
+    }
+
+    return count;
+}
+
+/****************************************************************************
+*   Function   : Abandon
+*   Description: This function undoes a load that failed part way, after
+*                SubmitAndWait has collected every completion, so that the
+*                files can be opened the ordinary way.
+*   Parameters : ring - ring the files were being loaded by
+*                files - files being loaded
+*                count - number of files
+*   Effects    : Closes any of the files the ring opened and releases
+*                their buffers, unless the ring is broken and a read may
+*                still land in them.
+*   Returned   : 0, the number of files handled
+****************************************************************************/
+static size_t Abandon(uring_t *ring, uring_file_t **files, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if ((files[i]->slot >= 0) && !ring->broken)
+        {
+            UringRelease(ring, files[i]->slot);
+        }
+
+        if (files[i]->fd >= 0)
+        {
+            close(files[i]->fd);
+        }
+
+        files[i]->fd = -1;
+        files[i]->slot = -1;
+        files[i]->data = NULL;
+        files[i]->len = 0;
+        files[i]->err = 0;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : UringRelease
+*   Description: This function returns the buffer holding a loaded file so
+*                it can be reused.  It may be called from any thread.
+*   Parameters : ring - ring the file was loaded by
+*                slot - buffer returned in the file's slot
+*   Effects    : The buffer is free to be loaded into again.
+*   Returned   : None
+****************************************************************************/
+void UringRelease(uring_t *ring, int slot)
+{
+    pthread_mutex_lock(&ring->lock);
+    ring->freeSlots[ring->freeCount++] = slot;
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/****************************************************************************
+*   Function   : Probe
+*   Description: This function asks the kernel whether it supports every
+*                io_uring operation used to load files.
+*   Parameters : fd - io_uring descriptor
+*   Effects    : None
+*   Returned   : Non-zero if every operation is supported.
+****************************************************************************/
+static int Probe(int fd)
+{
+    static const unsigned char needed[] = {IORING_OP_OPENAT,
+        IORING_OP_STATX, IORING_OP_READ, IORING_OP_READ_FIXED,
+        IORING_OP_CLOSE};
+    struct io_uring_probe *probe;
+    size_t size, i;
+    int ok;
+
+    size = sizeof(struct io_uring_probe) +
+        256 * sizeof(struct io_uring_probe_op);
+    probe = (struct io_uring_probe *)calloc(1, size);
+
+    if (NULL == probe)
+    {
+        return 0;
+    }
+
+    ok = (0 == syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE,
+        probe, 256));
+
+    for (i = 0; ok && (i < sizeof(needed)); i++)
+    {
+        ok = (needed[i] <= probe->last_op) &&
+            (probe->ops[needed[i]].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    free(probe);
+    return ok;
+}
+
+/****************************************************************************
+*   Function   : GetSqe
+*   Description: This function claims the next submission queue entry.
+*                The ring is sized so a load never runs out of entries.
+*   Parameters : ring - ring to queue on
+*   Effects    : Queues a cleared entry to be submitted by SubmitAndWait.
+*   Returned   : Pointer to the entry.
+****************************************************************************/
+static struct io_uring_sqe *GetSqe(uring_t *ring)
+{
+    struct io_uring_sqe *sqe;
+    unsigned int tail, index;
+
+    tail = *ring->sqTail + ring->pending;
+    index = tail & ring->sqMask;
+    sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sqArray[index] = index;
+    ring->pending++;
+    return sqe;
+}
+
+/****************************************************************************
+*   Function   : SubmitAndWait
+*   Description: This function submits every queued entry and waits for
+*                all of them to complete.  Each entry's user_data is the
+*                index of its file and the OP_ operation.  An open or read
+*                result sets the file's fd or len, a close clears its fd,
+*                and ok records whether each file's statx or read
+*                succeeded.  If submitting fails, the entries the kernel
+*                hasn't taken are withdrawn and the ones it has are still
+*                waited for, so no completion is left to be mistaken for
+*                part of the next load.
+*   Parameters : ring - ring with queued entries
+*                files - files the entries are for
+*                ok - set for each file
+*   Effects    : Runs the queued operations.  The ring is marked broken if
+*                completions can't be waited for.
+*   Returned   : 0 for success, otherwise -1 with errno set.  Queued
+*                entries that weren't submitted didn't run.
+****************************************************************************/
+static int SubmitAndWait(uring_t *ring, uring_file_t **files, int *ok)
+{
+    struct io_uring_cqe *cqe;
+    unsigned int submitted, completed, toSubmit, head, tail;
+    size_t i;
+    long got;
+    int failed, err;
+
+    /* publish the entries; the kernel reads them on io_uring_enter */
+    __atomic_store_n(ring->sqTail, *ring->sqTail + ring->pending,
+        __ATOMIC_RELEASE);
+    submitted = ring->pending;
+    ring->pending = 0;
+    completed = 0;
+    failed = 0;
+    err = 0;
+
+    while (completed < submitted)
+    {
+        /* the kernel advances sqHead past what it has consumed */
+        head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+        toSubmit = *ring->sqTail - head;
+        got = syscall(__NR_io_uring_enter, ring->fd, toSubmit,
+            submitted - completed, IORING_ENTER_GETEVENTS, NULL, 0);
+
+        if ((got < 0) && (EINTR != errno) && (EAGAIN != errno) &&
+            (EBUSY != errno))
+        {
+            err = errno;
+
+            if (failed || (0 == toSubmit))
+            {
+                /* can't even wait; what's in flight can't be collected */
+                ring->broken = 1;
+                errno = err;
+                return -1;
+            }
+
+            /* withdraw what wasn't taken and wait for the rest */
+            failed = 1;
+            head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+            submitted -= *ring->sqTail - head;
+            __atomic_store_n(ring->sqTail, head, __ATOMIC_RELEASE);
+        }
+
+        head = *ring->cqHead;
+        tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+
+        while (head != tail)
+        {
+            cqe = &ring->cqes[head & ring->cqMask];
+            i = (size_t)(cqe->user_data >> OP_BITS);
+
+            switch (cqe->user_data & ((1 << OP_BITS) - 1))
+            {
+                case OP_OPEN:
+                    if (cqe->res < 0)
+                    {
+                        files[i]->err = -cqe->res;
+                    }
+                    else
+                    {
+                        files[i]->fd = cqe->res;
+                    }
+                    break;
+
+                case OP_STATX:
+                    ok[i] = (0 == cqe->res);
+                    break;
+
+                case OP_READ:
+                    ok[i] = (cqe->res >= 0);
+                    files[i]->len = (cqe->res < 0) ? 0 : (size_t)cqe->res;
+                    break;
+
+                case OP_CLOSE:
+                    /* the descriptor is gone even if close reports an error */
+                    files[i]->fd = -1;
+                    break;
+            }
+
+            head++;
+            completed++;
+        }
+
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    if (failed)
+    {
+        errno = err;
+        return -1;
+    }
+
+    return 0;
+}
+
+#else   /* no io_uring */
+
+/****************************************************************************
+*   Function   : UringCreate
+*   Description: This function stands in for UringCreate where io_uring
+*                isn't available.
+*   Parameters : slots - unused
+*                slotSize - unused
+*   Effects    : None
+*   Returned   : NULL
+****************************************************************************/
+uring_t *UringCreate(unsigned int slots, size_t slotSize)
+{
+    (void)slots;
+    (void)slotSize;
+    return NULL;
+}
+
+/****************************************************************************
+*   Function   : UringDestroy
+*   Description: This function stands in for UringDestroy where io_uring
+*                isn't available.
+*   Parameters : ring - unused
+*   Effects    : None
+*   Returned   : None
+****************************************************************************/
+void UringDestroy(uring_t *ring)
+{
+    (void)ring;
+}
+
+/****************************************************************************
+*   Function   : UringLoad
+*   Description: This function stands in for UringLoad where io_uring
+*                isn't available.
+*   Parameters : ring - unused
+*                files - unused
+*                count - unused
+*   Effects    : None
+*   Returned   : 0
+****************************************************************************/
+size_t UringLoad(uring_t *ring, uring_file_t **files, size_t count)
+{
+    (void)ring;
+    (void)files;
+    (void)count;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : UringRelease
+*   Description: This function stands in for UringRelease where io_uring
+*                isn't available.
+*   Parameters : ring - unused
+*                slot - unused
+*   Effects    : None
+*   Returned   : None
+****************************************************************************/
+void UringRelease(uring_t *ring, int slot)
+{
+    (void)ring;
+    (void)slot;
+}
+
+#endif
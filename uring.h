@@ -0,0 +1,76 @@
+/***************************************************************************
+*                            Batched File Loader
+*
+*   File    : uring.h
+*   Purpose : Header for functions that open and read batches of small files
+*             with io_uring
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef URING_H
+#define URING_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stddef.h>
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define URING_BATCH     64          /* most files loaded by one UringLoad */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef struct uring_t uring_t;
+
+/* a file to be loaded.  After UringLoad exactly one of these holds: err is
+ * non-zero, slot is a buffer holding the whole file, or fd is open so the
+ * file can be read the ordinary way. */
+typedef struct uring_file_t
+{
+    const char *path;           /* name of the file */
+    int fd;                     /* descriptor left open, or -1 */
+    int slot;                   /* buffer holding the file, or -1 */
+    const char *data;           /* contents of a loaded file */
+    size_t len;                 /* length of data */
+    int err;                    /* errno value if the file couldn't open */
+} uring_file_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* returns NULL if io_uring isn't available */
+uring_t *UringCreate(unsigned int slots, size_t slotSize);
+void UringDestroy(uring_t *ring);
+
+/* loads up to count files and returns the number handled.  Only one thread
+ * may load from a ring, but any thread may release a slot. */
+size_t UringLoad(uring_t *ring, uring_file_t **files, size_t count);
+void UringRelease(uring_t *ring, int slot);
+
+#endif  /* ndef URING_H */
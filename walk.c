@@ -0,0 +1,507 @@
+/***************************************************************************
+*                              Directory Walker
+*
+*   File    : walk.c
+*   Purpose : List directories with openat and getdents, applying include
+*             and exclude globs before any file is opened
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE     /* syscall() and d_type */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "walk.h"
+
+#ifdef __linux__
+#include <stdint.h>
+#include <sys/syscall.h>
+#endif
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define DENTS_SIZE  (32 * 1024)     /* bytes of entries per getdents call */
+#define ENTRIES_START   32          /* initial size of an entry list */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+#ifdef __linux__
+/* record returned by the getdents64 system call */
+typedef struct linux_dirent64_t
+{
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+} linux_dirent64_t;
+#endif
+
+typedef struct entry_list_t
+{
+    walk_entry_t *entries;      /* entries found so far */
+    size_t count;               /* number of entries */
+    size_t size;                /* capacity of entries */
+} entry_list_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static char **SplitPatterns(char **next, const char *list);
+static int MatchAny(char *const *patterns, const char *name);
+static int AddEntry(entry_list_t *list, int dirFd, const char *dirPath,
+    const char *name, int type, const walk_filter_t *filter);
+static int CompareEntries(const void *a, const void *b);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : WalkFilterInit
+*   Description: This function builds a filter from comma separated lists
+*                of glob patterns, such as "*.c,*.h".  Patterns are matched
+*                against the last component of a path with fnmatch(3).
+*   Parameters : filter - filter to be initialized
+*                include - comma separated list of patterns that files must
+*                          match.  NULL or empty to include all files.
+*                exclude - comma separated list of patterns for files and
+*                          directories to be skipped.  NULL or empty to
+*                          skip nothing.
+*   Effects    : Memory is allocated for the pattern lists.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+int WalkFilterInit(walk_filter_t *filter, const char *include,
+    const char *exclude)
+{
+    size_t len;
+    char *next;
+
+    len = ((NULL == include) ? 0 : strlen(include)) +
+        ((NULL == exclude) ? 0 : strlen(exclude)) + 2;
+    filter->patterns = (char *)malloc(len);
+    filter->include = NULL;
+    filter->exclude = NULL;
+
+    if (NULL == filter->patterns)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    next = filter->patterns;
+    filter->include = SplitPatterns(&next, include);
+    filter->exclude = SplitPatterns(&next, exclude);
+
+    if ((NULL == filter->include) || (NULL == filter->exclude))
+    {
+        WalkFilterFree(filter);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : WalkFilterFree
+*   Description: This function frees the memory allocated by
+*                WalkFilterInit.
+*   Parameters : filter - filter to be freed
+*   Effects    : The filter's lists are freed.
+*   Returned   : None
+****************************************************************************/
+void WalkFilterFree(walk_filter_t *filter)
+{
+    free(filter->include);
+    free(filter->exclude);
+    free(filter->patterns);
+    filter->include = NULL;
+    filter->exclude = NULL;
+    filter->patterns = NULL;
+}
+
+/****************************************************************************
+*   Function   : WalkReadDir
+*   Description: This function lists a directory.  Entries are filtered by
+*                name as they are read, so excluded files are never opened
+*                or even stat'd.  On Linux the directory is read in large
+*                batches with getdents64, elsewhere readdir is used.
+*                Symbolic links to directories are not followed, so the
+*                walk can't loop.
+*   Parameters : dirPath - directory to list
+*                filter - include and exclude patterns
+*                entries - set to a malloc'd list of the entries that pass
+*                          the filter, sorted by name
+*                count - set to the number of entries
+*   Effects    : Memory is allocated for the entries.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+*
+*   NOTE: The caller is responsible for freeing the list with
+*         WalkFreeEntries.
+****************************************************************************/
+int WalkReadDir(const char *dirPath, const walk_filter_t *filter,
+    walk_entry_t **entries, size_t *count)
+{
+    entry_list_t list;
+    int fd, err;
+#ifdef __linux__
+    char *dents;
+    long got, off;
+    linux_dirent64_t *d;
+#else
+    DIR *dir;
+    struct dirent *d;
+#endif
+
+    fd = openat(AT_FDCWD, dirPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    list.entries = NULL;
+    list.count = 0;
+    list.size = 0;
+    err = 0;
+
+#ifdef __linux__
+    dents = (char *)malloc(DENTS_SIZE);
+
+    if (NULL == dents)
+    {
+        close(fd);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    while ((0 == err) && ((got = syscall(SYS_getdents64, fd, dents,
+        DENTS_SIZE)) > 0))
+    {
+        for (off = 0; off < got; off += d->d_reclen)
+        {
+            d = (linux_dirent64_t *)(dents + off);
+
+            if (0 != AddEntry(&list, fd, dirPath, d->d_name, d->d_type,
+                filter))
+            {
+                err = errno;
+                break;
+            }
+        }
+    }
+
+    if ((0 == err) && (got < 0))
+    {
+        err = errno;
+    }
+
+    free(dents);
+    close(fd);
+#else
+    dir = fdopendir(fd);
+
+    if (NULL == dir)
+    {
+        err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    errno = 0;
+
+    while ((0 == err) && (NULL != (d = readdir(dir))))
+    {
+        if (0 != AddEntry(&list, fd, dirPath, d->d_name, d->d_type, filter))
+        {
+            err = errno;
+        }
+
+        errno = 0;
+    }
+
+    if (0 == err)
+    {
+        err = errno;
+    }
+
+    closedir(dir);
+#endif
+
+    if (0 != err)
+    {
+        WalkFreeEntries(list.entries, list.count);
+        errno = err;
+        return -1;
+    }
+
+    if (0 != list.count)
+    {
+        /* an empty list has no array to sort */
+        qsort(list.entries, list.count, sizeof(walk_entry_t),
+            CompareEntries);
+    }
+
+    *entries = list.entries;
+    *count = list.count;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : WalkFreeEntries
+*   Description: This function frees a list of entries returned by
+*                WalkReadDir.
+*   Parameters : entries - list to be freed
+*                count - number of entries in the list
+*   Effects    : The list and the paths it holds are freed.
+*   Returned   : None
+****************************************************************************/
+void WalkFreeEntries(walk_entry_t *entries, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        free(entries[i].path);
+    }
+
+    free(entries);
+}
+
+/****************************************************************************
+*   Function   : SplitPatterns
+*   Description: This function copies a comma separated list of patterns
+*                into a buffer, replacing the commas with NULs, and builds
+*                a NULL terminated array pointing to each pattern.  Empty
+*                patterns are dropped.
+*   Parameters : next - pointer to the next free byte of the buffer.  It
+*                       is advanced past the copied list.
+*                list - comma separated list of patterns, may be NULL
+*   Effects    : The list is copied into the buffer.
+*   Returned   : malloc'd NULL terminated array of patterns, NULL if it
+*                can't be allocated.
+****************************************************************************/
+static char **SplitPatterns(char **next, const char *list)
+{
+    char **patterns, *p;
+    size_t n;
+
+    if (NULL == list)
+    {
+        list = "";
+    }
+
+    /* worst case, every other character is a pattern */
+    patterns = (char **)malloc((strlen(list) / 2 + 2) * sizeof(char *));
+
+    if (NULL == patterns)
+    {
+        return NULL;
+    }
+
+    p = *next;
+    strcpy(p, list);
+    *next = p + strlen(list) + 1;
+    n = 0;
+
+    while ('\0' != *p)
+    {
+        if (',' == *p)
+        {
+            *p = '\0';
+            p++;
+            continue;
+        }
+
+        patterns[n] = p;
+        n++;
+        p += strcspn(p, ",");
+    }
+
+    patterns[n] = NULL;
+    return patterns;
+}
+
+/****************************************************************************
+*   Function   : MatchAny
+*   Description: This function checks a name against a list of patterns.
+*   Parameters : patterns - NULL terminated list of glob patterns
+*                name - file or directory name (no path)
+*   Effects    : None
+*   Returned   : 1 if name matches any of the patterns, otherwise 0.
+****************************************************************************/
+static int MatchAny(char *const *patterns, const char *name)
+{
+    for (; NULL != *patterns; patterns++)
+    {
+        if (0 == fnmatch(*patterns, name, FNM_PERIOD))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : AddEntry
+*   Description: This function decides whether a directory entry should be
+*                walked, and adds it to a list if it should.  "." and ".."
+*                are skipped, as are entries matching an exclude pattern,
+*                files that don't match an include pattern, symbolic links
+*                to directories, and anything that isn't a regular file or
+*                a directory.  The file system is only asked for an entry's
+*                type if the directory listing doesn't provide it.
+*   Parameters : list - list to add the entry to
+*                dirFd - descriptor of the directory being listed
+*                dirPath - path of the directory being listed
+*                name - name of the entry
+*                type - d_type of the entry (DT_UNKNOWN if not known)
+*                filter - include and exclude patterns
+*   Effects    : The entry may be added to list.
+*   Returned   : 0 for success, otherwise -1 with errno set.
+****************************************************************************/
+static int AddEntry(entry_list_t *list, int dirFd, const char *dirPath,
+    const char *name, int type, const walk_filter_t *filter)
+{
+    struct stat sb;
+    walk_entry_t *entries;
+    size_t dirLen, nameLen;
+    char *path;
+    int isDir;
+
+    if (('.' == name[0]) && (('\0' == name[1]) ||
+        (('.' == name[1]) && ('\0' == name[2]))))
+    {
+        return 0;
+    }
+
+    if (MatchAny(filter->exclude, name))
+    {
+        return 0;
+    }
+
+    if ((DT_UNKNOWN == type) || (DT_LNK == type))
+    {
+        /* follow links to files, but not to directories */
+        if (0 != fstatat(dirFd, name, &sb, 0))
+        {
+            return 0;       /* probably a dangling link */
+        }
+
+        if (S_ISDIR(sb.st_mode))
+        {
+            type = (DT_LNK == type) ? DT_LNK : DT_DIR;
+        }
+        else if (S_ISREG(sb.st_mode))
+        {
+            type = DT_REG;
+        }
+    }
+
+    if (DT_DIR == type)
+    {
+        isDir = 1;
+    }
+    else if ((DT_REG == type) && ((NULL == filter->include[0]) ||
+        MatchAny(filter->include, name)))
+    {
+        isDir = 0;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (list->count == list->size)
+    {
+        list->size = (0 == list->size) ? ENTRIES_START : 2 * list->size;
+        entries = (walk_entry_t *)realloc(list->entries,
+            list->size * sizeof(walk_entry_t));
+
+        if (NULL == entries)
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+
+        list->entries = entries;
+    }
+
+    dirLen = strlen(dirPath);
+    nameLen = strlen(name);
+    path = (char *)malloc(dirLen + nameLen + 2);
+
+    if (NULL == path)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    memcpy(path, dirPath, dirLen);
+
+    if ((0 == dirLen) || ('/' != dirPath[dirLen - 1]))
+    {
+        path[dirLen] = '/';
+        dirLen++;
+    }
+
+    memcpy(path + dirLen, name, nameLen + 1);
+    list->entries[list->count].path = path;
+    list->entries[list->count].isDir = isDir;
+    list->count++;
+    return 0;
+}
+
+/****************************************************************************
+*   Function   : CompareEntries
+*   Description: This function is the qsort comparison for directory
+*                entries.  It orders them by path.
+*   Parameters : a - pointer to the first walk_entry_t
+*                b - pointer to the second walk_entry_t
+*   Effects    : None
+*   Returned   : < 0, 0, or > 0 as a is before, the same as, or after b.
+****************************************************************************/
+static int CompareEntries(const void *a, const void *b)
+{
+    return strcmp(((const walk_entry_t *)a)->path,
+        ((const walk_entry_t *)b)->path);
+}
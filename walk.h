@@ -0,0 +1,75 @@
+/***************************************************************************
+*                              Directory Walker
+*
+*   File    : walk.h
+*   Purpose : Header for functions that list directories and filter their
+*             entries with include and exclude globs
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef WALK_H
+#define WALK_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stddef.h>
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef struct walk_filter_t
+{
+    char *patterns;             /* copy of the pattern lists, NUL split */
+    char **include;             /* NULL terminated; files must match one */
+    char **exclude;             /* NULL terminated; entries skipped */
+} walk_filter_t;
+
+typedef struct walk_entry_t
+{
+    char *path;                 /* directory path joined with entry name */
+    int isDir;                  /* non-zero if the entry is a directory */
+} walk_entry_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* builds a filter from comma separated glob lists (either may be NULL) */
+int WalkFilterInit(walk_filter_t *filter, const char *include,
+    const char *exclude);
+
+/* frees the lists built by WalkFilterInit */
+void WalkFilterFree(walk_filter_t *filter);
+
+/* lists the files and subdirectories of dirPath that pass filter, sorted
+ * by name */
+int WalkReadDir(const char *dirPath, const walk_filter_t *filter,
+    walk_entry_t **entries, size_t *count);
+
+/* frees a list returned by WalkReadDir */
+void WalkFreeEntries(walk_entry_t *entries, size_t count);
+
+#endif  /* ndef WALK_H */
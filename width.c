@@ -0,0 +1,704 @@
+/***************************************************************************
+*                            UTF-8 Display Width
+*
+*   File    : width.c
+*   Purpose : Count the columns UTF-8 text takes on a terminal, so tabs
+*             after wide and combining characters reach the right stop
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <string.h>
+#include <pthread.h>
+#include "width.h"
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define MAX_CODE        0x110000            /* one past the last code point */
+#define BLOCK_BITS      8                   /* code points per block (log2) */
+#define BLOCK_CODES     (1 << BLOCK_BITS)
+#define BLOCK_BYTES     (BLOCK_CODES / 4)   /* 2 bits per code point */
+#define BLOCKS          (MAX_CODE >> BLOCK_BITS)
+#define MAX_UNIQUE      128                 /* distinct blocks; 95 are used */
+#define ONES_BYTE       0x55                /* four code points of width 1 */
+#define TWOS_BYTE       0xAA                /* four code points of width 2 */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+/* code points first through last are width columns wide */
+typedef struct width_range_t
+{
+    uint32_t first;
+    uint32_t last;
+    unsigned int width;
+} width_range_t;
+
+/***************************************************************************
+*                            GLOBAL VARIABLES
+***************************************************************************/
+/* Every code point from U+0080 on that isn't one column wide, from Unicode
+ * 14.0.  Nonspacing and enclosing marks, format characters (except the
+ * soft hyphen), and Hangul medial vowels and final consonants are 0; East
+ * Asian wide and fullwidth characters are 2.  Unassigned code points
+ * between two ranges of the same width are folded into them, and the
+ * unassigned ideograph planes are 2. */
+static const width_range_t ranges[] =
+{
+    {0x00300, 0x0036F, 0},
+    {0x00483, 0x00489, 0},
+    {0x00591, 0x005BD, 0},
+    {0x005BF, 0x005BF, 0},
+    {0x005C1, 0x005C2, 0},
+    {0x005C4, 0x005C5, 0},
+    {0x005C7, 0x005C7, 0},
+    {0x00600, 0x00605, 0},
+    {0x00610, 0x0061A, 0},
+    {0x0061C, 0x0061C, 0},
+    {0x0064B, 0x0065F, 0},
+    {0x00670, 0x00670, 0},
+    {0x006D6, 0x006DD, 0},
+    {0x006DF, 0x006E4, 0},
+    {0x006E7, 0x006E8, 0},
+    {0x006EA, 0x006ED, 0},
+    {0x0070F, 0x0070F, 0},
+    {0x00711, 0x00711, 0},
+    {0x00730, 0x0074A, 0},
+    {0x007A6, 0x007B0, 0},
+    {0x007EB, 0x007F3, 0},
+    {0x007FD, 0x007FD, 0},
+    {0x00816, 0x00819, 0},
+    {0x0081B, 0x00823, 0},
+    {0x00825, 0x00827, 0},
+    {0x00829, 0x0082D, 0},
+    {0x00859, 0x0085B, 0},
+    {0x00890, 0x0089F, 0},
+    {0x008CA, 0x00902, 0},
+    {0x0093A, 0x0093A, 0},
+    {0x0093C, 0x0093C, 0},
+    {0x00941, 0x00948, 0},
+    {0x0094D, 0x0094D, 0},
+    {0x00951, 0x00957, 0},
+    {0x00962, 0x00963, 0},
+    {0x00981, 0x00981, 0},
+    {0x009BC, 0x009BC, 0},
+    {0x009C1, 0x009C4, 0},
+    {0x009CD, 0x009CD, 0},
+    {0x009E2, 0x009E3, 0},
+    {0x009FE, 0x00A02, 0},
+    {0x00A3C, 0x00A3C, 0},
+    {0x00A41, 0x00A51, 0},
+    {0x00A70, 0x00A71, 0},
+    {0x00A75, 0x00A75, 0},
+    {0x00A81, 0x00A82, 0},
+    {0x00ABC, 0x00ABC, 0},
+    {0x00AC1, 0x00AC8, 0},
+    {0x00ACD, 0x00ACD, 0},
+    {0x00AE2, 0x00AE3, 0},
+    {0x00AFA, 0x00B01, 0},
+    {0x00B3C, 0x00B3C, 0},
+    {0x00B3F, 0x00B3F, 0},
+    {0x00B41, 0x00B44, 0},
+    {0x00B4D, 0x00B56, 0},
+    {0x00B62, 0x00B63, 0},
+    {0x00B82, 0x00B82, 0},
+    {0x00BC0, 0x00BC0, 0},
+    {0x00BCD, 0x00BCD, 0},
+    {0x00C00, 0x00C00, 0},
+    {0x00C04, 0x00C04, 0},
+    {0x00C3C, 0x00C3C, 0},
+    {0x00C3E, 0x00C40, 0},
+    {0x00C46, 0x00C56, 0},
+    {0x00C62, 0x00C63, 0},
+    {0x00C81, 0x00C81, 0},
+    {0x00CBC, 0x00CBC, 0},
+    {0x00CBF, 0x00CBF, 0},
+    {0x00CC6, 0x00CC6, 0},
+    {0x00CCC, 0x00CCD, 0},
+    {0x00CE2, 0x00CE3, 0},
+    {0x00D00, 0x00D01, 0},
+    {0x00D3B, 0x00D3C, 0},
+    {0x00D41, 0x00D44, 0},
+    {0x00D4D, 0x00D4D, 0},
+    {0x00D62, 0x00D63, 0},
+    {0x00D81, 0x00D81, 0},
+    {0x00DCA, 0x00DCA, 0},
+    {0x00DD2, 0x00DD6, 0},
+    {0x00E31, 0x00E31, 0},
+    {0x00E34, 0x00E3A, 0},
+    {0x00E47, 0x00E4E, 0},
+    {0x00EB1, 0x00EB1, 0},
+    {0x00EB4, 0x00EBC, 0},
+    {0x00EC8, 0x00ECD, 0},
+    {0x00F18, 0x00F19, 0},
+    {0x00F35, 0x00F35, 0},
+    {0x00F37, 0x00F37, 0},
+    {0x00F39, 0x00F39, 0},
+    {0x00F71, 0x00F7E, 0},
+    {0x00F80, 0x00F84, 0},
+    {0x00F86, 0x00F87, 0},
+    {0x00F8D, 0x00FBC, 0},
+    {0x00FC6, 0x00FC6, 0},
+    {0x0102D, 0x01030, 0},
+    {0x01032, 0x01037, 0},
+    {0x01039, 0x0103A, 0},
+    {0x0103D, 0x0103E, 0},
+    {0x01058, 0x01059, 0},
+    {0x0105E, 0x01060, 0},
+    {0x01071, 0x01074, 0},
+    {0x01082, 0x01082, 0},
+    {0x01085, 0x01086, 0},
+    {0x0108D, 0x0108D, 0},
+    {0x0109D, 0x0109D, 0},
+    {0x01100, 0x0115F, 2},
+    {0x01160, 0x011FF, 0},
+    {0x0135D, 0x0135F, 0},
+    {0x01712, 0x01714, 0},
+    {0x01732, 0x01733, 0},
+    {0x01752, 0x01753, 0},
+    {0x01772, 0x01773, 0},
+    {0x017B4, 0x017B5, 0},
+    {0x017B7, 0x017BD, 0},
+    {0x017C6, 0x017C6, 0},
+    {0x017C9, 0x017D3, 0},
+    {0x017DD, 0x017DD, 0},
+    {0x0180B, 0x0180F, 0},
+    {0x01885, 0x01886, 0},
+    {0x018A9, 0x018A9, 0},
+    {0x01920, 0x01922, 0},
+    {0x01927, 0x01928, 0},
+    {0x01932, 0x01932, 0},
+    {0x01939, 0x0193B, 0},
+    {0x01A17, 0x01A18, 0},
+    {0x01A1B, 0x01A1B, 0},
+    {0x01A56, 0x01A56, 0},
+    {0x01A58, 0x01A60, 0},
+    {0x01A62, 0x01A62, 0},
+    {0x01A65, 0x01A6C, 0},
+    {0x01A73, 0x01A7F, 0},
+    {0x01AB0, 0x01B03, 0},
+    {0x01B34, 0x01B34, 0},
+    {0x01B36, 0x01B3A, 0},
+    {0x01B3C, 0x01B3C, 0},
+    {0x01B42, 0x01B42, 0},
+    {0x01B6B, 0x01B73, 0},
+    {0x01B80, 0x01B81, 0},
+    {0x01BA2, 0x01BA5, 0},
+    {0x01BA8, 0x01BA9, 0},
+    {0x01BAB, 0x01BAD, 0},
+    {0x01BE6, 0x01BE6, 0},
+    {0x01BE8, 0x01BE9, 0},
+    {0x01BED, 0x01BED, 0},
+    {0x01BEF, 0x01BF1, 0},
+    {0x01C2C, 0x01C33, 0},
+    {0x01C36, 0x01C37, 0},
+    {0x01CD0, 0x01CD2, 0},
+    {0x01CD4, 0x01CE0, 0},
+    {0x01CE2, 0x01CE8, 0},
+    {0x01CED, 0x01CED, 0},
+    {0x01CF4, 0x01CF4, 0},
+    {0x01CF8, 0x01CF9, 0},
+    {0x01DC0, 0x01DFF, 0},
+    {0x0200B, 0x0200F, 0},
+    {0x0202A, 0x0202E, 0},
+    {0x02060, 0x0206F, 0},
+    {0x020D0, 0x020F0, 0},
+    {0x0231A, 0x0231B, 2},
+    {0x02329, 0x0232A, 2},
+    {0x023E9, 0x023EC, 2},
+    {0x023F0, 0x023F0, 2},
+    {0x023F3, 0x023F3, 2},
+    {0x025FD, 0x025FE, 2},
+    {0x02614, 0x02615, 2},
+    {0x02648, 0x02653, 2},
+    {0x0267F, 0x0267F, 2},
+    {0x02693, 0x02693, 2},
+    {0x026A1, 0x026A1, 2},
+    {0x026AA, 0x026AB, 2},
+    {0x026BD, 0x026BE, 2},
+    {0x026C4, 0x026C5, 2},
+    {0x026CE, 0x026CE, 2},
+    {0x026D4, 0x026D4, 2},
+    {0x026EA, 0x026EA, 2},
+    {0x026F2, 0x026F3, 2},
+    {0x026F5, 0x026F5, 2},
+    {0x026FA, 0x026FA, 2},
+    {0x026FD, 0x026FD, 2},
+    {0x02705, 0x02705, 2},
+    {0x0270A, 0x0270B, 2},
+    {0x02728, 0x02728, 2},
+    {0x0274C, 0x0274C, 2},
+    {0x0274E, 0x0274E, 2},
+    {0x02753, 0x02755, 2},
+    {0x02757, 0x02757, 2},
+    {0x02795, 0x02797, 2},
+    {0x027B0, 0x027B0, 2},
+    {0x027BF, 0x027BF, 2},
+    {0x02B1B, 0x02B1C, 2},
+    {0x02B50, 0x02B50, 2},
+    {0x02B55, 0x02B55, 2},
+    {0x02CEF, 0x02CF1, 0},
+    {0x02D7F, 0x02D7F, 0},
+    {0x02DE0, 0x02DFF, 0},
+    {0x02E80, 0x03029, 2},
+    {0x0302A, 0x0302D, 0},
+    {0x0302E, 0x0303E, 2},
+    {0x03041, 0x03096, 2},
+    {0x03099, 0x0309A, 0},
+    {0x0309B, 0x03247, 2},
+    {0x03250, 0x04DBF, 2},
+    {0x04E00, 0x0A4C6, 2},
+    {0x0A66F, 0x0A672, 0},
+    {0x0A674, 0x0A67D, 0},
+    {0x0A69E, 0x0A69F, 0},
+    {0x0A6F0, 0x0A6F1, 0},
+    {0x0A802, 0x0A802, 0},
+    {0x0A806, 0x0A806, 0},
+    {0x0A80B, 0x0A80B, 0},
+    {0x0A825, 0x0A826, 0},
+    {0x0A82C, 0x0A82C, 0},
+    {0x0A8C4, 0x0A8C5, 0},
+    {0x0A8E0, 0x0A8F1, 0},
+    {0x0A8FF, 0x0A8FF, 0},
+    {0x0A926, 0x0A92D, 0},
+    {0x0A947, 0x0A951, 0},
+    {0x0A960, 0x0A97C, 2},
+    {0x0A980, 0x0A982, 0},
+    {0x0A9B3, 0x0A9B3, 0},
+    {0x0A9B6, 0x0A9B9, 0},
+    {0x0A9BC, 0x0A9BD, 0},
+    {0x0A9E5, 0x0A9E5, 0},
+    {0x0AA29, 0x0AA2E, 0},
+    {0x0AA31, 0x0AA32, 0},
+    {0x0AA35, 0x0AA36, 0},
+    {0x0AA43, 0x0AA43, 0},
+    {0x0AA4C, 0x0AA4C, 0},
+    {0x0AA7C, 0x0AA7C, 0},
+    {0x0AAB0, 0x0AAB0, 0},
+    {0x0AAB2, 0x0AAB4, 0},
+    {0x0AAB7, 0x0AAB8, 0},
+    {0x0AABE, 0x0AABF, 0},
+    {0x0AAC1, 0x0AAC1, 0},
+    {0x0AAEC, 0x0AAED, 0},
+    {0x0AAF6, 0x0AAF6, 0},
+    {0x0ABE5, 0x0ABE5, 0},
+    {0x0ABE8, 0x0ABE8, 0},
+    {0x0ABED, 0x0ABED, 0},
+    {0x0AC00, 0x0D7A3, 2},
+    {0x0F900, 0x0FAFF, 2},
+    {0x0FB1E, 0x0FB1E, 0},
+    {0x0FE00, 0x0FE0F, 0},
+    {0x0FE10, 0x0FE19, 2},
+    {0x0FE20, 0x0FE2F, 0},
+    {0x0FE30, 0x0FE6B, 2},
+    {0x0FEFF, 0x0FEFF, 0},
+    {0x0FF01, 0x0FF60, 2},
+    {0x0FFE0, 0x0FFE6, 2},
+    {0x0FFF9, 0x0FFFB, 0},
+    {0x101FD, 0x101FD, 0},
+    {0x102E0, 0x102E0, 0},
+    {0x10376, 0x1037A, 0},
+    {0x10A01, 0x10A0F, 0},
+    {0x10A38, 0x10A3F, 0},
+    {0x10AE5, 0x10AE6, 0},
+    {0x10D24, 0x10D27, 0},
+    {0x10EAB, 0x10EAC, 0},
+    {0x10F46, 0x10F50, 0},
+    {0x10F82, 0x10F85, 0},
+    {0x11001, 0x11001, 0},
+    {0x11038, 0x11046, 0},
+    {0x11070, 0x11070, 0},
+    {0x11073, 0x11074, 0},
+    {0x1107F, 0x11081, 0},
+    {0x110B3, 0x110B6, 0},
+    {0x110B9, 0x110BA, 0},
+    {0x110BD, 0x110BD, 0},
+    {0x110C2, 0x110CD, 0},
+    {0x11100, 0x11102, 0},
+    {0x11127, 0x1112B, 0},
+    {0x1112D, 0x11134, 0},
+    {0x11173, 0x11173, 0},
+    {0x11180, 0x11181, 0},
+    {0x111B6, 0x111BE, 0},
+    {0x111C9, 0x111CC, 0},
+    {0x111CF, 0x111CF, 0},
+    {0x1122F, 0x11231, 0},
+    {0x11234, 0x11234, 0},
+    {0x11236, 0x11237, 0},
+    {0x1123E, 0x1123E, 0},
+    {0x112DF, 0x112DF, 0},
+    {0x112E3, 0x112EA, 0},
+    {0x11300, 0x11301, 0},
+    {0x1133B, 0x1133C, 0},
+    {0x11340, 0x11340, 0},
+    {0x11366, 0x11374, 0},
+    {0x11438, 0x1143F, 0},
+    {0x11442, 0x11444, 0},
+    {0x11446, 0x11446, 0},
+    {0x1145E, 0x1145E, 0},
+    {0x114B3, 0x114B8, 0},
+    {0x114BA, 0x114BA, 0},
+    {0x114BF, 0x114C0, 0},
+    {0x114C2, 0x114C3, 0},
+    {0x115B2, 0x115B5, 0},
+    {0x115BC, 0x115BD, 0},
+    {0x115BF, 0x115C0, 0},
+    {0x115DC, 0x115DD, 0},
+    {0x11633, 0x1163A, 0},
+    {0x1163D, 0x1163D, 0},
+    {0x1163F, 0x11640, 0},
+    {0x116AB, 0x116AB, 0},
+    {0x116AD, 0x116AD, 0},
+    {0x116B0, 0x116B5, 0},
+    {0x116B7, 0x116B7, 0},
+    {0x1171D, 0x1171F, 0},
+    {0x11722, 0x11725, 0},
+    {0x11727, 0x1172B, 0},
+    {0x1182F, 0x11837, 0},
+    {0x11839, 0x1183A, 0},
+    {0x1193B, 0x1193C, 0},
+    {0x1193E, 0x1193E, 0},
+    {0x11943, 0x11943, 0},
+    {0x119D4, 0x119DB, 0},
+    {0x119E0, 0x119E0, 0},
+    {0x11A01, 0x11A0A, 0},
+    {0x11A33, 0x11A38, 0},
+    {0x11A3B, 0x11A3E, 0},
+    {0x11A47, 0x11A47, 0},
+    {0x11A51, 0x11A56, 0},
+    {0x11A59, 0x11A5B, 0},
+    {0x11A8A, 0x11A96, 0},
+    {0x11A98, 0x11A99, 0},
+    {0x11C30, 0x11C3D, 0},
+    {0x11C3F, 0x11C3F, 0},
+    {0x11C92, 0x11CA7, 0},
+    {0x11CAA, 0x11CB0, 0},
+    {0x11CB2, 0x11CB3, 0},
+    {0x11CB5, 0x11CB6, 0},
+    {0x11D31, 0x11D45, 0},
+    {0x11D47, 0x11D47, 0},
+    {0x11D90, 0x11D91, 0},
+    {0x11D95, 0x11D95, 0},
+    {0x11D97, 0x11D97, 0},
+    {0x11EF3, 0x11EF4, 0},
+    {0x13430, 0x13438, 0},
+    {0x16AF0, 0x16AF4, 0},
+    {0x16B30, 0x16B36, 0},
+    {0x16F4F, 0x16F4F, 0},
+    {0x16F8F, 0x16F92, 0},
+    {0x16FE0, 0x16FE3, 2},
+    {0x16FE4, 0x16FE4, 0},
+    {0x16FF0, 0x1B2FB, 2},
+    {0x1BC9D, 0x1BC9E, 0},
+    {0x1BCA0, 0x1CF46, 0},
+    {0x1D167, 0x1D169, 0},
+    {0x1D173, 0x1D182, 0},
+    {0x1D185, 0x1D18B, 0},
+    {0x1D1AA, 0x1D1AD, 0},
+    {0x1D242, 0x1D244, 0},
+    {0x1DA00, 0x1DA36, 0},
+    {0x1DA3B, 0x1DA6C, 0},
+    {0x1DA75, 0x1DA75, 0},
+    {0x1DA84, 0x1DA84, 0},
+    {0x1DA9B, 0x1DAAF, 0},
+    {0x1E000, 0x1E02A, 0},
+    {0x1E130, 0x1E136, 0},
+    {0x1E2AE, 0x1E2AE, 0},
+    {0x1E2EC, 0x1E2EF, 0},
+    {0x1E8D0, 0x1E8D6, 0},
+    {0x1E944, 0x1E94A, 0},
+    {0x1F004, 0x1F004, 2},
+    {0x1F0CF, 0x1F0CF, 2},
+    {0x1F18E, 0x1F18E, 2},
+    {0x1F191, 0x1F19A, 2},
+    {0x1F200, 0x1F320, 2},
+    {0x1F32D, 0x1F335, 2},
+    {0x1F337, 0x1F37C, 2},
+    {0x1F37E, 0x1F393, 2},
+    {0x1F3A0, 0x1F3CA, 2},
+    {0x1F3CF, 0x1F3D3, 2},
+    {0x1F3E0, 0x1F3F0, 2},
+    {0x1F3F4, 0x1F3F4, 2},
+    {0x1F3F8, 0x1F43E, 2},
+    {0x1F440, 0x1F440, 2},
+    {0x1F442, 0x1F4FC, 2},
+    {0x1F4FF, 0x1F53D, 2},
+    {0x1F54B, 0x1F54E, 2},
+    {0x1F550, 0x1F567, 2},
+    {0x1F57A, 0x1F57A, 2},
+    {0x1F595, 0x1F596, 2},
+    {0x1F5A4, 0x1F5A4, 2},
+    {0x1F5FB, 0x1F64F, 2},
+    {0x1F680, 0x1F6C5, 2},
+    {0x1F6CC, 0x1F6CC, 2},
+    {0x1F6D0, 0x1F6D2, 2},
+    {0x1F6D5, 0x1F6DF, 2},
+    {0x1F6EB, 0x1F6EC, 2},
+    {0x1F6F4, 0x1F6FC, 2},
+    {0x1F7E0, 0x1F7F0, 2},
+    {0x1F90C, 0x1F93A, 2},
+    {0x1F93C, 0x1F945, 2},
+    {0x1F947, 0x1F9FF, 2},
+    {0x1FA70, 0x1FAF6, 2},
+    {0x20000, 0x3FFFD, 2},
+    {0xE0001, 0xE01EF, 0},
+};
+
+/* The table is two stage: blockIndex picks one of the distinct blocks of
+ * 256 code points, which hold 2 bits per code point.  Block 0 is all 1
+ * and block 1 is all 2, so most of the 4352 blocks share them, and the
+ * whole table is about 12K. */
+static unsigned char blockIndex[BLOCKS];
+static unsigned char blockWidths[MAX_UNIQUE][BLOCK_BYTES];
+static unsigned int uniqueCount;
+static pthread_once_t widthOnce = PTHREAD_ONCE_INIT;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static void BuildTable(void);
+static unsigned int AddBlock(const unsigned char *block);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/****************************************************************************
+*   Function   : WidthInit
+*   Description: This function builds the width table the first time it's
+*                called.  Later calls, from any thread, return at once.
+*   Parameters : None
+*   Effects    : The width table is built.
+*   Returned   : None
+****************************************************************************/
+void WidthInit(void)
+{
+    (void)pthread_once(&widthOnce, BuildTable);
+}
+
+/****************************************************************************
+*   Function   : CharWidth
+*   Description: This function looks up the number of columns a code
+*                point takes with two loads from the width table.
+*   Parameters : cp - code point
+*   Effects    : None
+*   Returned   : 0, 1, or 2.  Code points past U+10FFFF are 1.
+****************************************************************************/
+unsigned int CharWidth(uint32_t cp)
+{
+    const unsigned char *block;
+
+    if (cp >= MAX_CODE)
+    {
+        return 1;
+    }
+
+    block = blockWidths[blockIndex[cp >> BLOCK_BITS]];
+    return (block[(cp & (BLOCK_CODES - 1)) >> 2] >> ((cp & 3) * 2)) & 3;
+}
+
+/****************************************************************************
+*   Function   : Utf8Width
+*   Description: This function decodes UTF-8 and adds up the columns its
+*                characters take.  A character's width is counted when its
+*                last byte is reached, so a sequence may be split across
+*                calls.  A sequence cut off by a byte that doesn't
+*                continue it, a stray continuation byte, and a byte that
+*                can't start a sequence each take one column, like the
+*                replacement character a terminal would show.
+*   Parameters : p - start of the text
+*                end - one past the last byte of the text
+*                cp - bits of an unfinished code point, carried between
+*                     calls
+*                need - continuation bytes the unfinished code point still
+*                       needs, or 0 if there isn't one
+*   Effects    : *cp and *need are updated to the end of the text.
+*   Returned   : Number of columns taken by the characters finished in
+*                [p, end).
+****************************************************************************/
+uint64_t Utf8Width(const char *p, const char *end, uint32_t *cp,
+    unsigned int *need)
+{
+    uint64_t width;
+    uint32_t code;
+    unsigned int c, left;
+
+    width = 0;
+    code = *cp;
+    left = *need;
+
+    for (; p < end; p++)
+    {
+        c = (unsigned char)*p;
+
+        if (0 != left)
+        {
+            if (0x80 == (c & 0xC0))
+            {
+                code = (code << 6) | (c & 0x3F);
+                left--;
+
+                if (0 == left)
+                {
+                    width += CharWidth(code);
+                }
+
+                continue;
+            }
+
+            /* the sequence was cut off */
+            width++;
+            left = 0;
+        }
+
+        if (c < 0x80)
+        {
+            width++;
+        }
+        else if ((c >= 0xC2) && (c <= 0xDF))
+        {
+            code = c & 0x1F;
+            left = 1;
+        }
+        else if (0xE0 == (c & 0xF0))
+        {
+            code = c & 0x0F;
+            left = 2;
+        }
+        else if ((c >= 0xF0) && (c <= 0xF4))
+        {
+            code = c & 0x07;
+            left = 3;
+        }
+        else
+        {
+            width++;        /* can't start a sequence */
+        }
+    }
+
+    *cp = code;
+    *need = left;
+    return width;
+}
+
+/****************************************************************************
+*   Function   : BuildTable
+*   Description: This function builds the two stage width table from the
+*                list of ranges.  Blocks that no range touches are block 0,
+*                and blocks a range of wide characters covers are block 1.
+*                The rest are filled in from the ranges that touch them and
+*                shared with any identical block.
+*   Parameters : None
+*   Effects    : The width table is built.
+*   Returned   : None
+****************************************************************************/
+static void BuildTable(void)
+{
+    unsigned char block[BLOCK_BYTES];
+    uint32_t first, last, code, cp;
+    size_t r, i, count;
+    unsigned int b, shift;
+
+    memset(blockWidths[0], ONES_BYTE, BLOCK_BYTES);
+    memset(blockWidths[1], TWOS_BYTE, BLOCK_BYTES);
+    uniqueCount = 2;
+    count = sizeof(ranges) / sizeof(ranges[0]);
+    r = 0;
+
+    for (b = 0; b < BLOCKS; b++)
+    {
+        first = (uint32_t)b << BLOCK_BITS;
+        last = first + BLOCK_CODES - 1;
+
+        while ((r < count) && (ranges[r].last < first))
+        {
+            r++;
+        }
+
+        if ((r == count) || (ranges[r].first > last))
+        {
+            blockIndex[b] = 0;
+            continue;
+        }
+
+        if ((ranges[r].first <= first) && (ranges[r].last >= last) &&
+            (2 == ranges[r].width))
+        {
+            blockIndex[b] = 1;
+            continue;
+        }
+
+        memset(block, ONES_BYTE, BLOCK_BYTES);
+
+        for (i = r; (i < count) && (ranges[i].first <= last); i++)
+        {
+            code = (ranges[i].first > first) ? ranges[i].first : first;
+
+            for (; (code <= ranges[i].last) && (code <= last); code++)
+            {
+                cp = code - first;
+                shift = (cp & 3) * 2;
+                block[cp >> 2] = (unsigned char)((block[cp >> 2] &
+                    ~(3 << shift)) | (ranges[i].width << shift));
+            }
+        }
+
+        blockIndex[b] = (unsigned char)AddBlock(block);
+    }
+}
+
+/****************************************************************************
+*   Function   : AddBlock
+*   Description: This function finds a block in the table of distinct
+*                blocks, adding it if it's new.
+*   Parameters : block - widths of a block of code points
+*   Effects    : The block may be added to the table.
+*   Returned   : Index of the block.  If the table were ever full, new
+*                blocks would become block 0.
+****************************************************************************/
+static unsigned int AddBlock(const unsigned char *block)
+{
+    unsigned int i;
+
+    for (i = 0; i < uniqueCount; i++)
+    {
+        if (0 == memcmp(blockWidths[i], block, BLOCK_BYTES))
+        {
+            return i;
+        }
+    }
+
+    if (MAX_UNIQUE == uniqueCount)
+    {
+        return 0;
+    }
+
+    memcpy(blockWidths[uniqueCount], block, BLOCK_BYTES);
+    return uniqueCount++;
+}
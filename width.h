@@ -0,0 +1,57 @@
+/***************************************************************************
+*                            UTF-8 Display Width
+*
+*   File    : width.h
+*   Purpose : Header for functions that count the columns UTF-8 text takes
+*             on a terminal
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Trim: A tab removal and trailing space trimmer
+* Copyright (C) 2006, 2007, 2010, 2017 by
+*       Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of Trim.
+*
+* Trim is free software; you can redistribute it and/or modify it under
+* the terms of the GNU General Public License as published by the Free
+* Software Foundation; either version 3 of the License, or (at your
+* option) any later version.
+*
+* Trim is distributed in the hope that it will be useful, but WITHOUT ANY
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#ifndef WIDTH_H
+#define WIDTH_H
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdint.h>
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* builds the width table; safe to call from any thread, any number of
+ * times.  It must be called before CharWidth or Utf8Width. */
+void WidthInit(void);
+
+/* returns the columns (0, 1, or 2) taken by code point cp */
+unsigned int CharWidth(uint32_t cp);
+
+/* returns the columns taken by the characters of [p, end) completed there.
+ * A sequence that isn't finished by end is left in cp and need for the
+ * next call; bytes that aren't valid UTF-8 take a column each. */
+uint64_t Utf8Width(const char *p, const char *end, uint32_t *cp,
+    unsigned int *need);
+
+#endif  /* ndef WIDTH_H */